@@ -2,6 +2,9 @@ include_guard(GLOBAL)
 
 prepend(POPULAR_COMMON_SOURCES ${COMMON_DIR}/
         algorithms/simd-int-to-string.cpp
+        algorithms/simd-numeric-kernels.cpp
+        algorithms/simd-string-kernels.cpp
+        algorithms/simd-utf8.cpp
         server/limits.cpp
         server/signals.cpp
         server/relogin.cpp
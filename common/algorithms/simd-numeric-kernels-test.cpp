@@ -0,0 +1,148 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/algorithms/simd-numeric-kernels.h"
+
+namespace {
+// covers scalar tails, SSE and AVX blocks
+std::vector<int64_t> make_ints(size_t len, int64_t seed) {
+  std::vector<int64_t> res;
+  for (size_t i = 0; i < len; ++i) {
+    res.push_back(static_cast<int64_t>((i * 7919 + seed) % 1009) - 500);
+  }
+  return res;
+}
+
+std::vector<double> make_doubles(size_t len, int64_t seed) {
+  std::vector<double> res;
+  for (int64_t x : make_ints(len, seed)) {
+    res.push_back(x / 7.0);
+  }
+  return res;
+}
+
+template<class T, class Less>
+T reference_select(const std::vector<T> &a, const Less &less) {
+  T res = a[0];
+  for (size_t i = 1; i < a.size(); ++i) {
+    if (less(a[i], res)) {
+      res = a[i];
+    }
+  }
+  return res;
+}
+
+bool same_double(double lhs, double rhs) {
+  return std::memcmp(&lhs, &rhs, sizeof(double)) == 0;
+}
+} // namespace
+
+TEST(simd_numeric_kernels, sum_int64) {
+  for (size_t len = 0; len < 40; ++len) {
+    const auto a = make_ints(len, 3);
+    int64_t expected = 0;
+    for (int64_t x : a) {
+      expected += x;
+    }
+    ASSERT_EQ(simd_sum_int64(a.data(), a.size()), expected);
+  }
+  const std::vector<int64_t> overflow{std::numeric_limits<int64_t>::max(), 1, 1, 1, 1};
+  ASSERT_EQ(simd_sum_int64(overflow.data(), overflow.size()), std::numeric_limits<int64_t>::min() + 3);
+}
+
+TEST(simd_numeric_kernels, find) {
+  for (size_t len = 0; len < 40; ++len) {
+    const auto ints = make_ints(len, 11);
+    const auto doubles = make_doubles(len, 11);
+    for (size_t pos = 0; pos < len; ++pos) {
+      ASSERT_EQ(simd_find_int64(ints.data(), len, ints[pos]), std::find(ints.begin(), ints.end(), ints[pos]) - ints.begin());
+      ASSERT_EQ(simd_find_double(doubles.data(), len, doubles[pos]), std::find(doubles.begin(), doubles.end(), doubles[pos]) - doubles.begin());
+    }
+    ASSERT_EQ(simd_find_int64(ints.data(), len, 100500), len);
+    ASSERT_EQ(simd_find_double(doubles.data(), len, 0.5), len);
+    ASSERT_EQ(simd_find_double(doubles.data(), len, NAN), len);
+  }
+  const std::vector<double> zeros{1.0, 2.0, 3.0, 4.0, 5.0, -0.0};
+  ASSERT_EQ(simd_find_double(zeros.data(), zeros.size(), 0.0), 5);
+}
+
+TEST(simd_numeric_kernels, min_max) {
+  const auto less = [](auto lhs, auto rhs) { return lhs < rhs; };
+  const auto greater = [](auto lhs, auto rhs) { return lhs > rhs; };
+  for (size_t len = 1; len < 40; ++len) {
+    for (int64_t seed = 0; seed < 5; ++seed) {
+      const auto ints = make_ints(len, seed);
+      const auto doubles = make_doubles(len, seed);
+      ASSERT_EQ(simd_min_int64(ints.data(), len), reference_select(ints, less));
+      ASSERT_EQ(simd_max_int64(ints.data(), len), reference_select(ints, greater));
+      ASSERT_TRUE(same_double(simd_min_double(doubles.data(), len), reference_select(doubles, less)));
+      ASSERT_TRUE(same_double(simd_max_double(doubles.data(), len), reference_select(doubles, greater)));
+    }
+  }
+  const std::vector<int64_t> extremes{0, std::numeric_limits<int64_t>::min(), 5, std::numeric_limits<int64_t>::max(), -1};
+  ASSERT_EQ(simd_min_int64(extremes.data(), extremes.size()), std::numeric_limits<int64_t>::min());
+  ASSERT_EQ(simd_max_int64(extremes.data(), extremes.size()), std::numeric_limits<int64_t>::max());
+}
+
+TEST(simd_numeric_kernels, min_max_special_doubles) {
+  const std::vector<std::vector<double>> cases{
+    {1.0, NAN, -1.0, 2.0, NAN, 0.5, -3.0, 7.0, NAN},
+    {NAN, 1.0, -1.0, 2.0, 3.0, 4.0, 5.0, 6.0},
+    {-0.0, 1.0, 2.0, 3.0, 0.0, 4.0, 5.0, 6.0, 7.0},
+    {1.0, 2.0, 3.0, 4.0, 0.0, -0.0, 5.0, 6.0, 7.0, -0.0},
+    {-1.0, -2.0, -3.0, -4.0, -0.0, 0.0, -5.0, -6.0, 0.0},
+    {INFINITY, -INFINITY, 1.0, NAN, 2.0, 3.0, 4.0, 5.0},
+  };
+  const auto less = [](double lhs, double rhs) { return lhs < rhs; };
+  const auto greater = [](double lhs, double rhs) { return lhs > rhs; };
+  for (const auto &a : cases) {
+    const double expected_min = reference_select(a, less);
+    const double expected_max = reference_select(a, greater);
+    ASSERT_TRUE(same_double(simd_min_double(a.data(), a.size()), expected_min) || (std::isnan(expected_min) && std::isnan(simd_min_double(a.data(), a.size()))));
+    ASSERT_TRUE(same_double(simd_max_double(a.data(), a.size()), expected_max) || (std::isnan(expected_max) && std::isnan(simd_max_double(a.data(), a.size()))));
+  }
+}
+
+TEST(simd_numeric_kernels, widen_int32) {
+  for (size_t len = 0; len < 40; ++len) {
+    std::vector<int32_t> src;
+    for (int64_t x : make_ints(len, 5)) {
+      src.push_back(static_cast<int32_t>(x * 4000000));
+    }
+    std::vector<int64_t> dst(len);
+    simd_widen_int32_to_int64(src.data(), len, dst.data());
+    ASSERT_TRUE(std::equal(src.begin(), src.end(), dst.begin()));
+  }
+}
+
+TEST(simd_numeric_kernels, narrow_int64) {
+  for (size_t len = 0; len < 40; ++len) {
+    const auto src = make_ints(len, 7);
+    std::vector<int32_t> dst(len);
+    ASSERT_EQ(simd_narrow_int64_to_int32(src.data(), len, dst.data()), len);
+    ASSERT_TRUE(std::equal(src.begin(), src.end(), dst.begin()));
+
+    for (size_t pos = 0; pos < len; ++pos) {
+      for (int64_t bad : {int64_t{std::numeric_limits<int32_t>::min()} - 1, int64_t{std::numeric_limits<uint32_t>::max()} + 1,
+                          std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()}) {
+        auto with_bad = src;
+        with_bad[pos] = bad;
+        ASSERT_EQ(simd_narrow_int64_to_int32(with_bad.data(), len, dst.data()), pos);
+        ASSERT_TRUE(std::equal(src.begin(), src.begin() + pos, dst.begin()));
+      }
+    }
+  }
+  const std::vector<int64_t> bounds{std::numeric_limits<int32_t>::min(), std::numeric_limits<uint32_t>::max(), -1, 0, 1};
+  std::vector<int32_t> dst(bounds.size());
+  ASSERT_EQ(simd_narrow_int64_to_int32(bounds.data(), bounds.size(), dst.data()), bounds.size());
+  ASSERT_EQ(dst, (std::vector<int32_t>{std::numeric_limits<int32_t>::min(), -1, -1, 0, 1}));
+}
@@ -0,0 +1,342 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/algorithms/simd-numeric-kernels.h"
+
+#include <cassert>
+#include <limits>
+
+#if defined(__x86_64__) && defined(__AVX__) && defined(__SSE4_2__)
+#define SIMD_NUMERIC_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+template<class T, class Less>
+T select_scalar(const T *a, size_t size, size_t start, T res, const Less &less) noexcept {
+  for (size_t i = start; i < size; ++i) {
+    if (less(a[i], res)) {
+      res = a[i];
+    }
+  }
+  return res;
+}
+
+constexpr int64_t NARROW_MIN = std::numeric_limits<int32_t>::min();
+constexpr int64_t NARROW_MAX = std::numeric_limits<uint32_t>::max();
+
+void widen_scalar(const int32_t *src, size_t size, size_t start, int64_t *dst) noexcept {
+  for (size_t i = start; i < size; ++i) {
+    dst[i] = src[i];
+  }
+}
+
+size_t narrow_scalar(const int64_t *src, size_t size, size_t start, int32_t *dst) noexcept {
+  size_t i = start;
+  for (; i < size && NARROW_MIN <= src[i] && src[i] <= NARROW_MAX; ++i) {
+    dst[i] = static_cast<int32_t>(src[i]);
+  }
+  return i;
+}
+
+struct Less {
+  template<class T>
+  bool operator()(T lhs, T rhs) const noexcept {
+    return lhs < rhs;
+  }
+};
+
+struct Greater {
+  template<class T>
+  bool operator()(T lhs, T rhs) const noexcept {
+    return lhs > rhs;
+  }
+};
+
+#ifdef SIMD_NUMERIC_X86
+
+bool has_avx2 = false;
+
+__attribute__((constructor(101))) void init_simd_numeric_kernels() {
+  __builtin_cpu_init();
+  has_avx2 = __builtin_cpu_supports("avx2");
+}
+
+// SSE4.2
+
+inline __m128i sse_load(const int64_t *p) noexcept {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+int64_t sum_int64_sse(const int64_t *a, size_t size) noexcept {
+  __m128i acc = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    acc = _mm_add_epi64(acc, sse_load(a + i));
+  }
+  auto res = static_cast<uint64_t>(_mm_extract_epi64(acc, 0)) + static_cast<uint64_t>(_mm_extract_epi64(acc, 1));
+  for (; i < size; ++i) {
+    res += static_cast<uint64_t>(a[i]);
+  }
+  return static_cast<int64_t>(res);
+}
+
+size_t find_int64_sse(const int64_t *a, size_t size, int64_t value) noexcept {
+  const __m128i v = _mm_set1_epi64x(value);
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    if (const int mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(sse_load(a + i), v)))) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  for (; i < size && a[i] != value; ++i) {
+  }
+  return i;
+}
+
+template<bool IsMin>
+int64_t select_int64_sse(const int64_t *a, size_t size) noexcept {
+  __m128i acc = _mm_set1_epi64x(a[0]);
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    const __m128i x = sse_load(a + i);
+    const __m128i take_x = IsMin ? _mm_cmpgt_epi64(acc, x) : _mm_cmpgt_epi64(x, acc);
+    acc = _mm_blendv_epi8(acc, x, take_x);
+  }
+  int64_t lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), acc);
+  if (IsMin) {
+    return select_scalar(a, size, i, lanes[0] < lanes[1] ? lanes[0] : lanes[1], Less{});
+  }
+  return select_scalar(a, size, i, lanes[0] > lanes[1] ? lanes[0] : lanes[1], Greater{});
+}
+
+void widen_int32_sse(const int32_t *src, size_t size, int64_t *dst) noexcept {
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    const __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_cvtepi32_epi64(x));
+  }
+  widen_scalar(src, size, i, dst);
+}
+
+size_t narrow_int64_sse(const int64_t *src, size_t size, int32_t *dst) noexcept {
+  const __m128i min = _mm_set1_epi64x(NARROW_MIN);
+  const __m128i max = _mm_set1_epi64x(NARROW_MAX);
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    const __m128i x = sse_load(src + i);
+    if (!_mm_testz_si128(_mm_or_si128(_mm_cmpgt_epi64(x, max), _mm_cmpgt_epi64(min, x)), _mm_set1_epi64x(-1))) {
+      break;
+    }
+    // low halves of both lanes
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i), _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 0, 2, 0)));
+  }
+  return narrow_scalar(src, size, i, dst);
+}
+
+// AVX2
+
+__attribute__((target("avx2"))) inline __m256i avx2_load(const int64_t *p) noexcept {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+__attribute__((target("avx2"))) int64_t sum_int64_avx2(const int64_t *a, size_t size) noexcept {
+  __m256i acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    acc = _mm256_add_epi64(acc, avx2_load(a + i));
+  }
+  uint64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+  uint64_t res = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  for (; i < size; ++i) {
+    res += static_cast<uint64_t>(a[i]);
+  }
+  return static_cast<int64_t>(res);
+}
+
+__attribute__((target("avx2"))) size_t find_int64_avx2(const int64_t *a, size_t size, int64_t value) noexcept {
+  const __m256i v = _mm256_set1_epi64x(value);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    if (const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(avx2_load(a + i), v)))) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  for (; i < size && a[i] != value; ++i) {
+  }
+  return i;
+}
+
+template<bool IsMin>
+__attribute__((target("avx2"))) int64_t select_int64_avx2(const int64_t *a, size_t size) noexcept {
+  __m256i acc = _mm256_set1_epi64x(a[0]);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const __m256i x = avx2_load(a + i);
+    const __m256i take_x = IsMin ? _mm256_cmpgt_epi64(acc, x) : _mm256_cmpgt_epi64(x, acc);
+    acc = _mm256_blendv_epi8(acc, x, take_x);
+  }
+  int64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+  if (IsMin) {
+    return select_scalar(a, size, i, select_scalar(lanes, 4, 1, lanes[0], Less{}), Less{});
+  }
+  return select_scalar(a, size, i, select_scalar(lanes, 4, 1, lanes[0], Greater{}), Greater{});
+}
+
+__attribute__((target("avx2"))) void widen_int32_avx2(const int32_t *src, size_t size, int64_t *dst) noexcept {
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_cvtepi32_epi64(x));
+  }
+  widen_scalar(src, size, i, dst);
+}
+
+__attribute__((target("avx2"))) size_t narrow_int64_avx2(const int64_t *src, size_t size, int32_t *dst) noexcept {
+  const __m256i min = _mm256_set1_epi64x(NARROW_MIN);
+  const __m256i max = _mm256_set1_epi64x(NARROW_MAX);
+  const __m256i low_halves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const __m256i x = avx2_load(src + i);
+    if (!_mm256_testz_si256(_mm256_or_si256(_mm256_cmpgt_epi64(x, max), _mm256_cmpgt_epi64(min, x)), _mm256_set1_epi64x(-1))) {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(x, low_halves)));
+  }
+  return narrow_scalar(src, size, i, dst);
+}
+
+// AVX
+
+size_t find_double_avx(const double *a, size_t size, double value) noexcept {
+  const __m256d v = _mm256_set1_pd(value);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    if (const int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a + i), v, _CMP_EQ_OQ))) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  for (; i < size && a[i] != value; ++i) {
+  }
+  return i;
+}
+
+// a[0] is not NaN here; min/max instructions return the second operand if any of the operands is NaN,
+// so NaNs never get into the accumulator, as with the scalar loop
+template<bool IsMin>
+double select_double_avx(const double *a, size_t size) noexcept {
+  __m256d acc = _mm256_set1_pd(a[0]);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const __m256d x = _mm256_loadu_pd(a + i);
+    acc = IsMin ? _mm256_min_pd(x, acc) : _mm256_max_pd(x, acc);
+  }
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc);
+  double res = 0;
+  if (IsMin) {
+    res = select_scalar(a, size, i, select_scalar(lanes, 4, 1, lanes[0], Less{}), Less{});
+  } else {
+    res = select_scalar(a, size, i, select_scalar(lanes, 4, 1, lanes[0], Greater{}), Greater{});
+  }
+  // lanes may hold zeros of different signs, the scalar loop takes the first one
+  return res == 0 ? a[find_double_avx(a, size, 0.0)] : res;
+}
+
+#endif
+
+} // namespace
+
+int64_t simd_sum_int64(const int64_t *a, size_t size) noexcept {
+#ifdef SIMD_NUMERIC_X86
+  return has_avx2 ? sum_int64_avx2(a, size) : sum_int64_sse(a, size);
+#else
+  uint64_t res = 0;
+  for (size_t i = 0; i < size; ++i) {
+    res += static_cast<uint64_t>(a[i]);
+  }
+  return static_cast<int64_t>(res);
+#endif
+}
+
+size_t simd_find_int64(const int64_t *a, size_t size, int64_t value) noexcept {
+#ifdef SIMD_NUMERIC_X86
+  return has_avx2 ? find_int64_avx2(a, size, value) : find_int64_sse(a, size, value);
+#else
+  size_t i = 0;
+  for (; i < size && a[i] != value; ++i) {
+  }
+  return i;
+#endif
+}
+
+size_t simd_find_double(const double *a, size_t size, double value) noexcept {
+#ifdef SIMD_NUMERIC_X86
+  return find_double_avx(a, size, value);
+#else
+  size_t i = 0;
+  for (; i < size && a[i] != value; ++i) {
+  }
+  return i;
+#endif
+}
+
+int64_t simd_min_int64(const int64_t *a, size_t size) noexcept {
+  assert(size > 0);
+#ifdef SIMD_NUMERIC_X86
+  return has_avx2 ? select_int64_avx2<true>(a, size) : select_int64_sse<true>(a, size);
+#else
+  return select_scalar(a, size, 1, a[0], Less{});
+#endif
+}
+
+int64_t simd_max_int64(const int64_t *a, size_t size) noexcept {
+  assert(size > 0);
+#ifdef SIMD_NUMERIC_X86
+  return has_avx2 ? select_int64_avx2<false>(a, size) : select_int64_sse<false>(a, size);
+#else
+  return select_scalar(a, size, 1, a[0], Greater{});
+#endif
+}
+
+double simd_min_double(const double *a, size_t size) noexcept {
+  assert(size > 0);
+#ifdef SIMD_NUMERIC_X86
+  if (a[0] == a[0]) {
+    return select_double_avx<true>(a, size);
+  }
+#endif
+  return select_scalar(a, size, 1, a[0], Less{});
+}
+
+double simd_max_double(const double *a, size_t size) noexcept {
+  assert(size > 0);
+#ifdef SIMD_NUMERIC_X86
+  if (a[0] == a[0]) {
+    return select_double_avx<false>(a, size);
+  }
+#endif
+  return select_scalar(a, size, 1, a[0], Greater{});
+}
+
+void simd_widen_int32_to_int64(const int32_t *src, size_t size, int64_t *dst) noexcept {
+#ifdef SIMD_NUMERIC_X86
+  has_avx2 ? widen_int32_avx2(src, size, dst) : widen_int32_sse(src, size, dst);
+#else
+  widen_scalar(src, size, 0, dst);
+#endif
+}
+
+size_t simd_narrow_int64_to_int32(const int64_t *src, size_t size, int32_t *dst) noexcept {
+#ifdef SIMD_NUMERIC_X86
+  return has_avx2 ? narrow_int64_avx2(src, size, dst) : narrow_int64_sse(src, size, dst);
+#else
+  return narrow_scalar(src, size, 0, dst);
+#endif
+}
@@ -0,0 +1,34 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Kernels over contiguous vectors of int64_t and double used by the array builtins and TL serialization.
+// On x86_64 doubles are processed with AVX, int64_t with SSE4.2; AVX2 versions of the int64_t kernels are selected at runtime via cpuid.
+// On other platforms plain scalar loops are used.
+// Results are exactly the same as the ones of the plain scalar loops mentioned below.
+
+// sum with wrapping on overflow
+int64_t simd_sum_int64(const int64_t *a, size_t size) noexcept;
+
+// returns the index of the first element equal to value, or size
+size_t simd_find_int64(const int64_t *a, size_t size, int64_t value) noexcept;
+// comparison is done with ==, so NaN is never found and -0.0 is equal to 0.0
+size_t simd_find_double(const double *a, size_t size, double value) noexcept;
+
+// the same as `res = a[0]; for (i = 1; i < size; ++i) if (a[i] < res) res = a[i];` (> for max), size must be positive:
+// NaNs are skipped unless a[0] is NaN, the first one is taken from equal elements (it matters for -0.0 and 0.0)
+int64_t simd_min_int64(const int64_t *a, size_t size) noexcept;
+int64_t simd_max_int64(const int64_t *a, size_t size) noexcept;
+double simd_min_double(const double *a, size_t size) noexcept;
+double simd_max_double(const double *a, size_t size) noexcept;
+
+// dst[i] = src[i]
+void simd_widen_int32_to_int64(const int32_t *src, size_t size, int64_t *dst) noexcept;
+// dst[i] = static_cast<int32_t>(src[i]) till the first element out of [INT32_MIN; UINT32_MAX] (the range TL int accepts),
+// returns its index, or size
+size_t simd_narrow_int64_to_int32(const int64_t *src, size_t size, int32_t *dst) noexcept;
@@ -0,0 +1,104 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "common/algorithms/simd-string-kernels.h"
+
+namespace {
+// covers scalar tails, SSE2 and AVX2 blocks
+std::string make_text(size_t len) {
+  std::string s;
+  for (size_t i = 0; i < len; ++i) {
+    s.push_back("aB3 zZ-@[`{~\t"[i % 13]);
+  }
+  return s;
+}
+
+std::string lower(const std::string &s) {
+  std::string res(s.size(), '\0');
+  res.resize(simd_ascii_tolower(s.data(), &res[0], s.size()));
+  return res;
+}
+
+std::string upper(const std::string &s) {
+  std::string res(s.size(), '\0');
+  res.resize(simd_ascii_toupper(s.data(), &res[0], s.size()));
+  return res;
+}
+} // namespace
+
+TEST(simd_string_kernels, case_convert) {
+  for (size_t len = 0; len < 100; ++len) {
+    const std::string s = make_text(len);
+    std::string expected_lower = s;
+    std::string expected_upper = s;
+    std::transform(s.begin(), s.end(), expected_lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    std::transform(s.begin(), s.end(), expected_upper.begin(), [](unsigned char c) { return std::toupper(c); });
+    ASSERT_EQ(lower(s), expected_lower);
+    ASSERT_EQ(upper(s), expected_upper);
+  }
+}
+
+TEST(simd_string_kernels, case_convert_stops_on_non_ascii) {
+  for (size_t pos = 0; pos < 70; ++pos) {
+    std::string s = make_text(80);
+    s[pos] = '\xC0';
+    ASSERT_EQ(lower(s).size(), pos);
+    ASSERT_EQ(upper(s).size(), pos);
+  }
+}
+
+TEST(simd_string_kernels, find_ascii_range) {
+  for (size_t len = 0; len < 100; ++len) {
+    for (size_t pos = 0; pos <= len; ++pos) {
+      std::string s(len, 'a');
+      if (pos < len) {
+        s[pos] = 'Q';
+      }
+      ASSERT_EQ(simd_find_ascii_range(s.data(), s.data() + len, 'A', 'Z') - s.data(), pos);
+    }
+  }
+  const std::string s = "\x80\xFF\xC1\xDA@[Z";
+  ASSERT_EQ(simd_find_ascii_range(s.data(), s.data() + s.size(), 'A', 'Z') - s.data(), 6);
+}
+
+TEST(simd_string_kernels, find_first_of) {
+  const std::string set = "&<>\"'";
+  for (size_t len = 0; len < 100; ++len) {
+    for (size_t pos = 0; pos <= len; ++pos) {
+      std::string s(len, 'x');
+      if (pos < len) {
+        s[pos] = set[pos % set.size()];
+      }
+      ASSERT_EQ(simd_find_first_of(s.data(), s.data() + len, set.data(), set.size()) - s.data(), pos);
+    }
+  }
+  const std::string zero("ab\0cd", 5);
+  ASSERT_EQ(simd_find_first_of(zero.data(), zero.data() + zero.size(), "\0", 1) - zero.data(), 2);
+  ASSERT_EQ(simd_find_first_of(zero.data(), zero.data() + zero.size(), "", 0) - zero.data(), 5);
+}
+
+TEST(simd_string_kernels, skip_byte_set) {
+  const std::string set(" \n\r\t\v\0", 6);
+  for (size_t len = 0; len < 70; ++len) {
+    for (size_t left = 0; left <= len; ++left) {
+      const size_t right = (len - left) / 2;
+      std::string s = std::string(left, ' ') + std::string(len - left - right, 'x') + std::string(right, '\t');
+      const char *b = simd_skip_byte_set(s.data(), s.data() + s.size(), set.data(), set.size());
+      const char *e = simd_skip_byte_set_backward(s.data(), s.data() + s.size(), set.data(), set.size());
+      if (left + right == len) {
+        ASSERT_EQ(b - s.data(), len);
+        ASSERT_EQ(e - s.data(), 0);
+      } else {
+        ASSERT_EQ(b - s.data(), left);
+        ASSERT_EQ(e - s.data(), len - right);
+      }
+    }
+  }
+}
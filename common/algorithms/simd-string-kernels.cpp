@@ -0,0 +1,271 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/algorithms/simd-string-kernels.h"
+
+#include <cassert>
+#include <cstdint>
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+namespace {
+
+inline bool in_ascii_range(unsigned char c, char lo, char hi) noexcept {
+  return c >= static_cast<unsigned char>(lo) && c <= static_cast<unsigned char>(hi);
+}
+
+inline bool in_byte_set(char c, const char *set, size_t set_size) noexcept {
+  for (size_t i = 0; i < set_size; ++i) {
+    if (set[i] == c) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *find_ascii_range_scalar(const char *begin, const char *end, char lo, char hi) noexcept {
+  for (; begin != end && !in_ascii_range(*begin, lo, hi); ++begin) {
+  }
+  return begin;
+}
+
+// [lo, hi] is a range of ASCII letters, so xor with 0x20 switches their case
+size_t ascii_case_convert_scalar(const char *src, char *dst, size_t size, char lo, char hi) noexcept {
+  size_t i = 0;
+  for (; i < size; ++i) {
+    const auto c = static_cast<unsigned char>(src[i]);
+    if (c & 0x80) {
+      break;
+    }
+    dst[i] = static_cast<char>(in_ascii_range(c, lo, hi) ? c ^ 0x20 : c);
+  }
+  return i;
+}
+
+const char *find_first_of_scalar(const char *begin, const char *end, const char *set, size_t set_size) noexcept {
+  for (; begin != end && !in_byte_set(*begin, set, set_size); ++begin) {
+  }
+  return begin;
+}
+
+#ifdef __x86_64__
+
+bool has_avx2 = false;
+
+__attribute__((constructor(101))) void init_simd_string_kernels() {
+  __builtin_cpu_init();
+  has_avx2 = __builtin_cpu_supports("avx2");
+}
+
+// SSE2
+
+inline __m128i sse2_load(const char *p) noexcept {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+inline __m128i sse2_in_range(__m128i x, __m128i lo_minus_one, __m128i hi_plus_one) noexcept {
+  // bytes >= 0x80 are negative as signed chars, so they never fall into an ASCII range
+  return _mm_and_si128(_mm_cmpgt_epi8(x, lo_minus_one), _mm_cmplt_epi8(x, hi_plus_one));
+}
+
+inline __m128i sse2_in_set(__m128i x, const __m128i *set, size_t set_size) noexcept {
+  __m128i found = _mm_cmpeq_epi8(x, set[0]);
+  for (size_t i = 1; i < set_size; ++i) {
+    found = _mm_or_si128(found, _mm_cmpeq_epi8(x, set[i]));
+  }
+  return found;
+}
+
+inline void sse2_broadcast_set(const char *set, size_t set_size, __m128i *out) noexcept {
+  for (size_t i = 0; i < set_size; ++i) {
+    out[i] = _mm_set1_epi8(set[i]);
+  }
+}
+
+const char *find_ascii_range_sse2(const char *begin, const char *end, char lo, char hi) noexcept {
+  const __m128i lo_v = _mm_set1_epi8(static_cast<char>(lo - 1));
+  const __m128i hi_v = _mm_set1_epi8(static_cast<char>(hi + 1));
+  for (; end - begin >= 16; begin += 16) {
+    if (const int mask = _mm_movemask_epi8(sse2_in_range(sse2_load(begin), lo_v, hi_v))) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return find_ascii_range_scalar(begin, end, lo, hi);
+}
+
+size_t ascii_case_convert_sse2(const char *src, char *dst, size_t size, char lo, char hi) noexcept {
+  const __m128i lo_v = _mm_set1_epi8(static_cast<char>(lo - 1));
+  const __m128i hi_v = _mm_set1_epi8(static_cast<char>(hi + 1));
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i x = sse2_load(src + i);
+    if (_mm_movemask_epi8(x)) {
+      break;
+    }
+    const __m128i converted = _mm_xor_si128(x, _mm_and_si128(sse2_in_range(x, lo_v, hi_v), case_bit));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), converted);
+  }
+  return i + ascii_case_convert_scalar(src + i, dst + i, size - i, lo, hi);
+}
+
+const char *find_first_of_sse2(const char *begin, const char *end, const char *set, size_t set_size) noexcept {
+  __m128i set_v[SIMD_BYTE_SET_MAX_SIZE];
+  sse2_broadcast_set(set, set_size, set_v);
+  for (; end - begin >= 16; begin += 16) {
+    if (const int mask = _mm_movemask_epi8(sse2_in_set(sse2_load(begin), set_v, set_size))) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return find_first_of_scalar(begin, end, set, set_size);
+}
+
+// AVX2
+
+__attribute__((target("avx2"))) inline __m256i avx2_load(const char *p) noexcept {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+__attribute__((target("avx2"))) inline __m256i avx2_in_range(__m256i x, __m256i lo_minus_one, __m256i hi_plus_one) noexcept {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(x, lo_minus_one), _mm256_cmpgt_epi8(hi_plus_one, x));
+}
+
+__attribute__((target("avx2"))) const char *find_ascii_range_avx2(const char *begin, const char *end, char lo, char hi) noexcept {
+  const __m256i lo_v = _mm256_set1_epi8(static_cast<char>(lo - 1));
+  const __m256i hi_v = _mm256_set1_epi8(static_cast<char>(hi + 1));
+  for (; end - begin >= 32; begin += 32) {
+    if (const uint32_t mask = _mm256_movemask_epi8(avx2_in_range(avx2_load(begin), lo_v, hi_v))) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return find_ascii_range_sse2(begin, end, lo, hi);
+}
+
+__attribute__((target("avx2"))) size_t ascii_case_convert_avx2(const char *src, char *dst, size_t size, char lo, char hi) noexcept {
+  const __m256i lo_v = _mm256_set1_epi8(static_cast<char>(lo - 1));
+  const __m256i hi_v = _mm256_set1_epi8(static_cast<char>(hi + 1));
+  const __m256i case_bit = _mm256_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const __m256i x = avx2_load(src + i);
+    if (_mm256_movemask_epi8(x)) {
+      break;
+    }
+    const __m256i converted = _mm256_xor_si256(x, _mm256_and_si256(avx2_in_range(x, lo_v, hi_v), case_bit));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), converted);
+  }
+  return i + ascii_case_convert_sse2(src + i, dst + i, size - i, lo, hi);
+}
+
+__attribute__((target("avx2"))) const char *find_first_of_avx2(const char *begin, const char *end, const char *set, size_t set_size) noexcept {
+  __m256i set_v[SIMD_BYTE_SET_MAX_SIZE];
+  for (size_t i = 0; i < set_size; ++i) {
+    set_v[i] = _mm256_set1_epi8(set[i]);
+  }
+  for (; end - begin >= 32; begin += 32) {
+    const __m256i x = avx2_load(begin);
+    __m256i found = _mm256_cmpeq_epi8(x, set_v[0]);
+    for (size_t i = 1; i < set_size; ++i) {
+      found = _mm256_or_si256(found, _mm256_cmpeq_epi8(x, set_v[i]));
+    }
+    if (const uint32_t mask = _mm256_movemask_epi8(found)) {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return find_first_of_sse2(begin, end, set, set_size);
+}
+
+#endif // __x86_64__
+
+size_t ascii_case_convert(const char *src, char *dst, size_t size, char lo, char hi) noexcept {
+#ifdef __x86_64__
+  if (has_avx2 && size >= 32) {
+    return ascii_case_convert_avx2(src, dst, size, lo, hi);
+  }
+  return ascii_case_convert_sse2(src, dst, size, lo, hi);
+#else
+  return ascii_case_convert_scalar(src, dst, size, lo, hi);
+#endif
+}
+
+} // namespace
+
+const char *simd_find_ascii_range(const char *begin, const char *end, char lo, char hi) noexcept {
+  assert(!(lo & 0x80) && !(hi & 0x80) && lo <= hi);
+#ifdef __x86_64__
+  if (has_avx2 && end - begin >= 32) {
+    return find_ascii_range_avx2(begin, end, lo, hi);
+  }
+  return find_ascii_range_sse2(begin, end, lo, hi);
+#else
+  return find_ascii_range_scalar(begin, end, lo, hi);
+#endif
+}
+
+size_t simd_ascii_tolower(const char *src, char *dst, size_t size) noexcept {
+  return ascii_case_convert(src, dst, size, 'A', 'Z');
+}
+
+size_t simd_ascii_toupper(const char *src, char *dst, size_t size) noexcept {
+  return ascii_case_convert(src, dst, size, 'a', 'z');
+}
+
+const char *simd_find_first_of(const char *begin, const char *end, const char *set, size_t set_size) noexcept {
+  assert(set_size <= SIMD_BYTE_SET_MAX_SIZE);
+  if (set_size == 0) {
+    return end;
+  }
+#ifdef __x86_64__
+  if (has_avx2 && end - begin >= 32) {
+    return find_first_of_avx2(begin, end, set, set_size);
+  }
+  return find_first_of_sse2(begin, end, set, set_size);
+#else
+  return find_first_of_scalar(begin, end, set, set_size);
+#endif
+}
+
+// trimmed runs are usually short, so only the SSE2 versions are provided for skipping
+
+const char *simd_skip_byte_set(const char *begin, const char *end, const char *set, size_t set_size) noexcept {
+  assert(set_size <= SIMD_BYTE_SET_MAX_SIZE);
+  if (set_size == 0) {
+    return begin;
+  }
+#ifdef __x86_64__
+  __m128i set_v[SIMD_BYTE_SET_MAX_SIZE];
+  sse2_broadcast_set(set, set_size, set_v);
+  for (; end - begin >= 16; begin += 16) {
+    const int mask = _mm_movemask_epi8(sse2_in_set(sse2_load(begin), set_v, set_size));
+    if (mask != 0xFFFF) {
+      return begin + __builtin_ctz(~mask);
+    }
+  }
+#endif
+  for (; begin != end && in_byte_set(*begin, set, set_size); ++begin) {
+  }
+  return begin;
+}
+
+const char *simd_skip_byte_set_backward(const char *begin, const char *end, const char *set, size_t set_size) noexcept {
+  assert(set_size <= SIMD_BYTE_SET_MAX_SIZE);
+  if (set_size == 0) {
+    return end;
+  }
+#ifdef __x86_64__
+  __m128i set_v[SIMD_BYTE_SET_MAX_SIZE];
+  sse2_broadcast_set(set, set_size, set_v);
+  for (; end - begin >= 16; end -= 16) {
+    const int mask = _mm_movemask_epi8(sse2_in_set(sse2_load(end - 16), set_v, set_size));
+    if (mask != 0xFFFF) {
+      return end - 16 + (31 - __builtin_clz(~mask & 0xFFFF)) + 1;
+    }
+  }
+#endif
+  for (; end != begin && in_byte_set(end[-1], set, set_size); --end) {
+  }
+  return end;
+}
@@ -0,0 +1,32 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstddef>
+
+// Byte-oriented string kernels used by the string builtins.
+// On x86_64 they are implemented with SSE2, AVX2 versions are selected at runtime via cpuid;
+// on other platforms plain scalar loops are used.
+// None of the kernels reads memory outside of the passed [begin, end) range.
+
+// returns the first byte from [begin, end) that lies in the ASCII range [lo, hi], or end
+const char *simd_find_ascii_range(const char *begin, const char *end, char lo, char hi) noexcept;
+
+// converts the longest ASCII prefix of src (at most size bytes) to lower/upper case into dst,
+// returns the length of the converted prefix: the conversion stops on the first non-ASCII byte
+size_t simd_ascii_tolower(const char *src, char *dst, size_t size) noexcept;
+size_t simd_ascii_toupper(const char *src, char *dst, size_t size) noexcept;
+
+constexpr size_t SIMD_BYTE_SET_MAX_SIZE = 16;
+
+// returns the first byte from [begin, end) that is one of set[0..set_size), or end;
+// set_size must not exceed SIMD_BYTE_SET_MAX_SIZE
+const char *simd_find_first_of(const char *begin, const char *end, const char *set, size_t set_size) noexcept;
+
+// skip bytes from set[0..set_size) at the beginning (forward) or at the end (backward) of [begin, end):
+// forward version returns the first byte not in the set or end,
+// backward version returns the pointer past the last byte not in the set or begin
+const char *simd_skip_byte_set(const char *begin, const char *end, const char *set, size_t set_size) noexcept;
+const char *simd_skip_byte_set_backward(const char *begin, const char *end, const char *set, size_t set_size) noexcept;
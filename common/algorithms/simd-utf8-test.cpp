@@ -0,0 +1,95 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "common/algorithms/simd-utf8.h"
+
+namespace {
+// "Привет, мир! € 𝄞" with 1, 2, 3 and 4 byte characters
+const std::string utf8_text = "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82, \xD0\xBC\xD0\xB8\xD1\x80! \xE2\x82\xAC \xF0\x9D\x84\x9E";
+constexpr size_t utf8_text_length = 16;
+
+bool validate(const std::string &s) {
+  return simd_utf8_validate(s.data(), s.size());
+}
+
+// puts the sequence at every position of a long ASCII string to cover block boundaries
+void check_everywhere(const std::string &sequence, bool expected) {
+  for (size_t pos = 0; pos < 70; ++pos) {
+    std::string s(pos, 'a');
+    s += sequence;
+    ASSERT_EQ(validate(s), expected) << "pos = " << pos;
+    s += std::string(70 - pos, 'b');
+    ASSERT_EQ(validate(s), expected) << "pos = " << pos;
+  }
+}
+} // namespace
+
+TEST(simd_utf8, ascii_prefix_length) {
+  for (size_t len = 0; len < 100; ++len) {
+    for (size_t pos = 0; pos <= len; ++pos) {
+      std::string s(len, '\0');
+      if (pos < len) {
+        s[pos] = '\xC0';
+      }
+      ASSERT_EQ(simd_ascii_prefix_length(s.data(), s.size()), pos);
+    }
+  }
+}
+
+TEST(simd_utf8, validate_valid) {
+  ASSERT_TRUE(validate(""));
+  ASSERT_TRUE(validate(std::string("a\0b", 3)));
+  std::string s;
+  for (int i = 0; i < 20; ++i) {
+    s += utf8_text;
+    ASSERT_TRUE(validate(s));
+  }
+  check_everywhere("\xC2\x80", true);
+  check_everywhere("\xDF\xBF", true);
+  check_everywhere("\xE0\xA0\x80", true);
+  check_everywhere("\xED\x9F\xBF", true);
+  check_everywhere("\xEE\x80\x80", true);
+  check_everywhere("\xF0\x90\x80\x80", true);
+  check_everywhere("\xF4\x8F\xBF\xBF", true);
+}
+
+TEST(simd_utf8, validate_invalid) {
+  check_everywhere("\x80", false);
+  check_everywhere("\xBF\xBF", false);
+  check_everywhere("\xC0\x80", false);
+  check_everywhere("\xC1\xBF", false);
+  check_everywhere("\xC2", false);
+  check_everywhere("\xC2\x80\x80", false);
+  check_everywhere("\xE0\x9F\xBF", false);
+  check_everywhere("\xE1\x80", false);
+  check_everywhere("\xED\xA0\x80", false);
+  check_everywhere("\xED\xBF\xBF", false);
+  check_everywhere("\xF0\x8F\xBF\xBF", false);
+  check_everywhere("\xF0\x90\x80", false);
+  check_everywhere("\xF4\x90\x80\x80", false);
+  check_everywhere("\xF5\x80\x80\x80", false);
+  check_everywhere("\xF8\x88\x80\x80\x80", false);
+  check_everywhere("\xFF", false);
+}
+
+TEST(simd_utf8, length_and_advance) {
+  std::string s;
+  for (size_t n = 1; n <= 10; ++n) {
+    s += utf8_text;
+    ASSERT_EQ(simd_utf8_length(s.data(), s.size()), n * utf8_text_length);
+    for (size_t i = 0; i <= n * utf8_text_length; ++i) {
+      const size_t expected = i == n * utf8_text_length ? s.size() : (i / utf8_text_length) * utf8_text.size() + simd_utf8_advance(utf8_text.data(), utf8_text.size(), i % utf8_text_length);
+      ASSERT_EQ(simd_utf8_advance(s.data(), s.size(), i), expected);
+      ASSERT_EQ(simd_utf8_length(s.data(), expected), i);
+    }
+  }
+  ASSERT_EQ(simd_utf8_advance(utf8_text.data(), utf8_text.size(), 1), 2);
+  ASSERT_EQ(simd_utf8_advance(utf8_text.data(), utf8_text.size(), 15), utf8_text.size() - 4);
+  // leading continuation bytes don't start a character
+  ASSERT_EQ(simd_utf8_advance("\x80\x80" "a", 3, 0), 2);
+}
@@ -0,0 +1,446 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/algorithms/simd-utf8.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__SSSE3__)
+#define SIMD_UTF8_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+inline bool is_utf8_continuation(unsigned char c) noexcept {
+  return (c & 0xC0) == 0x80;
+}
+
+size_t ascii_prefix_length_scalar(const char *s, size_t size) noexcept {
+  size_t i = 0;
+  for (; i < size && !(s[i] & 0x80); ++i) {
+  }
+  return i;
+}
+
+bool utf8_validate_scalar(const char *str, size_t size) noexcept {
+  const auto *s = reinterpret_cast<const unsigned char *>(str);
+  size_t i = 0;
+  while (i < size) {
+    const unsigned int a = s[i];
+    if (a < 0x80) {
+      ++i;
+      continue;
+    }
+
+    size_t len = 0;
+    if (a >= 0xC2 && a <= 0xDF) {
+      len = 2;
+    } else if ((a & 0xF0) == 0xE0) {
+      len = 3;
+    } else if (a >= 0xF0 && a <= 0xF4) {
+      len = 4;
+    } else {
+      return false;
+    }
+    if (size - i < len) {
+      return false;
+    }
+    for (size_t k = 1; k < len; ++k) {
+      if (!is_utf8_continuation(s[i + k])) {
+        return false;
+      }
+    }
+
+    const unsigned int b = s[i + 1];
+    if ((a == 0xE0 && b < 0xA0) || (a == 0xED && b >= 0xA0) || (a == 0xF0 && b < 0x90) || (a == 0xF4 && b >= 0x90)) {
+      // overlong encodings, surrogates and code points above U+10FFFF
+      return false;
+    }
+    i += len;
+  }
+  return true;
+}
+
+size_t utf8_length_scalar(const char *s, size_t size) noexcept {
+  size_t res = 0;
+  for (size_t i = 0; i < size; ++i) {
+    res += !is_utf8_continuation(s[i]);
+  }
+  return res;
+}
+
+size_t utf8_advance_scalar(const char *s, size_t size, size_t &chars_count) noexcept {
+  size_t i = 0;
+  for (; i < size; ++i) {
+    if (!is_utf8_continuation(s[i])) {
+      if (chars_count == 0) {
+        return i;
+      }
+      --chars_count;
+    }
+  }
+  return i;
+}
+
+#ifdef SIMD_UTF8_X86
+
+bool has_avx2 = false;
+
+__attribute__((constructor(101))) void init_simd_utf8() {
+  __builtin_cpu_init();
+  has_avx2 = __builtin_cpu_supports("avx2");
+}
+
+// Error classes of the lookup algorithm, each pair of adjacent bytes is classified by three 16-entry tables:
+// by the high and the low nibbles of the first byte and by the high nibble of the second byte,
+// the pair is invalid if all three lookups share a bit
+constexpr uint8_t TOO_SHORT = 1 << 0;   // 11______ 0_______ or 11______ 11______
+constexpr uint8_t TOO_LONG = 1 << 1;    // 0_______ 10______
+constexpr uint8_t OVERLONG_3 = 1 << 2;  // 11100000 100_____
+constexpr uint8_t TOO_LARGE = 1 << 3;   // 11110100 1001____, 11110100 101_____, 11110101+ 1001____...
+constexpr uint8_t SURROGATE = 1 << 4;   // 11101101 101_____
+constexpr uint8_t OVERLONG_2 = 1 << 5;  // 1100000_ 10______
+constexpr uint8_t TOO_LARGE_1000 = 1 << 6; // 11110101+ 1000____
+constexpr uint8_t OVERLONG_4 = 1 << 6;  // 11110000 1000____
+constexpr uint8_t TWO_CONTS = 1 << 7;   // 10______ 10______, it is valid only as the 3rd or the 4th byte of a sequence
+constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+#define UTF8_TABLE(...) alignas(16) constexpr uint8_t __VA_ARGS__
+
+UTF8_TABLE(byte_1_high_table[16]) = {
+  // 0_______ ________
+  TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+  // 10______ ________
+  TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+  // 1100____ ________
+  TOO_SHORT | OVERLONG_2,
+  // 1101____ ________
+  TOO_SHORT,
+  // 1110____ ________
+  TOO_SHORT | OVERLONG_3 | SURROGATE,
+  // 1111____ ________
+  TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4};
+
+UTF8_TABLE(byte_1_low_table[16]) = {
+  // ____0000 ________
+  CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+  // ____0001 ________
+  CARRY | OVERLONG_2,
+  // ____001_ ________
+  CARRY, CARRY,
+  // ____0100 ________
+  CARRY | TOO_LARGE,
+  // ____0101 ________ ... ____1100 ________
+  CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+  CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+  CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+  // ____1101 ________
+  CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+  // ____111_ ________
+  CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000};
+
+UTF8_TABLE(byte_2_high_table[16]) = {
+  // ________ 0_______
+  TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+  // ________ 1000____
+  TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+  // ________ 1001____
+  TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+  // ________ 101_____
+  TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+  // ________ 11______
+  TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT};
+
+// a block is incomplete if one of its last 3 bytes starts a sequence that doesn't fit into it
+UTF8_TABLE(incomplete_max_table[32]) = {
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1};
+
+#undef UTF8_TABLE
+
+// SSE2 / SSSE3
+
+inline __m128i sse_load(const void *p) noexcept {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+inline int sse_non_continuation_mask(__m128i x) noexcept {
+  // continuation bytes are [0x80, 0xBF], i.e. [-128, -65] as signed chars
+  return _mm_movemask_epi8(_mm_cmpgt_epi8(x, _mm_set1_epi8(-65)));
+}
+
+class Utf8CheckerSsse3 {
+public:
+  void check_block(__m128i input) noexcept {
+    if (_mm_movemask_epi8(input) == 0) {
+      // an ASCII block is valid by itself, but it can't finish the sequence started in the previous block
+      error_ = _mm_or_si128(error_, prev_incomplete_);
+      return;
+    }
+    const __m128i prev1 = _mm_alignr_epi8(input, prev_input_, 15);
+    const __m128i special_cases = check_special_cases(input, prev1);
+    error_ = _mm_or_si128(error_, check_multibyte_lengths(input, special_cases));
+    prev_incomplete_ = _mm_subs_epu8(input, sse_load(incomplete_max_table + 16));
+    prev_input_ = input;
+  }
+
+  bool is_valid() const noexcept {
+    const __m128i error = _mm_or_si128(error_, prev_incomplete_);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+  }
+
+private:
+  static __m128i high_nibbles(__m128i x) noexcept {
+    return _mm_and_si128(_mm_srli_epi16(x, 4), _mm_set1_epi8(0x0F));
+  }
+
+  static __m128i check_special_cases(__m128i input, __m128i prev1) noexcept {
+    const __m128i byte_1_high = _mm_shuffle_epi8(sse_load(byte_1_high_table), high_nibbles(prev1));
+    const __m128i byte_1_low = _mm_shuffle_epi8(sse_load(byte_1_low_table), _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+    const __m128i byte_2_high = _mm_shuffle_epi8(sse_load(byte_2_high_table), high_nibbles(input));
+    return _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+  }
+
+  // two continuations in a row are valid only after 3 and 4 byte leads, and they are required there
+  __m128i check_multibyte_lengths(__m128i input, __m128i special_cases) const noexcept {
+    const __m128i prev2 = _mm_alignr_epi8(input, prev_input_, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, prev_input_, 13);
+    const __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    const __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(static_cast<char>(0x80)));
+    return _mm_xor_si128(must_be_continuation, special_cases);
+  }
+
+  __m128i error_{_mm_setzero_si128()};
+  __m128i prev_input_{_mm_setzero_si128()};
+  __m128i prev_incomplete_{_mm_setzero_si128()};
+};
+
+size_t ascii_prefix_length_sse2(const char *s, size_t size) noexcept {
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    if (_mm_movemask_epi8(_mm_or_si128(sse_load(s + i), sse_load(s + i + 16)))) {
+      break;
+    }
+  }
+  for (; i + 16 <= size; i += 16) {
+    if (const int mask = _mm_movemask_epi8(sse_load(s + i))) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + ascii_prefix_length_scalar(s + i, size - i);
+}
+
+bool utf8_validate_ssse3(const char *s, size_t size) noexcept {
+  Utf8CheckerSsse3 checker;
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const __m128i lo = sse_load(s + i);
+    const __m128i hi = sse_load(s + i + 16);
+    checker.check_block(lo);
+    checker.check_block(hi);
+  }
+  for (; i + 16 <= size; i += 16) {
+    checker.check_block(sse_load(s + i));
+  }
+  if (i != size) {
+    // zero padding is ASCII, so it reveals the sequences cut off by the end of the string
+    alignas(16) char tail[16] = {0};
+    memcpy(tail, s + i, size - i);
+    checker.check_block(sse_load(tail));
+  }
+  return checker.is_valid();
+}
+
+size_t utf8_length_sse2(const char *s, size_t size) noexcept {
+  size_t res = 0;
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    res += __builtin_popcount(sse_non_continuation_mask(sse_load(s + i)));
+  }
+  return res + utf8_length_scalar(s + i, size - i);
+}
+
+size_t utf8_advance_sse2(const char *s, size_t size, size_t chars_count) noexcept {
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    unsigned int mask = sse_non_continuation_mask(sse_load(s + i));
+    const size_t count = __builtin_popcount(mask);
+    if (count > chars_count) {
+      for (; chars_count; --chars_count) {
+        mask &= mask - 1;
+      }
+      return i + __builtin_ctz(mask);
+    }
+    chars_count -= count;
+  }
+  return i + utf8_advance_scalar(s + i, size - i, chars_count);
+}
+
+// AVX2
+
+__attribute__((target("avx2"))) inline __m256i avx2_load(const void *p) noexcept {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+}
+
+__attribute__((target("avx2"))) inline __m256i avx2_load_table(const uint8_t *table) noexcept {
+  return _mm256_broadcastsi128_si256(sse_load(table));
+}
+
+__attribute__((target("avx2"))) inline uint32_t avx2_non_continuation_mask(__m256i x) noexcept {
+  return _mm256_movemask_epi8(_mm256_cmpgt_epi8(x, _mm256_set1_epi8(-65)));
+}
+
+class Utf8CheckerAvx2 {
+public:
+  __attribute__((target("avx2"))) Utf8CheckerAvx2() noexcept
+    : error_(_mm256_setzero_si256())
+    , prev_input_(_mm256_setzero_si256())
+    , prev_incomplete_(_mm256_setzero_si256())
+    , byte_1_high_(avx2_load_table(byte_1_high_table))
+    , byte_1_low_(avx2_load_table(byte_1_low_table))
+    , byte_2_high_(avx2_load_table(byte_2_high_table)) {}
+
+  __attribute__((target("avx2"))) void check_block(__m256i input) noexcept {
+    if (_mm256_movemask_epi8(input) == 0) {
+      error_ = _mm256_or_si256(error_, prev_incomplete_);
+      return;
+    }
+    // bytes of the previous block followed by the current one, shifted across the lanes
+    const __m256i prev_shifted = _mm256_permute2x128_si256(prev_input_, input, 0x21);
+    const __m256i prev1 = _mm256_alignr_epi8(input, prev_shifted, 15);
+    const __m256i prev2 = _mm256_alignr_epi8(input, prev_shifted, 14);
+    const __m256i prev3 = _mm256_alignr_epi8(input, prev_shifted, 13);
+
+    const __m256i nibble_mask = _mm256_set1_epi8(0x0F);
+    const __m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble_mask));
+    const __m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_, _mm256_and_si256(prev1, nibble_mask));
+    const __m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble_mask));
+    const __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    const __m256i is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    const __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8(static_cast<char>(0x80)));
+
+    error_ = _mm256_or_si256(error_, _mm256_xor_si256(must_be_continuation, special_cases));
+    prev_incomplete_ = _mm256_subs_epu8(input, avx2_load(incomplete_max_table));
+    prev_input_ = input;
+  }
+
+  __attribute__((target("avx2"))) bool is_valid() const noexcept {
+    const __m256i error = _mm256_or_si256(error_, prev_incomplete_);
+    return _mm256_testz_si256(error, error);
+  }
+
+private:
+  __m256i error_;
+  __m256i prev_input_;
+  __m256i prev_incomplete_;
+  const __m256i byte_1_high_;
+  const __m256i byte_1_low_;
+  const __m256i byte_2_high_;
+};
+
+__attribute__((target("avx2"))) size_t ascii_prefix_length_avx2(const char *s, size_t size) noexcept {
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    if (const uint32_t mask = _mm256_movemask_epi8(avx2_load(s + i))) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + ascii_prefix_length_sse2(s + i, size - i);
+}
+
+__attribute__((target("avx2"))) bool utf8_validate_avx2(const char *s, size_t size) noexcept {
+  Utf8CheckerAvx2 checker;
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    checker.check_block(avx2_load(s + i));
+  }
+  if (i != size) {
+    alignas(32) char tail[32] = {0};
+    memcpy(tail, s + i, size - i);
+    checker.check_block(avx2_load(tail));
+  }
+  return checker.is_valid();
+}
+
+__attribute__((target("avx2"))) size_t utf8_length_avx2(const char *s, size_t size) noexcept {
+  size_t res = 0;
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    res += __builtin_popcount(avx2_non_continuation_mask(avx2_load(s + i)));
+  }
+  return res + utf8_length_sse2(s + i, size - i);
+}
+
+__attribute__((target("avx2"))) size_t utf8_advance_avx2(const char *s, size_t size, size_t chars_count) noexcept {
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    uint32_t mask = avx2_non_continuation_mask(avx2_load(s + i));
+    const size_t count = __builtin_popcount(mask);
+    if (count > chars_count) {
+      for (; chars_count; --chars_count) {
+        mask &= mask - 1;
+      }
+      return i + __builtin_ctz(mask);
+    }
+    chars_count -= count;
+  }
+  return i + utf8_advance_sse2(s + i, size - i, chars_count);
+}
+
+#endif // SIMD_UTF8_X86
+
+} // namespace
+
+size_t simd_ascii_prefix_length(const char *s, size_t size) noexcept {
+#ifdef SIMD_UTF8_X86
+  if (has_avx2 && size >= 32) {
+    return ascii_prefix_length_avx2(s, size);
+  }
+  return ascii_prefix_length_sse2(s, size);
+#else
+  return ascii_prefix_length_scalar(s, size);
+#endif
+}
+
+bool simd_utf8_validate(const char *s, size_t size) noexcept {
+  // most of the strings are ASCII, the lookup machinery is needed only from the first non-ASCII byte
+  const size_t ascii_len = simd_ascii_prefix_length(s, size);
+  s += ascii_len;
+  size -= ascii_len;
+#ifdef SIMD_UTF8_X86
+  if (size < 16) {
+    return utf8_validate_scalar(s, size);
+  }
+  return has_avx2 ? utf8_validate_avx2(s, size) : utf8_validate_ssse3(s, size);
+#else
+  return utf8_validate_scalar(s, size);
+#endif
+}
+
+size_t simd_utf8_length(const char *s, size_t size) noexcept {
+#ifdef SIMD_UTF8_X86
+  if (has_avx2 && size >= 32) {
+    return utf8_length_avx2(s, size);
+  }
+  return utf8_length_sse2(s, size);
+#else
+  return utf8_length_scalar(s, size);
+#endif
+}
+
+size_t simd_utf8_advance(const char *s, size_t size, size_t chars_count) noexcept {
+#ifdef SIMD_UTF8_X86
+  if (has_avx2 && size >= 32) {
+    return utf8_advance_avx2(s, size, chars_count);
+  }
+  return utf8_advance_sse2(s, size, chars_count);
+#else
+  return utf8_advance_scalar(s, size, chars_count);
+#endif
+}
@@ -0,0 +1,25 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstddef>
+
+// UTF-8 kernels used by the mb_* and vk_utf8_* builtins.
+// ASCII blocks are skipped 32 bytes per step; multibyte blocks are validated with the lookup algorithm
+// by J. Keiser and D. Lemire ("Validating UTF-8 in less than one instruction per byte"),
+// SSSE3 and AVX2 versions are provided on x86_64 (AVX2 is selected at runtime via cpuid).
+// All the kernels are binary safe: '\0' is a regular ASCII character for them.
+
+// returns the length of the longest prefix of s consisting of ASCII characters
+size_t simd_ascii_prefix_length(const char *s, size_t size) noexcept;
+
+// checks that s is a valid UTF-8 string: no overlong encodings, no surrogates, no code points above U+10FFFF
+bool simd_utf8_validate(const char *s, size_t size) noexcept;
+
+// returns the number of UTF-8 characters in s, i.e. the number of bytes that are not continuation bytes
+size_t simd_utf8_length(const char *s, size_t size) noexcept;
+
+// returns the offset of the first byte of the UTF-8 character with index chars_count, or size if there are not so many characters
+size_t simd_utf8_advance(const char *s, size_t size, size_t chars_count) noexcept;
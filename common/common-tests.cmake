@@ -4,6 +4,9 @@ prepend(COMMON_TESTS_SOURCES ${COMMON_DIR}/
         algorithms/hashes-test.cpp
         algorithms/projections-test.cpp
         algorithms/simd-int-to-string-test.cpp
+        algorithms/simd-numeric-kernels-test.cpp
+        algorithms/simd-string-kernels-test.cpp
+        algorithms/simd-utf8-test.cpp
         algorithms/string-algorithms-test.cpp
         allocators/freelist-test.cpp
         allocators/lockfree-slab-test.cpp
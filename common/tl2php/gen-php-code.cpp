@@ -498,6 +498,9 @@ struct GetterMethod : protected RpcResponseChecker {
   virtual const char *func_name() const = 0;
   virtual const char *ret_type() const = 0;
   virtual std::string ret_value() const = 0;
+  virtual void write_body(std::ostream &os) const {
+    os << "    return " << ret_value() << ";" << std::endl;
+  }
   virtual ~GetterMethod() = default;
 
   friend std::ostream &operator<<(std::ostream &os, const GetterMethod &self) {
@@ -510,9 +513,9 @@ struct GetterMethod : protected RpcResponseChecker {
       assert(self.repr.is_interface);
       os << ";";
     } else {
-      os << " {" << std::endl
-         << "    return " << self.ret_value() << ";" << std::endl
-         << "  }";
+      os << " {" << std::endl;
+      self.write_body(os);
+      os << "  }";
     }
     return os << SkipLine{};
   }
@@ -539,6 +542,19 @@ struct GetResultMethod final : GetterMethod {
     assert(result_field);
     return "$this->" + result_field->field_name;
   }
+  void write_body(std::ostream &os) const final {
+    if (is_rpc_response_error) {
+      GetterMethod::write_body(os);
+      return;
+    }
+    // after typed_rpc_tl_set_lazy_results(true) the result is kept as raw TL until the first call
+    const std::string result = ret_value();
+    os << "#ifndef KPHP" << std::endl
+       << "    return " << result << ";" << std::endl
+       << "#endif" << std::endl
+       << "    " << result << " = typed_rpc_tl_fetch_lazy_result(" << result << ");" << std::endl
+       << "    return " << result << ";" << std::endl;
+  }
 };
 
 struct GetHeaderMethod final : GetterMethod {
@@ -103,6 +103,20 @@ void FunctionForkDeclaration::compile(CodeGenerator &W) const {
                                 "(" << FunctionParams(function, in_header) << ")";
 }
 
+VtableMethodDeclaration::VtableMethodDeclaration(FunctionPtr function, ClassPtr klass) :
+  function(function),
+  klass(klass) {
+}
+
+void VtableMethodDeclaration::compile(CodeGenerator &W) const {
+  W << TypeName(tinf::get_type(function, -1)) << " ";
+  if (klass) {
+    W << klass->src_name << "::";
+  }
+  // $this is not passed, it's a C++ this
+  W << VtableMethodName(function) << "(" << FunctionParams(function, size_t{1}) << ")";
+}
+
 FunctionParams::FunctionParams(FunctionPtr function, bool in_header, gen_out_style style) :
   FunctionParams(function, 0, in_header, style) {
 }
@@ -122,7 +136,7 @@ void FunctionParams::declare_cpp_param(CodeGenerator &W, VertexAdaptor<op_var> v
   auto var_ptr = var->var_id;
   if (var->ref_flag) {
     W << "&";
-  } else if (var_ptr->marked_as_const || (!function->has_variadic_param && var_ptr->is_read_only)) {
+  } else if (function->is_const_param(var_ptr)) {
     W << (!type.type->is_primitive_type() ? "const &" : "");
   }
   W << VarName(var_ptr);
@@ -399,6 +413,7 @@ void InterfaceDeclaration::compile(CodeGenerator &W) const {
   if (!interface->implements.empty()) {
     includes.add_base_classes_include(interface);
   }
+  ClassDeclaration::add_vtable_methods_forward_declarations(includes, interface);
   if (!interface->json_encoders.empty()) {
     includes.add_raw_filename_include(JsonEncoderTags::all_tags_file_);
   }
@@ -585,6 +600,33 @@ void ClassDeclaration::compile_inner_methods(CodeGenerator &W, ClassPtr klass) {
   compile_msgpack_declarations(W, klass);
   compile_virtual_builtin_functions(W, klass);
   compile_wakeup(W, klass);
+  compile_vtable_methods(W, klass);
+}
+
+void ClassDeclaration::add_vtable_methods_forward_declarations(IncludesCollector &includes, ClassPtr klass) {
+  for (FunctionPtr method : klass->vtable_methods) {
+    if (method->is_dispatched_through_vtable()) {
+      includes.add_function_signature_forward_declarations(method);
+    }
+  }
+}
+
+void ClassDeclaration::compile_vtable_methods(CodeGenerator &W, ClassPtr klass) {
+  std::vector<FunctionPtr> methods = klass->vtable_methods;
+  std::sort(methods.begin(), methods.end(), [](FunctionPtr lhs, FunctionPtr rhs) { return lhs->name < rhs->name; });
+  for (FunctionPtr method : methods) {
+    if (!method->is_dispatched_through_vtable()) {
+      continue;
+    }
+    // declared in a class of a virtual method, overridden in all classes of a hierarchy;
+    // definitions are placed near the virtual method, as they call implementations
+    const bool is_declared = method->class_id == klass;
+    FunctionSignatureGenerator(W)
+      .set_is_virtual(is_declared)
+      .set_overridden(!is_declared)
+      .set_pure_virtual(klass->is_interface())
+      << VtableMethodDeclaration(method) << SemicolonAndNL{};
+  }
 }
 
 // type_size_approx tries to calculate the TypeData value size when interpreted as C++ type
@@ -954,7 +996,8 @@ void ClassDeclaration::compile_msgpack_declarations(CodeGenerator &W, ClassPtr k
 
   W << NL;
   W << "void msgpack_pack(vk::msgpack::packer<string_buffer> &packer) const noexcept;" << NL << NL;
-  W << "void msgpack_unpack(const vk::msgpack::object &msgpack_o);" << NL;
+  W << "void msgpack_unpack(const vk::msgpack::object &msgpack_o);" << NL << NL;
+  W << "void msgpack_unpack(vk::msgpack::direct_unpacker &unpacker, const vk::msgpack::object &header);" << NL;
 }
 
 void ClassDeclaration::compile_virtual_builtin_functions(CodeGenerator &W, ClassPtr klass) {
@@ -996,6 +1039,7 @@ IncludesCollector ClassDeclaration::compile_front_includes(CodeGenerator &W) con
   });
 
   includes.add_base_classes_include(klass);
+  add_vtable_methods_forward_declarations(includes, klass);
   if (!klass->json_encoders.empty()) {
     includes.add_raw_filename_include(JsonEncoderTags::all_tags_file_);
   }
@@ -1198,6 +1242,31 @@ void ClassMembersDefinition::compile_msgpack_deserialize(CodeGenerator &W, Class
     << END << NL
     << END << NL
     << END << NL;
+
+  //for (uint32_t i = unpacker.unpack_instance_fields_count(header); i > 0; --i) {
+  //  switch (unpacker.unpack<uint8_t>()) {
+  //    case tag_x: unpacker.unpack(x); break;
+  //    case tag_s: unpacker.unpack(s); break;
+  //    default   : unpacker.skip(); break;
+  //  }
+  //}
+  std::vector<std::string> direct_cases;
+  klass->members.for_each([&](ClassMemberInstanceField &field) {
+    if (field.serialization_tag != -1) {
+      direct_cases.emplace_back(fmt_format("case {}: unpacker.unpack(${}); break;", field.serialization_tag, field.var->name));
+    }
+  });
+
+  direct_cases.emplace_back("default: unpacker.skip(); break;");
+
+  W << NL
+    << "void " << klass->src_name << "::msgpack_unpack(vk::msgpack::direct_unpacker &unpacker, const vk::msgpack::object &header) " << BEGIN
+    << "for (uint32_t i = unpacker.unpack_instance_fields_count(header); i > 0; --i)" << BEGIN
+    << "switch (unpacker.unpack<uint8_t>()) " << BEGIN
+    << JoinValues(direct_cases, "", join_mode::multiple_lines) << NL
+    << END << NL
+    << END << NL
+    << END << NL;
 }
 
 StaticLibraryRunGlobal::StaticLibraryRunGlobal(gen_out_style style) :
@@ -37,6 +37,15 @@ struct FunctionDeclaration {
   void compile(CodeGenerator &W) const;
 };
 
+// a C++ virtual member, that dispatches a virtual method to an implementation, see FunctionData::is_dispatched_through_vtable();
+// klass is set for a definition outside of a class
+struct VtableMethodDeclaration {
+  FunctionPtr function;
+  ClassPtr klass;
+  explicit VtableMethodDeclaration(FunctionPtr function, ClassPtr klass = {});
+  void compile(CodeGenerator &W) const;
+};
+
 struct FunctionForkDeclaration {
   FunctionPtr function;
   bool in_header;
@@ -119,6 +128,7 @@ struct ClassDeclaration : CodeGenRootCmd {
   explicit ClassDeclaration(ClassPtr klass);
   void compile(CodeGenerator &W) const final;
   static void compile_inner_methods(CodeGenerator &W, ClassPtr klass);
+  static void add_vtable_methods_forward_declarations(IncludesCollector &includes, ClassPtr klass);
 
 private:
   static void compile_fields(CodeGenerator &W, ClassPtr klass);
@@ -130,6 +140,7 @@ private:
   static void compile_msgpack_declarations(CodeGenerator &W, ClassPtr klass);
   static void compile_virtual_builtin_functions(CodeGenerator &W, ClassPtr klass);
   static void compile_wakeup(CodeGenerator &W, ClassPtr klass);
+  static void compile_vtable_methods(CodeGenerator &W, ClassPtr klass);
 
   template<class ReturnValueT>
   static void compile_class_method(FunctionSignatureGenerator &&W, ClassPtr klass, vk::string_view method_signature, const ReturnValueT &return_value);
@@ -39,6 +39,11 @@ void FunctionH::compile(CodeGenerator &W) const {
   if (function->is_flatten) {
     W << " __attribute__((flatten))";
   }
+  if (G->get_profile_guided_data().is_hot(function)) {
+    W << " __attribute__((hot))";
+  } else if (G->get_profile_guided_data().is_cold(function)) {
+    W << " __attribute__((cold))";
+  }
   W << ";" << NL;
   if (function->is_resumable) {
     W << FunctionForkDeclaration(function, true) << ";" << NL;
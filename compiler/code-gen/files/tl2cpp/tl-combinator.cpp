@@ -100,18 +100,18 @@ void CombinatorStore::gen_arg_processing(CodeGenerator &W, const std::unique_ptr
     auto *as_type_var = arg->type_expr->as<vk::tlo_parsing::type_var>();
     kphp_assert(as_type_var);
     if (!typed_mode) {
-      W << "auto _cur_arg = "
+      W << "const mixed &_cur_arg = "
         << fmt_format("tl_arr_get(tl_object, {}, {}, {}L)", tl2cpp::register_tl_const_str(arg->name), arg->idx, tl2cpp::hash_tl_const_str(arg->name))
         << ";" << NL;
       W << "string target_f_name = "
         << fmt_format("tl_arr_get(_cur_arg, {}, 0, {}L).as_string()", tl2cpp::register_tl_const_str("_"), tl2cpp::hash_tl_const_str("_"))
         << ";" << NL;
-      W << "if (!tl_storers_ht.has_key(target_f_name)) " << BEGIN
+      W << "const tl_storer_ptr *storer_kv = tl_storers_ht.find_value(target_f_name);" << NL;
+      W << "if (!storer_kv) " << BEGIN
         << "CurrentProcessingQuery::get().raise_storing_error(\"Function %s not found in tl-scheme\", target_f_name.c_str());" << NL
         << "return {};" << NL
         << END << NL;
-      W << "const auto &storer_kv = tl_storers_ht.get_value(target_f_name);" << NL;
-      W << "tl_func_state->" << combinator->get_var_num_arg(as_type_var->var_num)->name << ".fetcher = storer_kv(_cur_arg);" << NL;
+      W << "tl_func_state->" << combinator->get_var_num_arg(as_type_var->var_num)->name << ".fetcher = (*storer_kv)(_cur_arg);" << NL;
     } else {
       W << "if (tl_object->$" << arg->name << ".is_null()) " << BEGIN
         << R"(CurrentProcessingQuery::get().raise_storing_error("Field \")" << arg->name << R"(\" not found in tl object");)" << NL
@@ -173,7 +173,21 @@ std::string CombinatorStore::get_value_absence_check_for_optional_arg(const std:
 
 void CombinatorFetch::gen_before_args_processing(CodeGenerator &W) const {
   if (!typed_mode) {
-    W << "array<mixed> result;" << NL;
+    // the number of fields is known at compile time, so the result is allocated once instead of growing on each set_value()
+    int fields_count = 0;
+    if (combinator->is_constructor()) {
+      for (const auto &arg : combinator->args) {
+        fields_count += !arg->is_optional();
+      }
+      // the constructor name, see TypeFetch
+      const auto *type = tl->get_type_by_magic(combinator->type_id);
+      fields_count += type->constructors_num > 1 && !(type->flags & vk::tlo_parsing::FLAG_NOCONS);
+    }
+    if (fields_count) {
+      W << "array<mixed> result{array_size(" << fields_count << ", false)};" << NL;
+    } else {
+      W << "array<mixed> result;" << NL;
+    }
   }
 };
 
@@ -56,14 +56,14 @@ struct CombinatorGen {
       f$store_int(0xee090e42);
       t_Int().store(tl_arr_get(tl_object, tl_str$offset, 2, -1913876069));
       t_Int().store(tl_arr_get(tl_object, tl_str$limit, 3, 492966325));
-      auto _cur_arg = tl_arr_get(tl_object, tl_str$query, 4, 1563700686);
+      const mixed &_cur_arg = tl_arr_get(tl_object, tl_str$query, 4, 1563700686);
       string target_f_name = tl_arr_get(_cur_arg, tl_str$_, 0, -2147483553).as_string();
-      if (!tl_storers_ht.has_key(target_f_name)) {
+      const tl_storer_ptr *storer_kv = tl_storers_ht.find_value(target_f_name);
+      if (!storer_kv) {
         CurrentProcessingQuery::get().raise_storing_error("Function %s not found in tl-scheme", target_f_name.c_str());
         return {};
       }
-      const auto &storer_kv = tl_storers_ht.get_value(target_f_name);
-      tl_func_state->X.fetcher = storer_kv(_cur_arg);
+      tl_func_state->X.fetcher = (*storer_kv)(_cur_arg);
       return std::move(tl_func_state);
     }
  * 3) Handling of the main part of the type expression in TypeExprStore/Fetch
@@ -85,7 +85,7 @@ private:
 /* The code that is common for combinators (func/constructor) fetch method generation.
  * 1) Field masks handling:
     array<mixed> c_hints_objectExt::fetch(int fields_mask) {
-      array<mixed> result;
+      array<mixed> result{array_size(4, false)};
       result.set_value(tl_str$type, t_Int().fetch(), -445613708);
       result.set_value(tl_str$object_id, t_Int().fetch(), 65801733);
       if (fields_mask & (1 << 0)) {
@@ -46,6 +46,10 @@ std::map<int, std::string> TypeTagger::collect_hash_of_types() const noexcept {
     "class_instance<C$VK$TL$RpcResponse>",
     "array< class_instance<C$VK$TL$RpcResponse> >",
     "class_instance<C$PDOStatement>",
+    "string",
+    "double",
+    "array< int64_t >",
+    "array< double >",
   };
 
   for (const auto *type : forkable_types_) {
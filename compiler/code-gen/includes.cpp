@@ -70,6 +70,18 @@ void IncludesCollector::add_function_body_depends(const FunctionPtr &function) {
     add_class_include(to_include);
   }
 
+  // C++ virtual members of classes are defined in a source file of a virtual method
+  if (function->is_dispatched_through_vtable()) {
+    for (auto klass : function->vtable_implementations) {
+      add_class_include(klass);
+    }
+    for (auto klass : function->vtable_abstract_classes) {
+      if (klass->does_need_codegen()) {
+        add_class_include(klass);
+      }
+    }
+  }
+
   for (auto local_var : function->local_var_ids) {
     add_var_signature_depends(local_var);
   }
@@ -111,6 +123,17 @@ void IncludesCollector::add_var_signature_forward_declarations(const VarPtr &var
   }
 }
 
+void IncludesCollector::add_function_signature_forward_declarations(const FunctionPtr &function) {
+  std::unordered_set<ClassPtr> all_classes;
+  function->tinf_node.get_type()->get_all_class_types_inside(all_classes);
+  for (const auto &param : function->param_ids) {
+    param->tinf_node.get_type()->get_all_class_types_inside(all_classes);
+  }
+  for (auto klass: all_classes) {
+    add_class_forward_declaration(klass);
+  }
+}
+
 void IncludesCollector::add_base_classes_include(const ClassPtr &klass) {
   classes_.insert(klass->implements.cbegin(), klass->implements.cend());
 
@@ -39,6 +39,7 @@ public:
 
   void add_class_forward_declaration(const ClassPtr &klass);
   void add_var_signature_forward_declarations(const VarPtr &var);
+  void add_function_signature_forward_declarations(const FunctionPtr &function);
 
   void add_class_include(const ClassPtr &klass);
   void add_base_classes_include(const ClassPtr &klass);
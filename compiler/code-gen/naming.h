@@ -194,6 +194,16 @@ struct FunctionForkName {
   }
 };
 
+// a C++ virtual member of classes, that dispatches a virtual method, see FunctionData::is_dispatched_through_vtable()
+struct VtableMethodName {
+  FunctionPtr function;
+  inline VtableMethodName(FunctionPtr function) : function(function) {}
+
+  void compile(CodeGenerator &W) const {
+    W << "vtable$" << function->name;
+  }
+};
+
 struct FunctionClassName {
   FunctionPtr function;
   explicit FunctionClassName(FunctionPtr function) :
@@ -7,6 +7,7 @@
 #include <iterator>
 #include <unordered_map>
 
+#include "common/algorithms/contains.h"
 #include "common/wrappers/field_getter.h"
 
 #include "common/wrappers/likely.h"
@@ -1422,6 +1423,67 @@ void compile_function_resumable(VertexAdaptor<op_function> func_root, CodeGenera
 
 }
 
+void compile_local_vars_declarations(FunctionPtr func, CodeGenerator &W) {
+  for (auto var : func->local_var_ids) {
+    if (var->type() != VarData::var_local_inplace_t && !var->is_foreach_reference) {
+      if (var->is_stack_instance) {
+        // declared before the variable to be destroyed after it
+        W << "class_instance_stack_storage<" << tinf::get_type(var)->class_type()->src_name << "> " << VarName(var) << "$storage;" << NL;
+      }
+      W << VarDeclaration(var);
+    }
+  }
+}
+
+// a virtual method of a big hierarchy calls a C++ virtual member instead of a dispatching switch:
+// f$I$$run(v$this, v$x) { ...; if (v$this.is_null()) { critical_error }; return v$this.get()->vtable$I$$run(v$x); }
+// C$A::vtable$I$$run(v$x) { const class_instance<C$A> v$this = this; ... a switch case of A ... }
+VertexAdaptor<op_switch> compile_vtable_dispatching(VertexAdaptor<op_function> func_root, CodeGenerator &W) {
+  FunctionPtr func = func_root->func_id;
+  VarName this_var{func->param_ids.front()};
+  VertexAdaptor<op_switch> dispatching_switch;
+
+  for (auto statement : *func_root->cmd()) {
+    if (!dispatching_switch && statement->type() == op_switch) {
+      dispatching_switch = statement.as<op_switch>();
+      auto default_case = dispatching_switch->cases().back().as<op_default>();
+      W << "if (" << this_var << ".is_null()) " << default_case->cmd() << NL;
+      W << "return " << this_var << ".get()->" << VtableMethodName(func) << "(";
+      for (size_t i = 1; i < func->param_ids.size(); ++i) {
+        W << (i > 1 ? ", " : "") << VarName(func->param_ids[i]);
+      }
+      W << ");" << NL;
+    } else if (vk::none_of_equal(statement->type(), op_var, op_empty)) {
+      W << statement << ";" << NL;
+    }
+  }
+  kphp_assert(dispatching_switch);
+  return dispatching_switch;
+}
+
+void compile_vtable_methods_definitions(FunctionPtr func, VertexAdaptor<op_switch> dispatching_switch, CodeGenerator &W) {
+  VarName this_var{func->param_ids.front()};
+  const auto &implementations = func->vtable_implementations;
+
+  auto cases = dispatching_switch->cases();
+  kphp_assert(cases.size() == implementations.size() + 1);
+  for (size_t i = 0; i < implementations.size(); ++i) {
+    const std::string instance_type = "class_instance<" + implementations[i]->src_name + ">";
+    W << NL << VtableMethodDeclaration(func, implementations[i]) << " " << BEGIN;
+    W << "const " << instance_type << " " << this_var << " = " << instance_type << "::create_from_this(this);" << NL;
+    compile_local_vars_declarations(func, W);
+    W << AsSeq{cases[i].as<op_case>()->cmd()} << END << NL;
+  }
+
+  for (ClassPtr klass : func->vtable_abstract_classes) {
+    if (klass->does_need_codegen()) {
+      W << NL << VtableMethodDeclaration(func, klass) << " " << BEGIN;
+      W << "php_critical_error(\"call of abstract method " << func->as_human_readable() << "\");" << NL;
+      W << END << NL;
+    }
+  }
+}
+
 void compile_function(VertexAdaptor<op_function> func_root, CodeGenerator &W) {
   FunctionPtr func = func_root->func_id;
 
@@ -1440,12 +1502,7 @@ void compile_function(VertexAdaptor<op_function> func_root, CodeGenerator &W) {
     TracingAutogen::codegen_runtime_func_guard_start(W, func);
   }
   compile_tracing_profiler(func, W);
-
-  for (auto var : func->local_var_ids) {
-    if (var->type() != VarData::var_local_inplace_t && !var->is_foreach_reference) {
-      W << VarDeclaration(var);
-    }
-  }
+  compile_local_vars_declarations(func, W);
 
   if (func->has_variadic_param) {
     auto params = func->get_params();
@@ -1457,6 +1514,12 @@ void compile_function(VertexAdaptor<op_function> func_root, CodeGenerator &W) {
     W << name_of_variadic_param << " = f$array_values(" << name_of_variadic_param << ");" << NL;
     W << END << NL;
   }
+  if (func->is_dispatched_through_vtable()) {
+    auto dispatching_switch = compile_vtable_dispatching(func_root, W);
+    W << END << NL;
+    compile_vtable_methods_definitions(func, dispatching_switch, W);
+    return;
+  }
   W << AsSeq{func_root->cmd()} << END << NL;
 }
 
@@ -2132,7 +2195,11 @@ void compile_common_op(VertexPtr root, CodeGenerator &W) {
       W << "Optional<bool>{}";
       break;
     case op_var:
-      W << VarName(root.as<op_var>()->var_id);
+      if (root.as<op_var>()->is_last_use) {
+        W << "std::move(" << VarName(root.as<op_var>()->var_id) << ")";
+      } else {
+        W << VarName(root.as<op_var>()->var_id);
+      }
       break;
     case op_string:
       compile_string(root.as<op_string>(), W);
@@ -2266,6 +2333,10 @@ void compile_common_op(VertexPtr root, CodeGenerator &W) {
     case op_alloc: {
       const TypeData *tp = tinf::get_type(root);
       kphp_assert(tp->ptype() == tp_Class);
+      if (auto stack_var = root.as<op_alloc>()->stack_var) {
+        W << TypeName(tp) << "().alloc_in(" << VarName(stack_var) << "$storage)";
+        break;
+      }
       const auto *alloc_function = tp->class_type()->is_empty_class() ? "().empty_alloc()" : "().alloc()";
       W << TypeName(tp) << alloc_function;
       break;
@@ -346,7 +346,7 @@ bool CompilerCore::register_class(ClassPtr cur_class) {
 }
 
 LibPtr CompilerCore::register_lib(LibPtr lib) {
-  TSHashTable<LibPtr, 1000>::HTNode *node = libs_ht.at(vk::std_hash(lib->lib_namespace()));
+  TSHashTable<LibPtr>::HTNode *node = libs_ht.at(vk::std_hash(lib->lib_namespace()));
   AutoLocker<Lockable *> locker(node);
   if (!node->data) {
     node->data = lib;
@@ -355,7 +355,7 @@ LibPtr CompilerCore::register_lib(LibPtr lib) {
 }
 
 ModulitePtr CompilerCore::register_modulite(ModulitePtr modulite) {
-  TSHashTable<ModulitePtr, 1000>::HTNode *node = modulites_ht.at(vk::std_hash(modulite->modulite_name));
+  TSHashTable<ModulitePtr>::HTNode *node = modulites_ht.at(vk::std_hash(modulite->modulite_name));
   AutoLocker<Lockable *> locker(node);
   kphp_error(!node->data, fmt_format("Redeclaration of modulite {}, declared in:\n- {}\n- {}", modulite->modulite_name, modulite->yaml_file->relative_file_name, node->data->yaml_file->relative_file_name));
   node->data = modulite;
@@ -368,7 +368,7 @@ ModulitePtr CompilerCore::get_modulite(vk::string_view name) {
 }
 
 ComposerJsonPtr CompilerCore::register_composer_json(ComposerJsonPtr composer_json) {
-  TSHashTable<ComposerJsonPtr, 1000>::HTNode *node = composer_json_ht.at(vk::std_hash(composer_json->package_name));
+  TSHashTable<ComposerJsonPtr>::HTNode *node = composer_json_ht.at(vk::std_hash(composer_json->package_name));
   AutoLocker<Lockable *> locker(node);
   kphp_error(!node->data, fmt_format("Redeclaration of composer package {}, declared in:\n- {}\n- {}", composer_json->package_name, composer_json->json_file->relative_file_name, node->data->json_file->relative_file_name));
   node->data = composer_json;
@@ -621,6 +621,12 @@ void CompilerCore::try_load_tl_classes() {
   }
 }
 
+void CompilerCore::try_load_profile_guided_data() {
+  if (!settings().profile_guided_data.get().empty()) {
+    profile_guided_data.load_from(settings().profile_guided_data.get());
+  }
+}
+
 void CompilerCore::init_composer_class_loader() {
   if (!settings().is_composer_enabled()) {
     return;
@@ -18,6 +18,7 @@
 #include "compiler/data/ffi-data.h"
 #include "compiler/compiler-settings.h"
 #include "compiler/index.h"
+#include "compiler/profile-guided-data.h"
 #include "compiler/stats.h"
 #include "compiler/threading/data-stream.h"
 #include "compiler/threading/hash-table.h"
@@ -33,16 +34,17 @@ private:
   TSHashTable<FunctionPtr> functions_ht;
   TSHashTable<ClassPtr> classes_ht;
   TSHashTable<DefinePtr> defines_ht;
-  TSHashTable<VarPtr,2'000'000> global_vars_ht;
-  TSHashTable<LibPtr, 1000> libs_ht;
-  TSHashTable<ModulitePtr, 1000> modulites_ht;
-  TSHashTable<ComposerJsonPtr, 1000> composer_json_ht;
+  TSHashTable<VarPtr> global_vars_ht;
+  TSHashTable<LibPtr> libs_ht;
+  TSHashTable<ModulitePtr> modulites_ht;
+  TSHashTable<ComposerJsonPtr> composer_json_ht;
   SrcFilePtr main_file;
   CompilerSettings *settings_;
   ComposerAutoloader composer_class_loader;
   FFIRoot ffi;
   ClassPtr memcache_class;
   TlClasses tl_classes;
+  ProfileGuidedData profile_guided_data;
   std::vector<std::string> kphp_runtime_opts;
   bool is_untyped_rpc_tl_used{false};
   bool is_functions_txt_parsed{false};
@@ -127,6 +129,9 @@ public:
   void init_composer_class_loader();
   const TlClasses &get_tl_classes() const { return tl_classes; }
 
+  void try_load_profile_guided_data();
+  const ProfileGuidedData &get_profile_guided_data() const { return profile_guided_data; }
+
   void add_kphp_runtime_opt(std::string opt) { kphp_runtime_opts.emplace_back(std::move(opt)); }
   const std::vector<std::string> &get_kphp_runtime_opts() const { return kphp_runtime_opts; }
 
@@ -268,6 +268,13 @@ void CompilerSettings::init() {
     throw std::runtime_error{"globals-split-count may not be equal to zero"};
   }
 
+  if (!cxx_profile_generate_dir.get().empty() && !cxx_profile_use_dir.get().empty()) {
+    throw std::runtime_error{"Options " + cxx_profile_generate_dir.get_env_var() + " and " + cxx_profile_use_dir.get_env_var() + " are mutually exclusive"};
+  }
+  option_as_dir(cxx_profile_generate_dir);
+  option_as_dir(cxx_profile_use_dir);
+  option_as_dir(object_cache_dir);
+
   for (std::string &include : includes.value_) {
     include = as_dir(include);
   }
@@ -305,6 +312,14 @@ void CompilerSettings::init() {
   if (vk::contains(cxx.get(), "clang")) {
     ss << " -Wno-invalid-source-encoding";
   }
+  if (!cxx_profile_generate_dir.get().empty()) {
+    ss << " -fprofile-generate=" << cxx_profile_generate_dir.get();
+  }
+  if (!cxx_profile_use_dir.get().empty()) {
+    ss << " -fprofile-use=" << cxx_profile_use_dir.get();
+    // not every function is run while collecting a profile, and the code may change since then
+    ss << (vk::contains(cxx.get(), "clang") ? " -Wno-profile-instr-unprofiled -Wno-profile-instr-out-of-date" : " -Wno-missing-profile");
+  }
   #if __cplusplus <= 201703L
     ss << " -std=c++17";
   #elif __cplusplus <= 202002L
@@ -321,6 +336,9 @@ void CompilerSettings::init() {
   remove_extra_spaces(extra_ld_flags.value_);
 
   ld_flags.value_ = extra_ld_flags.get();
+  if (!cxx_profile_generate_dir.get().empty()) {
+    ld_flags.value_ += " -fprofile-generate=" + cxx_profile_generate_dir.get();
+  }
   append_curl(cxx_default_flags, ld_flags.value_);
   append_apple_options(cxx_default_flags, ld_flags.value_);
   std::vector<vk::string_view> external_static_libs{"pcre", "re2", "yaml-cpp", "h3", "z", "zstd", "nghttp2", "kphp-timelib"};
@@ -154,8 +154,12 @@ public:
   KphpOption<std::string> extra_cxx_debug_level;
   KphpOption<std::string> archive_creator;
   KphpOption<bool> dynamic_incremental_linkage;
+  KphpOption<std::string> object_cache_dir;
 
   KphpOption<uint64_t> profiler_level;
+  KphpOption<std::string> profile_guided_data;
+  KphpOption<std::string> cxx_profile_generate_dir;
+  KphpOption<std::string> cxx_profile_use_dir;
   KphpOption<bool> enable_global_vars_memory_stats;
   KphpOption<bool> enable_full_performance_analyze;
   KphpOption<bool> print_resumable_graph;
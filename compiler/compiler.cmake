@@ -29,6 +29,7 @@ prepend(KPHP_COMPILER_MAKE_SOURCES make/
         hardlink-or-copy.cpp
         make-runner.cpp
         make.cpp
+        object-cache.cpp
         target.cpp)
 
 prepend(KPHP_COMPILER_DATA_SOURCES data/
@@ -110,7 +111,9 @@ prepend(KPHP_COMPILER_PIPES_SOURCES pipes/
         calc-const-types.cpp
         calc-empty-functions.cpp
         calc-func-dep.cpp
+        calc-last-uses.cpp
         calc-locations.cpp
+        calc-non-escaping-instances.cpp
         calc-real-defines-values.cpp
         calc-rl.cpp
         calc-val-ref.cpp
@@ -206,6 +209,7 @@ prepend(KPHP_COMPILER_SOURCES ${KPHP_COMPILER_DIR}/
         name-gen.cpp
         operation.cpp
         phpdoc.cpp
+        profile-guided-data.cpp
         stage.cpp
         stats.cpp
         type-hint.cpp
@@ -31,7 +31,9 @@
 #include "compiler/pipes/calc-bad-vars.h"
 #include "compiler/pipes/calc-const-types.h"
 #include "compiler/pipes/calc-empty-functions.h"
+#include "compiler/pipes/calc-last-uses.h"
 #include "compiler/pipes/calc-locations.h"
+#include "compiler/pipes/calc-non-escaping-instances.h"
 #include "compiler/pipes/calc-real-defines-values.h"
 #include "compiler/pipes/calc-rl.h"
 #include "compiler/pipes/calc-val-ref.h"
@@ -223,6 +225,7 @@ bool compiler_execute(CompilerSettings *settings) {
   }
 
   G->try_load_tl_classes();
+  G->try_load_profile_guided_data();
   stage::set_name("Load Composer packages");
   G->init_composer_class_loader();
   stage::die_if_global_errors();
@@ -286,6 +289,7 @@ bool compiler_execute(CompilerSettings *settings) {
     >> PassC<OptimizationPass>{}
     >> PassC<FixReturnsPass>{}
     >> PassC<CalcValRefPass>{}
+    >> PassC<CollectThisUsagesPass>{}
     >> PassC<CalcFuncDepPass>{}
     >> SyncC<CalcBadVarsF>{}
     >> PipeC<CheckUBF>{}
@@ -293,11 +297,13 @@ bool compiler_execute(CompilerSettings *settings) {
     >> PassC<ExtractAsyncPass>{}
     >> PassC<CheckNestedForeachPass>{}
     >> PassC<InlineSimpleFunctions>{}
+    >> PassC<CalcNonEscapingInstancesPass>{}
     >> PassC<CommonAnalyzerPass>{}
     >> PassC<CheckTlClasses>{}
     >> PassC<CheckAccessModifiersPass>{}
     >> PassC<AnalyzePerformance>{}
     >> PassC<FinalCheckPass>{}
+    >> PassC<CalcLastUsesPass>{}
     >> PassC<CollectForkableTypesPass>{}
     >> SyncC<CodeGenF>{}              // create all codegen commands and launch them in "just calc hashes" mode
     >> PipeC<CodeGenForDiffF>{}       // re-launch codegen commands that diff from the previous kphp launch
@@ -59,6 +59,8 @@ public:
   std::vector<InterfacePtr> implements;
   std::vector<ClassPtr> derived_classes;
   FunctionPtr construct_function;
+  // virtual methods dispatched through C++ vtables, that are declared or overridden in this class
+  std::vector<FunctionPtr> vtable_methods;
 
   const PhpDocComment *phpdoc{nullptr};
   const kphp_json::KphpJsonTagList *kphp_json_tags{nullptr};
@@ -50,6 +50,10 @@ bool FunctionData::is_constructor() const {
   return class_id && class_id->construct_function && class_id->construct_function == get_self();
 }
 
+bool FunctionData::is_const_param(VarPtr param) const {
+  return param->marked_as_const || (!has_variadic_param && param->is_read_only);
+}
+
 void FunctionData::update_location_in_body() {
   if (!root) return;
 
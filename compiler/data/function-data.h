@@ -70,6 +70,19 @@ public:
   // use($var1, &$var2) for lambdas, implicit vars for arrow lambdas; auto-captured $this is also here, the first one
   std::forward_list<VertexAdaptor<op_var>> uses_list;
 
+  // for instance methods: how $this is used inside, see CollectThisUsagesPass;
+  // when $this is only used to access fields, to be returned and to call other methods (method, is_result_used),
+  // an instance may be allocated on stack by CalcNonEscapingInstancesPass
+  bool this_escapes = true;
+  bool returns_this = false;
+  std::vector<std::pair<FunctionPtr, bool>> methods_called_on_this;
+
+  // for virtual methods of big hierarchies: classes having a C++ virtual member, that calls their implementation,
+  // in the order of cases of the dispatching switch, see generate-virtual-methods.cpp;
+  // abstract classes of a hierarchy override it with an unreachable stub to stay complete C++ types
+  std::vector<ClassPtr> vtable_implementations;
+  std::vector<ClassPtr> vtable_abstract_classes;
+
   // @kphp-throws checks that a function throws only specified exceptions;
   // empty vector means "nothing to check", it's not "throws nothing",
   // to check that a function does not throw, should_not_throw flag is used
@@ -186,6 +199,14 @@ public:
     return modifiers.is_instance();
   }
 
+  // such params (if not references) are declared in C++ as `const T &`, others are passed by value
+  bool is_const_param(VarPtr param) const;
+
+  // a virtual method is dispatched through C++ virtual members (named VtableMethodName) instead of a switch on a class hash
+  bool is_dispatched_through_vtable() const {
+    return !vtable_implementations.empty() && !is_resumable && !is_inline;
+  }
+
   bool is_extern() const {
     return type == func_extern;
   }
@@ -44,6 +44,7 @@ public:
   bool marked_as_const = false;
   bool is_read_only = true;
   bool is_foreach_reference = false;
+  bool is_stack_instance = false;   // a local instance that never escapes the function, see CalcNonEscapingInstancesPass
   int dependency_level = 0;
 
   void set_uninited_flag(bool f);
@@ -273,8 +273,16 @@ int main(int argc, char *argv[]) {
              "archive-creator", "KPHP_ARCHIVE_CREATOR", "ar");
   parser.add("Use dynamic incremental linkage for building the output binary", settings->dynamic_incremental_linkage,
              "dynamic-incremental-linkage", "KPHP_DYNAMIC_INCREMENTAL_LINKAGE");
+  parser.add("Shared directory for object files, they are reused by other builds with the same sources and C++ flags", settings->object_cache_dir,
+             "object-cache-dir", "KPHP_OBJECT_CACHE_DIR");
   parser.add("Profile functions: 0 - disabled, 1 - enabled for marked functions, 2 - enabled for all", settings->profiler_level,
              'g', "profiler", "KPHP_PROFILER", "0", {"0", "1", "2"});
+  parser.add("A profile written by the runtime profiler (callgrind file) to guide inlining, hot/cold functions and virtual dispatching", settings->profile_guided_data,
+             "profile-guided-data", "KPHP_PROFILE_GUIDED_DATA");
+  parser.add("Build the output binary with C++ compiler instrumentation, it writes profiles to the specified dir", settings->cxx_profile_generate_dir,
+             "cxx-profile-generate", "KPHP_CXX_PROFILE_GENERATE");
+  parser.add("Build the output binary using C++ compiler profiles from the specified dir (for clang, merged into default.profdata)", settings->cxx_profile_use_dir,
+             "cxx-profile-use", "KPHP_CXX_PROFILE_USE");
   parser.add("Enable an ability to get global vars memory stats", settings->enable_global_vars_memory_stats,
              "enable-global-vars-memory-stats", "KPHP_ENABLE_GLOBAL_VARS_MEMORY_STATS");
   parser.add("Enable all inspections available for @kphp-analyze-performance for all reachable functions", settings->enable_full_performance_analyze,
@@ -9,10 +9,19 @@
 #include "common/algorithms/contains.h"
 
 #include "compiler/compiler-settings.h"
+#include "compiler/make/object-cache.h"
 #include "compiler/make/target.h"
 
 class Cpp2ObjTarget : public Target {
+  ObjectCache *object_cache{nullptr};
+  std::string object_cache_key;
+
 public:
+  void set_object_cache(ObjectCache *cache, std::string key) {
+    object_cache = cache;
+    object_cache_key = std::move(key);
+  }
+
   std::string get_cmd() final {
     std::stringstream ss;
     const auto cpp_list = dep_list();
@@ -34,6 +43,16 @@ public:
     return ss.str();
   }
 
+  bool after_run_success() final {
+    if (!Target::after_run_success()) {
+      return false;
+    }
+    if (object_cache) {
+      object_cache->store(object_cache_key, *get_file());
+    }
+    return true;
+  }
+
   void compute_priority() final {
     priority = 0;
     for (auto *dep : deps) {
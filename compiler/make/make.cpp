@@ -20,6 +20,7 @@
 #include "compiler/make/h-to-pch-target.h"
 #include "compiler/make/hardlink-or-copy.h"
 #include "compiler/make/make-runner.h"
+#include "compiler/make/object-cache.h"
 #include "compiler/make/objs-to-bin-target.h"
 #include "compiler/make/objs-to-obj-target.h"
 #include "compiler/make/objs-to-static-lib-target.h"
@@ -312,14 +313,19 @@ static std::unordered_map<File *, long long> create_dep_mtime(const Index &cpp_d
 }
 
 static std::vector<File *> create_obj_files(MakeSetup *make, Index &obj_dir, const Index &cpp_dir,
-                                            const std::forward_list<Index> &imported_headers) {
+                                            const std::forward_list<Index> &imported_headers, ObjectCache &object_cache) {
   std::unordered_map<File *, long long> dep_mtime = create_dep_mtime(cpp_dir, imported_headers);
   std::vector<File *> objs;
   for (const auto &cpp_file : cpp_dir.get_files()) {
     if (cpp_file->ext == ".cpp") {
       File *obj_file = obj_dir.insert_file(static_cast<std::string>(cpp_file->name_without_ext) + ".o");
       obj_file->compile_with_debug_info_flag = cpp_file->compile_with_debug_info_flag;
-      make->create_cpp2obj_target(cpp_file, obj_file);
+      std::string object_cache_key = object_cache.calc_key(cpp_file);
+      if (!(obj_file->on_disk && obj_file->mtime >= dep_mtime[cpp_file])) {
+        object_cache.fetch(object_cache_key, obj_file);
+      }
+      auto *obj_target = static_cast<Cpp2ObjTarget *>(make->create_cpp2obj_target(cpp_file, obj_file));
+      obj_target->set_object_cache(&object_cache, std::move(object_cache_key));
       Target *cpp_target = cpp_file->target;
       cpp_target->force_changed(dep_mtime[cpp_file]);
       objs.push_back(obj_file);
@@ -360,21 +366,21 @@ static std::vector<File *> create_obj_files(MakeSetup *make, Index &obj_dir, con
 }
 
 static std::vector<File *> kphp_make_target(Index &obj_dir, const Index &cpp_dir,
-                      const std::forward_list<Index> &imported_headers, MakeSetup &make) {
+                      const std::forward_list<Index> &imported_headers, MakeSetup &make, ObjectCache &object_cache) {
   std::vector<File *> lib_objs;
   auto imported_libs = collect_imported_libs();
   for (File *link_file: imported_libs) {
     make.create_cpp_target(link_file);
     lib_objs.emplace_back(link_file);
   }
-  std::vector<File *> objs = create_obj_files(&make, obj_dir, cpp_dir, imported_headers);
+  std::vector<File *> objs = create_obj_files(&make, obj_dir, cpp_dir, imported_headers, object_cache);
   std::copy(lib_objs.begin(), lib_objs.end(), std::back_inserter(objs));
   return objs;
 }
 
 static std::vector<File *> kphp_make_static_lib_target(Index &obj_dir, const Index &cpp_dir,
-                                 const std::forward_list<Index> &imported_headers, MakeSetup &make) {
-  return create_obj_files(&make, obj_dir, cpp_dir, imported_headers);
+                                 const std::forward_list<Index> &imported_headers, MakeSetup &make, ObjectCache &object_cache) {
+  return create_obj_files(&make, obj_dir, cpp_dir, imported_headers, object_cache);
 }
 
 static std::forward_list<Index> collect_imported_headers() {
@@ -388,7 +394,8 @@ static std::forward_list<Index> collect_imported_headers() {
   return imported_headers;
 }
 
-static std::vector<File *> run_pre_make(const CompilerSettings &settings, FILE *make_stats_file, MakeSetup &make, Index &obj_index, File &bin_file) {
+static std::vector<File *> run_pre_make(const CompilerSettings &settings, FILE *make_stats_file, MakeSetup &make, Index &obj_index, File &bin_file,
+                                        ObjectCache &object_cache) {
   AutoProfiler profiler{get_profiler("Prepare Targets For Build")};
 
   G->del_extra_files();
@@ -405,8 +412,8 @@ static std::vector<File *> run_pre_make(const CompilerSettings &settings, FILE *
   }
 
   auto lib_header_dirs = collect_imported_headers();
-  return settings.is_static_lib_mode() ? kphp_make_static_lib_target(obj_index, G->get_index(), lib_header_dirs, make)
-                                       : kphp_make_target(obj_index, G->get_index(), lib_header_dirs, make);
+  return settings.is_static_lib_mode() ? kphp_make_static_lib_target(obj_index, G->get_index(), lib_header_dirs, make, object_cache)
+                                       : kphp_make_target(obj_index, G->get_index(), lib_header_dirs, make, object_cache);
 }
 
 void run_make() {
@@ -425,7 +432,8 @@ void run_make() {
   kphp_assert(bin_file.read_stat() >= 0);
 
   MakeSetup make{make_stats_file, settings};
-  auto objs = run_pre_make(settings, make_stats_file, make, obj_index, bin_file);
+  ObjectCache object_cache{settings, G->get_index()};
+  auto objs = run_pre_make(settings, make_stats_file, make, obj_index, bin_file, object_cache);
   stage::die_if_global_errors();
 
   if (settings.is_static_lib_mode()) {
@@ -447,6 +455,7 @@ void run_make() {
   kphp_error(ok, build_stage + " stage failure");
 
   if (make_stats_file) {
+    object_cache.write_stats(make_stats_file);
     fclose(make_stats_file);
   }
   stage::die_if_global_errors();
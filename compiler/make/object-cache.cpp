@@ -0,0 +1,148 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/make/object-cache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <openssl/sha.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "common/macos-ports.h"
+#include "common/wrappers/fmt_format.h"
+#include "common/wrappers/mkdir_recursive.h"
+
+#include "compiler/compiler-settings.h"
+
+namespace {
+
+// copies via a tmp file and rename(), as other builds may read the destination at the same time
+bool copy_file_atomically(const std::string &from, const std::string &to) noexcept {
+  struct stat file_stat;
+  if (stat(from.c_str(), &file_stat) != 0) {
+    return false;
+  }
+  std::string tmp_file = to + ".XXXXXX";
+  const int tmp_fd = mkstemp(&tmp_file[0]);
+  if (tmp_fd == -1) {
+    return false;
+  }
+  const int from_fd = open(from.c_str(), O_RDONLY);
+  const ssize_t copied = from_fd == -1 ? -1 : sendfile(tmp_fd, from_fd, nullptr, file_stat.st_size);
+  if (from_fd != -1) {
+    close(from_fd);
+  }
+  const bool ok = fchmod(tmp_fd, 0644) == 0 && copied == file_stat.st_size;
+  close(tmp_fd);
+  if (!ok || rename(tmp_file.c_str(), to.c_str()) != 0) {
+    unlink(tmp_file.c_str());
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+ObjectCache::ObjectCache(const CompilerSettings &settings, const Index &cpp_dir) :
+  settings_(settings),
+  cpp_dir_(cpp_dir),
+  dir_(settings.object_cache_dir.get()) {
+  // objects built with -fprofile-use depend on profiles contents, which are not a part of the key
+  if (!settings.cxx_profile_use_dir.get().empty()) {
+    dir_.clear();
+  }
+}
+
+void ObjectCache::collect_included_files(File *file, std::unordered_set<File *> &visited) const {
+  if (!visited.emplace(file).second) {
+    return;
+  }
+  for (const auto &include : file->includes) {
+    if (File *header = cpp_dir_.get_file(include)) {
+      collect_included_files(header, visited);
+    }
+  }
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+std::string ObjectCache::calc_key(File *cpp_file) {
+  // headers of static libs are not generated in this build, their hashes are unknown
+  if (!enabled() || !cpp_file->lib_includes.empty()) {
+    return {};
+  }
+
+  std::unordered_set<File *> included_files;
+  collect_included_files(cpp_file, included_files);
+  std::vector<File *> sorted_files{included_files.begin(), included_files.end()};
+  std::sort(sorted_files.begin(), sorted_files.end(), [](File *lhs, File *rhs) { return lhs->name < rhs->name; });
+
+  const auto &cxx_flags = cpp_file->compile_with_debug_info_flag ? settings_.cxx_flags_with_debug : settings_.cxx_flags_default;
+  SHA256_CTX sha256;
+  SHA256_Init(&sha256);
+  SHA256_Update(&sha256, cxx_flags.flags_sha256.get().data(), cxx_flags.flags_sha256.get().size());
+  SHA256_Update(&sha256, settings_.runtime_sha256.get().data(), settings_.runtime_sha256.get().size());
+  for (File *file : sorted_files) {
+    // comments contain php lines, they change lines of debug info
+    if (file->crc64 == static_cast<unsigned long long>(-1) || file->crc64_with_comments == static_cast<unsigned long long>(-1)) {
+      return {};
+    }
+    SHA256_Update(&sha256, file->name.data(), file->name.size() + 1);
+    SHA256_Update(&sha256, &file->crc64, sizeof(file->crc64));
+    SHA256_Update(&sha256, &file->crc64_with_comments, sizeof(file->crc64_with_comments));
+  }
+
+  unsigned char hash[SHA256_DIGEST_LENGTH] = {0};
+  SHA256_Final(hash, &sha256);
+
+  std::string key;
+  key.reserve(SHA256_DIGEST_LENGTH * 2);
+  for (auto hash_symb : hash) {
+    fmt_format_to(std::back_inserter(key), "{:02x}", hash_symb);
+  }
+  return key;
+}
+
+#pragma GCC diagnostic pop
+
+std::string ObjectCache::get_path(const std::string &key) const {
+  // a subdir by the first byte not to have too many files in one dir
+  return dir_ + key.substr(0, 2) + "/" + key.substr(2) + ".o";
+}
+
+bool ObjectCache::fetch(const std::string &key, File *obj_file) {
+  if (key.empty()) {
+    return false;
+  }
+  // the cached file is copied, not hard linked: the C++ compiler may rewrite an object file in place later
+  if (access(get_path(key).c_str(), R_OK) != 0 || !copy_file_atomically(get_path(key), obj_file->path)) {
+    ++misses_;
+    return false;
+  }
+  ++hits_;
+  obj_file->on_disk = true;
+  return obj_file->read_stat() > 0;
+}
+
+void ObjectCache::store(const std::string &key, const File &obj_file) {
+  if (key.empty()) {
+    return;
+  }
+  const std::string path = get_path(key);
+  // the cache is an optimization, failures to write into it are ignored
+  if (mkdir_recursive(path.substr(0, path.rfind('/')).c_str(), 0777) && copy_file_atomically(obj_file.path, path)) {
+    ++stored_;
+  }
+}
+
+void ObjectCache::write_stats(FILE *stats_file) const {
+  if (enabled()) {
+    fmt_fprintf(stats_file, "object cache: {} hits, {} misses, {} stored\n", hits_, misses_, stored_);
+  }
+}
@@ -0,0 +1,47 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <string>
+#include <unordered_set>
+
+#include "common/mixin/not_copyable.h"
+
+#include "compiler/index.h"
+
+class CompilerSettings;
+
+// A content-addressed cache of object files in a directory shared between builds (checkouts, branches, build hosts).
+// An object file is stored by a key, that is a hash of:
+//  * hashes of a generated .cpp file and all headers included into it (they are known after codegen, no preprocessing is needed);
+//  * C++ compiler and its flags, runtime sha256.
+// Index hashes of generated files are compared only within one destination dir, whereas this cache works across them.
+class ObjectCache : private vk::not_copyable {
+public:
+  ObjectCache(const CompilerSettings &settings, const Index &cpp_dir);
+
+  bool enabled() const { return !dir_.empty(); }
+
+  // an empty key means the file can't be cached, e.g. a hash of some header is unknown
+  std::string calc_key(File *cpp_file);
+
+  // places a cached object file instead of compiling it, returns false on a miss
+  bool fetch(const std::string &key, File *obj_file);
+  void store(const std::string &key, const File &obj_file);
+
+  void write_stats(FILE *stats_file) const;
+
+private:
+  std::string get_path(const std::string &key) const;
+  void collect_included_files(File *file, std::unordered_set<File *> &visited) const;
+
+  const CompilerSettings &settings_;
+  const Index &cpp_dir_;
+  std::string dir_;
+
+  int hits_{0};
+  int misses_{0};
+  int stored_{0};
+};
@@ -0,0 +1,111 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/pipes/calc-last-uses.h"
+
+#include "common/algorithms/contains.h"
+#include "common/algorithms/find.h"
+
+#include "compiler/compiler-core.h"
+#include "compiler/data/var-data.h"
+#include "compiler/inferring/public.h"
+
+namespace {
+
+bool is_refcounted_var(FunctionPtr function, VarPtr var) {
+  if (var->is_reference || var->is_foreach_reference || !vk::any_of_equal(tinf::get_type(var)->ptype(), tp_string, tp_array, tp_mixed)) {
+    return false;
+  }
+  if (var->type() == VarData::var_param_t) {
+    // const & params can't be moved from
+    return !function->is_const_param(var);
+  }
+  return var->type() == VarData::var_local_t;
+}
+
+bool is_loop(VertexPtr vertex) {
+  return vk::any_of_equal(vertex->type(), op_for, op_while, op_do, op_foreach);
+}
+
+} // namespace
+
+bool CalcLastUsesPass::check_function(FunctionPtr function) const {
+  return !function->is_extern();
+}
+
+VarPtr CalcLastUsesPass::get_move_destination(VertexAdaptor<op_var> var) const {
+  if (var->ref_flag || var->val_ref_flag != val_none || seq_rval_depth_ || loops_depth_ || stack_.empty()) {
+    return {};
+  }
+  VertexPtr parent = stack_.back();
+  if (auto set = parent.try_as<op_set>()) {
+    auto lhs = set->lhs().try_as<op_var>();
+    return set->rhs() == var && lhs && lhs->extra_type != op_ex_var_superlocal_inplace ? lhs->var_id : VarPtr{};
+  }
+  if (auto call = parent.try_as<op_func_call>()) {
+    FunctionPtr callee = call->func_id;
+    if (call->extra_type == op_ex_internal_func || !callee || callee->is_extern() || callee->cpp_variadic_call) {
+      return {};
+    }
+    auto params = callee->get_params();
+    auto args = call->args();
+    for (int i = 0; i < static_cast<int>(args.size()) && i < static_cast<int>(params.size()); ++i) {
+      if (args[i] == var) {
+        auto param = params[i].as<op_func_param>()->var();
+        return !param->ref_flag && !callee->is_const_param(param->var_id) ? param->var_id : VarPtr{};
+      }
+    }
+  }
+  return {};
+}
+
+VertexPtr CalcLastUsesPass::on_enter_vertex(VertexPtr vertex) {
+  if (!stack_.empty() && stack_.back()->type() == op_seq) {
+    statements_.emplace_back(vertex);
+  }
+  if (auto var = vertex.try_as<op_var>()) {
+    if (var->var_id && is_refcounted_var(current_function, var->var_id)) {
+      if (!visited_vars_.emplace(vertex).second) {
+        shared_vars_.emplace(var->var_id);
+      }
+      VertexPtr statement = statements_.empty() ? VertexPtr{} : statements_.back();
+      LastUse &last_use = last_uses_[var->var_id];
+      last_use.uses_in_statement = last_use.statement == statement && last_use.var ? last_use.uses_in_statement + 1 : 1;
+      last_use.var = var;
+      last_use.statement = statement;
+      last_use.moved_to = get_move_destination(var);
+    }
+  }
+  loops_depth_ += is_loop(vertex);
+  seq_rval_depth_ += vertex->type() == op_seq_rval;
+  stack_.emplace_back(vertex);
+  return vertex;
+}
+
+VertexPtr CalcLastUsesPass::on_exit_vertex(VertexPtr vertex) {
+  stack_.pop_back();
+  loops_depth_ -= is_loop(vertex);
+  seq_rval_depth_ -= vertex->type() == op_seq_rval;
+  if (!statements_.empty() && statements_.back() == vertex) {
+    statements_.pop_back();
+  }
+  return vertex;
+}
+
+void CalcLastUsesPass::on_finish() {
+  for (const auto &var_and_last_use : last_uses_) {
+    const LastUse &last_use = var_and_last_use.second;
+    if (!last_use.moved_to || last_use.uses_in_statement != 1 || vk::contains(shared_vars_, var_and_last_use.first)) {
+      continue;
+    }
+    // with different types a conversion is called, it doesn't take an rvalue in general
+    if (type_out(tinf::get_type(var_and_last_use.first)) != type_out(tinf::get_type(last_use.moved_to))) {
+      continue;
+    }
+    auto var = last_use.var;
+    var->is_last_use = true;
+    // each move saves an increment of a refcounter on copying and a decrement on destroying the variable
+    G->stats.cnt_removed_refcount_ops += 2;
+  }
+}
@@ -0,0 +1,51 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "compiler/function-pass.h"
+
+// Finds the last uses of local string/array/mixed variables, which are passed by value:
+//   $s = str_repeat('a', 100);
+//   $s .= 'b';
+//   return process($s);    // f$process(std::move(v$s)), if process() modifies its param
+// A moved variable is not copied, so its refcounter is neither incremented nor decremented, and copy-on-write
+// separation isn't triggered in a callee if the variable was the only owner.
+// Only occurrences outside of loops are moved, and only if a variable occurs once in a statement,
+// as the order of evaluation of C++ function arguments is unspecified.
+class CalcLastUsesPass final : public FunctionPassBase {
+public:
+  std::string get_description() final {
+    return "Calc last uses";
+  }
+
+  bool check_function(FunctionPtr function) const final;
+
+  VertexPtr on_enter_vertex(VertexPtr vertex) final;
+  VertexPtr on_exit_vertex(VertexPtr vertex) final;
+  void on_finish() final;
+
+private:
+  struct LastUse {
+    VertexAdaptor<op_var> var;
+    VertexPtr statement;
+    int uses_in_statement{0};
+    VarPtr moved_to;    // a by value param of a called function or an assigned variable
+  };
+
+  VarPtr get_move_destination(VertexAdaptor<op_var> var) const;
+
+  std::vector<VertexPtr> stack_;
+  std::vector<VertexPtr> statements_;
+  int loops_depth_{0};
+  int seq_rval_depth_{0};
+  std::unordered_map<VarPtr, LastUse> last_uses_;
+  // the same vertex may be placed in a tree twice by earlier passes, such variables are never moved
+  std::unordered_set<VertexPtr> visited_vars_;
+  std::unordered_set<VarPtr> shared_vars_;
+};
@@ -0,0 +1,175 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/pipes/calc-non-escaping-instances.h"
+
+#include <unordered_set>
+
+#include "compiler/data/class-data.h"
+#include "compiler/data/var-data.h"
+#include "compiler/inferring/public.h"
+
+namespace {
+
+bool is_class_for_stack_allocation(ClassPtr klass) {
+  return klass && klass->is_class() && !klass->is_builtin() && !klass->is_tl_class && !klass->is_lambda_class()
+         && !klass->is_polymorphic_class() && !klass->is_empty_class();
+}
+
+// a call of a method of the same class with an instance as the first argument: $a->f() or $this->f()
+FunctionPtr get_method_called_on(VertexPtr parent, VertexPtr instance, ClassPtr klass) {
+  auto call = parent.try_as<op_func_call>();
+  if (!call || call->args().empty() || call->args()[0] != instance) {
+    return {};
+  }
+  FunctionPtr callee = call->func_id;
+  if (!callee || callee->is_extern() || !callee->has_implicit_this_arg() || callee->class_id != klass) {
+    return {};
+  }
+  return callee;
+}
+
+bool is_result_used(const std::vector<VertexPtr> &stack, size_t call_depth) {
+  return call_depth == 0 || stack[call_depth - 1]->type() != op_seq;
+}
+
+bool contains_var(VertexPtr root, VarPtr var) {
+  if (auto as_var = root.try_as<op_var>()) {
+    return as_var->var_id == var;
+  }
+  for (auto child : *root) {
+    if (contains_var(child, var)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// $this doesn't escape a method and methods it calls on $this, and an instance doesn't get an alias via returned $this
+bool keeps_this_local(FunctionPtr method, bool is_result_used, std::unordered_set<FunctionPtr> &visited) {
+  if (method->this_escapes || method->is_resumable || (is_result_used && method->returns_this)) {
+    return false;
+  }
+  if (!visited.emplace(method).second) {
+    return true;
+  }
+  for (const auto &callee_and_used : method->methods_called_on_this) {
+    if (!keeps_this_local(callee_and_used.first, callee_and_used.second, visited)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool keeps_this_local(FunctionPtr method, bool is_result_used) {
+  std::unordered_set<FunctionPtr> visited;
+  return keeps_this_local(method, is_result_used, visited);
+}
+
+} // namespace
+
+bool CollectThisUsagesPass::check_function(FunctionPtr function) const {
+  return function->has_implicit_this_arg() && !function->is_extern() && !function->param_ids.empty()
+         && is_class_for_stack_allocation(function->class_id);
+}
+
+void CollectThisUsagesPass::on_start() {
+  this_var_ = current_function->param_ids[0];
+}
+
+VertexPtr CollectThisUsagesPass::on_enter_vertex(VertexPtr vertex) {
+  auto var = vertex.try_as<op_var>();
+  if (var && var->var_id == this_var_ && !stack_.empty()) {
+    VertexPtr parent = stack_.back();
+    if (auto prop = parent.try_as<op_instance_prop>()) {
+      this_escapes_ |= prop->instance() != vertex;
+    } else if (auto callee = get_method_called_on(parent, vertex, current_function->class_id)) {
+      methods_called_on_this_.emplace_back(callee, is_result_used(stack_, stack_.size() - 1));
+    } else if (parent->type() == op_return) {
+      returns_this_ = true;
+    } else if (parent->type() != op_func_param) {
+      this_escapes_ = true;
+    }
+  }
+  stack_.emplace_back(vertex);
+  return vertex;
+}
+
+VertexPtr CollectThisUsagesPass::on_exit_vertex(VertexPtr vertex) {
+  stack_.pop_back();
+  return vertex;
+}
+
+void CollectThisUsagesPass::on_finish() {
+  current_function->this_escapes = this_escapes_;
+  current_function->returns_this = returns_this_;
+  current_function->methods_called_on_this = std::move(methods_called_on_this_);
+}
+
+bool CalcNonEscapingInstancesPass::check_function(FunctionPtr function) const {
+  return !function->is_extern() && !function->is_resumable;
+}
+
+void CalcNonEscapingInstancesPass::on_start() {
+  for (VarPtr var : current_function->local_var_ids) {
+    if (var->type() != VarData::var_local_t || var->is_reference || var->is_foreach_reference) {
+      continue;
+    }
+    const TypeData *type = tinf::get_type(var);
+    if (type->ptype() == tp_Class && !type->use_or_false() && is_class_for_stack_allocation(type->class_type())) {
+      candidates_[var].klass = type->class_type();
+    }
+  }
+}
+
+void CalcNonEscapingInstancesPass::on_candidate_usage(VertexAdaptor<op_var> var, Candidate &candidate) {
+  VertexPtr parent = stack_.back();
+  if (auto prop = parent.try_as<op_instance_prop>()) {
+    candidate.escapes |= prop->instance() != var;
+  } else if (auto callee = get_method_called_on(parent, var, candidate.klass)) {
+    candidate.escapes |= !keeps_this_local(callee, is_result_used(stack_, stack_.size() - 1));
+  } else if (auto set = parent.try_as<op_set>()) {
+    // only $a = new A(...) as a statement, where the constructor doesn't let $this escape and the arguments don't use $a:
+    // the previous instance in the storage is destroyed before the arguments are evaluated
+    auto call = set->rhs().try_as<op_func_call>();
+    auto alloc = call && call->extra_type == op_ex_constructor_call && !call->args().empty() ? call->args()[0].try_as<op_alloc>() : VertexAdaptor<op_alloc>{};
+    if (set->lhs() != var || is_result_used(stack_, stack_.size() - 1) || !alloc || alloc->allocated_class != candidate.klass
+        || !keeps_this_local(call->func_id, false) || contains_var(call, var->var_id)) {
+      candidate.escapes = true;
+    } else {
+      candidate.allocations.emplace_back(alloc);
+    }
+  } else {
+    candidate.escapes = true;
+  }
+}
+
+VertexPtr CalcNonEscapingInstancesPass::on_enter_vertex(VertexPtr vertex) {
+  if (auto var = vertex.try_as<op_var>()) {
+    auto it = candidates_.find(var->var_id);
+    if (it != candidates_.end() && !it->second.escapes) {
+      on_candidate_usage(var, it->second);
+    }
+  }
+  stack_.emplace_back(vertex);
+  return vertex;
+}
+
+VertexPtr CalcNonEscapingInstancesPass::on_exit_vertex(VertexPtr vertex) {
+  stack_.pop_back();
+  return vertex;
+}
+
+void CalcNonEscapingInstancesPass::on_finish() {
+  for (auto &var_and_candidate : candidates_) {
+    const Candidate &candidate = var_and_candidate.second;
+    if (candidate.escapes || candidate.allocations.empty()) {
+      continue;
+    }
+    var_and_candidate.first->is_stack_instance = true;
+    for (auto alloc : candidate.allocations) {
+      alloc->stack_var = var_and_candidate.first;
+    }
+  }
+}
@@ -0,0 +1,65 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "compiler/function-pass.h"
+
+// For every instance method collects how $this is used inside: accessing fields, calling other methods, returning or anything else.
+// Results are saved in FunctionData and are read by CalcNonEscapingInstancesPass for callees, so it must be run before a sync point.
+class CollectThisUsagesPass final : public FunctionPassBase {
+public:
+  std::string get_description() final {
+    return "Collect usages of $this";
+  }
+
+  bool check_function(FunctionPtr function) const final;
+
+  void on_start() final;
+  VertexPtr on_enter_vertex(VertexPtr vertex) final;
+  VertexPtr on_exit_vertex(VertexPtr vertex) final;
+  void on_finish() final;
+
+private:
+  std::vector<VertexPtr> stack_;
+  VarPtr this_var_;
+  bool this_escapes_{false};
+  bool returns_this_{false};
+  std::vector<std::pair<FunctionPtr, bool>> methods_called_on_this_;
+};
+
+// Finds local variables, which are assigned only by `new A(...)` and used only to access fields and to call methods,
+// which don't let $this escape (see CollectThisUsagesPass).
+// Such instances can't outlive the function call, so they are allocated in a storage on stack instead of the script heap:
+//   $a = new A(1);          // class_instance_stack_storage<C$A> v$a$storage; class_instance<C$A> v$a;
+//   echo $a->x + $a->y();   // v$a = f$A$$__construct(class_instance<C$A>().alloc_in(v$a$storage), 1L);
+// Only non-polymorphic user classes are handled, resumable functions are skipped as their locals live across yields.
+class CalcNonEscapingInstancesPass final : public FunctionPassBase {
+public:
+  std::string get_description() final {
+    return "Calc non escaping instances";
+  }
+
+  bool check_function(FunctionPtr function) const final;
+
+  void on_start() final;
+  VertexPtr on_enter_vertex(VertexPtr vertex) final;
+  VertexPtr on_exit_vertex(VertexPtr vertex) final;
+  void on_finish() final;
+
+private:
+  struct Candidate {
+    ClassPtr klass;
+    bool escapes{false};
+    std::vector<VertexAdaptor<op_alloc>> allocations;
+  };
+
+  void on_candidate_usage(VertexAdaptor<op_var> var, Candidate &candidate);
+
+  std::vector<VertexPtr> stack_;
+  std::unordered_map<VarPtr, Candidate> candidates_;
+};
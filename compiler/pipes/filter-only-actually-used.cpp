@@ -201,6 +201,11 @@ IdMap<FunctionPtr> calc_actually_used_having_call_edges(std::vector<FunctionAndE
 void remove_unused_class_methods(const std::vector<FunctionAndEdges> &all, const IdMap<FunctionPtr> &used_functions) {
   for (const auto &f_and_e : all) {
     FunctionPtr fun = f_and_e.first;
+    if (!used_functions[fun]) {
+      // classes declare C++ virtual members only for generated virtual methods
+      fun->vtable_implementations.clear();
+      fun->vtable_abstract_classes.clear();
+    }
     if (fun->type == FunctionData::func_class_holder) {
       fun->class_id->members.remove_if(
         [&used_functions](const ClassMemberStaticMethod &m) {
@@ -266,13 +266,24 @@ void check_constructor_signature_compatibility(FunctionPtr interface_constructor
   }
 }
 
+// a dispatching switch is compiled into a binary search through class hashes, mispredicted in megamorphic call sites;
+// for hierarchies with more implementations, every implementation gets a C++ virtual member, and a method becomes one indirect call
+constexpr size_t VTABLE_DISPATCH_MIN_IMPLEMENTATIONS = 16;
+
+bool can_be_dispatched_through_vtable(ClassPtr klass, const std::vector<ClassPtr> &implementations) {
+  auto is_codegenerated_struct = [](ClassPtr c) {
+    return !c->is_builtin() && !c->is_lambda_class() && !c->is_typed_callable_interface() && !c->is_ffi_scope() && !c->is_ffi_cdata();
+  };
+  return implementations.size() >= VTABLE_DISPATCH_MIN_IMPLEMENTATIONS &&
+         is_codegenerated_struct(klass) && std::all_of(implementations.begin(), implementations.end(), is_codegenerated_struct);
+}
+
 VertexAdaptor<op_case> gen_case_on_hash(ClassPtr derived, VertexAdaptor<op_seq> cmd) {
   auto hash_of_derived = VertexUtil::create_int_const(derived->get_hash());
   return VertexAdaptor<op_case>::create(hash_of_derived, cmd);
 }
 
-VertexAdaptor<op_case> gen_case_calling_methods_on_derived_class(ClassPtr derived, FunctionPtr virtual_function) {
-  FunctionPtr concrete_method_of_derived;
+VertexAdaptor<op_case> gen_case_calling_methods_on_derived_class(ClassPtr derived, FunctionPtr virtual_function, FunctionPtr &concrete_method_of_derived) {
   if (const auto *method_of_derived = derived->members.get_instance_method(virtual_function->local_name())) {
     concrete_method_of_derived = method_of_derived->function;
   } else {
@@ -398,6 +409,9 @@ VertexAdaptor<op_seq> generate_body_of_empty_virtual_method(ClassPtr klass, Func
  *   default: {
  *     critical_error("call method(Interface::virtual_function) on null object
  *   }
+ *
+ * for hierarchies with VTABLE_DISPATCH_MIN_IMPLEMENTATIONS and more, codegen replaces the switch with a call of a C++ virtual member,
+ * and cases become bodies of its overrides in Derived1, Derived2, etc. (see compile_vtable_dispatching())
  */
 void generate_body_of_virtual_method(FunctionPtr virtual_function) {
   auto klass = virtual_function->class_id;
@@ -413,13 +427,27 @@ void generate_body_of_virtual_method(FunctionPtr virtual_function) {
   std::vector<ClassPtr> all_derived_classes = klass->get_all_derived_classes();
   std::sort(all_derived_classes.begin(), all_derived_classes.end());
   ClassPtr prev_derived;
+  const ProfileGuidedData &profile = G->get_profile_guided_data();
+  uint64_t total_calls = 0;
+  uint64_t hottest_calls = 0;
+  VertexAdaptor<op_case> hottest_case;
+  std::vector<ClassPtr> implementations;
 
   for (ClassPtr derived : all_derived_classes) {
     kphp_error (prev_derived != derived, fmt_format("Duplicated class {} in hierarchy from class {}.\nDiamond inheritance is not supported", derived->name, klass->name));
     prev_derived = derived;
 
-    if (auto v_case = gen_case_calling_methods_on_derived_class(derived, virtual_function)) {
+    FunctionPtr concrete_method_of_derived;
+    if (auto v_case = gen_case_calling_methods_on_derived_class(derived, virtual_function, concrete_method_of_derived)) {
       cases.emplace_back(v_case);
+      implementations.emplace_back(derived);
+      const auto *method_profile = profile.find(concrete_method_of_derived);
+      const uint64_t calls = method_profile ? method_profile->calls : 0;
+      total_calls += calls;
+      if (calls > hottest_calls) {
+        hottest_calls = calls;
+        hottest_case = v_case;
+      }
     }
   }
   if (!cases.empty()) {
@@ -436,7 +464,30 @@ void generate_body_of_virtual_method(FunctionPtr virtual_function) {
     auto call_get_hash = VertexAdaptor<op_func_call>::create(ClassData::gen_vertex_this({}));
     call_get_hash->str_val = "get_hash_of_class";
     call_get_hash->func_id = G->get_function(call_get_hash->str_val);
-    virtual_function->root->cmd_ref() = VertexAdaptor<op_seq>::create(VertexUtil::create_switch_vertex(virtual_function, call_get_hash, std::move(cases)));
+    auto dispatching_switch = VertexUtil::create_switch_vertex(virtual_function, call_get_hash, std::move(cases));
+    // if one implementation takes most of the calls according to the profile, check it before the switch:
+    // if (get_hash_of_class($this) == 0xDEADBEAF) { ... }
+    if (hottest_case && hottest_calls * 2 > total_calls) {
+      auto is_hottest_class = VertexAdaptor<op_eq2>::create(call_get_hash.clone(), hottest_case->expr().clone());
+      auto check_hottest = VertexAdaptor<op_if>::create(is_hottest_class, hottest_case->cmd().clone());
+      virtual_function->root->cmd_ref() = VertexAdaptor<op_seq>::create(check_hottest, dispatching_switch);
+    } else {
+      virtual_function->root->cmd_ref() = VertexAdaptor<op_seq>::create(dispatching_switch);
+    }
+  }
+
+  if (can_be_dispatched_through_vtable(klass, implementations)) {
+    // the switch is left in the body for type inferring, codegen replaces it with a call of a virtual member
+    for (ClassPtr derived : all_derived_classes) {
+      if (derived->is_interface() && derived != klass) {
+        continue;
+      }
+      derived->vtable_methods.emplace_back(virtual_function);
+      if (!derived->is_interface() && !vk::contains(implementations, derived)) {
+        virtual_function->vtable_abstract_classes.emplace_back(derived);
+      }
+    }
+    virtual_function->vtable_implementations = std::move(implementations);
   }
 
   virtual_function->type = FunctionData::func_local;    // could be func_extern before, but now it has a body
@@ -4,12 +4,18 @@
 
 #include "compiler/pipes/inline-simple-functions.h"
 
+#include "compiler/compiler-core.h"
 #include "compiler/data/src-file.h"
 #include "compiler/data/var-data.h"
 #include "compiler/inferring/public.h"
 
+void InlineSimpleFunctions::on_start() {
+  // hot functions from the profile are inlined even if they are not so simple
+  max_simple_operations_ = G->get_profile_guided_data().is_hot(current_function) ? 16 : 6;
+}
+
 void InlineSimpleFunctions::on_simple_operation() noexcept {
-  if (++n_simple_operations_ > 6) {
+  if (++n_simple_operations_ > max_simple_operations_) {
     inline_is_possible_ = false;
   }
 }
@@ -104,7 +110,9 @@ bool InlineSimpleFunctions::check_function(FunctionPtr function) const {
          !function->is_main_function() &&
          function->type != FunctionData::func_class_holder &&
          (!function->modifiers.is_instance() || function->local_name() != "__wakeup") &&
-         !function->kphp_lib_export;
+         !function->kphp_lib_export &&
+         function->vtable_implementations.empty() &&
+         !G->get_profile_guided_data().is_cold(function);
 }
 
 void InlineSimpleFunctions::on_finish() {
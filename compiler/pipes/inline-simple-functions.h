@@ -10,6 +10,7 @@ class InlineSimpleFunctions final : public FunctionPassBase {
 private:
   bool inline_is_possible_{true};
   int n_simple_operations_{0};
+  int max_simple_operations_{6};
   bool in_param_list_{false};
 
   void on_simple_operation() noexcept;
@@ -17,6 +18,7 @@ private:
 public:
   std::string get_description() final { return "Inline simple functions"; }
 
+  void on_start() final;
   VertexPtr on_enter_vertex(VertexPtr root) final;
   VertexPtr on_exit_vertex(VertexPtr root) final;
   bool user_recursion(VertexPtr) final;
@@ -0,0 +1,126 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/profile-guided-data.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#include "common/wrappers/fmt_format.h"
+#include "common/wrappers/string_view.h"
+
+#include "compiler/data/function-data.h"
+#include "compiler/stage.h"
+
+namespace {
+
+// functions taking this share of the total cpu time are hot
+constexpr double HOT_CPU_TIME_SHARE = 0.8;
+// functions called less than this share of all calls and taking less than this share of the cpu time are cold
+constexpr double COLD_SHARE = 1e-5;
+
+// the runtime profiler writes "fn=name (label)" for labeled stats, they are summed with unlabeled ones
+std::string strip_label(std::string name) {
+  const auto label_pos = name.rfind(" (");
+  if (label_pos != std::string::npos && !name.empty() && name.back() == ')') {
+    name.erase(label_pos);
+  }
+  return name;
+}
+
+bool parse_key(vk::string_view line, vk::string_view key, std::string &value) {
+  if (!line.starts_with(key)) {
+    return false;
+  }
+  value = static_cast<std::string>(line.substr(key.size()));
+  return true;
+}
+
+} // namespace
+
+void ProfileGuidedData::load_from(const std::string &callgrind_file) {
+  std::ifstream in{callgrind_file};
+  kphp_error_return(in.is_open(), fmt_format("Can't open profile file {}", callgrind_file));
+
+  // "fn=" is followed by a line with self stats: "<line> <16 events>", cpu_ns is the 15th event;
+  // "cfn=" and "calls=" are followed by a line with inclusive stats of the callee, they are skipped
+  enum class Expected { nothing, self_stats, callee_stats };
+  Expected expected = Expected::nothing;
+  FunctionProfile *current = nullptr;
+  std::string callee;
+  std::string line, value;
+  for (size_t line_num = 1; std::getline(in, line); ++line_num) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    if (parse_key(line, "fn=", value)) {
+      current = &functions_[strip_label(value)];
+      expected = Expected::self_stats;
+    } else if (parse_key(line, "cfn=", value)) {
+      callee = strip_label(value);
+    } else if (parse_key(line, "calls=", value)) {
+      const uint64_t calls = std::strtoull(value.c_str(), nullptr, 10);
+      functions_[callee].calls += calls;
+      total_calls_ += calls;
+      expected = Expected::callee_stats;
+    } else if (expected == Expected::self_stats && current) {
+      std::istringstream stats{line};
+      std::vector<uint64_t> events{std::istream_iterator<uint64_t>{stats}, std::istream_iterator<uint64_t>{}};
+      kphp_error_return(events.size() == 17, fmt_format("Bad profile file {}: unexpected stats at line {}", callgrind_file, line_num));
+      current->self_working_ns += events[15];
+      expected = Expected::nothing;
+    } else if (expected == Expected::callee_stats) {
+      expected = Expected::nothing;
+    }
+  }
+
+  std::vector<FunctionProfile *> by_cpu_time;
+  for (auto &name_and_profile : functions_) {
+    by_cpu_time.emplace_back(&name_and_profile.second);
+    total_working_ns_ += name_and_profile.second.self_working_ns;
+  }
+  std::sort(by_cpu_time.begin(), by_cpu_time.end(), [](const FunctionProfile *lhs, const FunctionProfile *rhs) {
+    return lhs->self_working_ns > rhs->self_working_ns;
+  });
+  uint64_t hot_working_ns = 0;
+  for (FunctionProfile *profile : by_cpu_time) {
+    if (hot_working_ns >= total_working_ns_ * HOT_CPU_TIME_SHARE || !profile->self_working_ns) {
+      break;
+    }
+    profile->is_hot = true;
+    hot_working_ns += profile->self_working_ns;
+  }
+}
+
+const ProfileGuidedData::FunctionProfile *ProfileGuidedData::find(FunctionPtr function) const {
+  return functions_.empty() ? nullptr : find(function->as_human_readable(false));
+}
+
+const ProfileGuidedData::FunctionProfile *ProfileGuidedData::find(const std::string &function_name) const {
+  auto it = functions_.find(function_name);
+  return it == functions_.end() ? nullptr : &it->second;
+}
+
+bool ProfileGuidedData::is_hot(FunctionPtr function) const {
+  return !functions_.empty() && is_hot(function->as_human_readable(false));
+}
+
+bool ProfileGuidedData::is_hot(const std::string &function_name) const {
+  const FunctionProfile *profile = find(function_name);
+  return profile && profile->is_hot;
+}
+
+bool ProfileGuidedData::is_cold(FunctionPtr function) const {
+  return !functions_.empty() && is_cold(function->as_human_readable(false));
+}
+
+bool ProfileGuidedData::is_cold(const std::string &function_name) const {
+  const FunctionProfile *profile = find(function_name);
+  // root functions have no calls from other profiled functions, but they are not cold as they take the time
+  return profile && !profile->is_hot && profile->calls < total_calls_ * COLD_SHARE && profile->self_working_ns < total_working_ns_ * COLD_SHARE;
+}
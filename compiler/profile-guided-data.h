@@ -0,0 +1,45 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "compiler/data/data_ptr.h"
+
+// A profile of a running site, that is collected by the runtime profiler (@kphp-profile or -g2, see runtime/profiler.cpp).
+// It's a callgrind file, several files can be concatenated into one, stats of the same functions are summed.
+// The compiler uses it to guide optimizations:
+//  * hot functions get a bigger inlining budget and __attribute__((hot)), cold ones are never inlined and get __attribute__((cold)),
+//    so gcc/clang place them apart and predict branches leading to their calls as unlikely;
+//  * virtual methods check the most called implementation before the dispatching switch.
+class ProfileGuidedData {
+public:
+  struct FunctionProfile {
+    uint64_t calls{0};
+    uint64_t self_working_ns{0};
+    bool is_hot{false};
+  };
+
+  void load_from(const std::string &callgrind_file);
+
+  bool empty() const { return functions_.empty(); }
+
+  // functions are matched by FunctionData::as_human_readable(false), as it's the name written by the runtime profiler;
+  // nullptr if a function is missing in the profile, e.g. it wasn't profiled
+  const FunctionProfile *find(FunctionPtr function) const;
+  const FunctionProfile *find(const std::string &function_name) const;
+
+  bool is_hot(FunctionPtr function) const;
+  bool is_hot(const std::string &function_name) const;
+  bool is_cold(FunctionPtr function) const;
+  bool is_cold(const std::string &function_name) const;
+
+private:
+  std::unordered_map<std::string, FunctionProfile> functions_;
+  uint64_t total_calls_{0};
+  uint64_t total_working_ns_{0};
+};
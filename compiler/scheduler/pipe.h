@@ -28,19 +28,22 @@ private:
   using InputType = typename PipeType::InputType;
   InputType input;
   PipeType *pipe_ptr;
+  std::chrono::steady_clock::time_point pushed_at;
   static ProfilerRaw& get_task_profiler() {
     static CachedProfiler cache{demangle(typeid(typename PipeType::PipeFunctionType).name())};
     return *cache;
   }
 
 public:
-  PipeTask(InputType &&input, PipeType *pipe_ptr) :
+  PipeTask(InputType &&input, PipeType *pipe_ptr, std::chrono::steady_clock::time_point pushed_at) :
     input(std::move(input)),
-    pipe_ptr(pipe_ptr) {
+    pipe_ptr(pipe_ptr),
+    pushed_at(pushed_at) {
   }
 
   void execute() override {
     if (NeedProfiler<typename PipeType::PipeFunctionType>::value) {
+      get_task_profiler().add_queue_time(std::chrono::steady_clock::now() - pushed_at);
       AutoProfiler prof{get_task_profiler()};
       pipe_ptr->process_input(std::move(input));
     } else {
@@ -101,10 +104,11 @@ public:
 
   Task *get_task() override {
     InputType x{};
-    if (!input_stream->get(x)) {
+    std::chrono::steady_clock::time_point pushed_at;
+    if (!input_stream->get(x, pushed_at)) {
       return nullptr;
     }
-    return new TaskType(std::move(x), this);
+    return new TaskType(std::move(x), this, pushed_at);
   }
 
   virtual void process_input(InputType &&input) {
@@ -20,6 +20,12 @@ void unset_scheduler(SchedulerBase *old_scheduler) {
   scheduler = nullptr;
 }
 
+void notify_scheduler_about_new_data() {
+  if (scheduler != nullptr) {
+    scheduler->on_new_data();
+  }
+}
+
 SchedulerBase *get_scheduler() {
   assert (scheduler != nullptr);
   return scheduler;
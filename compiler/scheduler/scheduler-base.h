@@ -16,6 +16,7 @@ public:
   virtual void add_sync_node(Node *node) = 0;
   virtual void add_task(Task *task) = 0;
   virtual void execute() = 0;
+  virtual void on_new_data() {}
 };
 
 SchedulerBase *get_scheduler();
@@ -24,6 +25,9 @@ void unset_scheduler(SchedulerBase *old_scheduler);
 
 extern volatile int tasks_before_sync_node;
 
+// is called after data is pushed into a stream to wake up idle threads; streams may be filled before a scheduler is created
+void notify_scheduler_about_new_data();
+
 inline void register_async_task(Task *task) {
   get_scheduler()->add_task(task);
 }
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "compiler/scheduler/task.h"
+#include "compiler/threading/profiler.h"
 #include "compiler/threading/thread-id.h"
 #include "compiler/threading/tls.h"
 
@@ -18,7 +19,6 @@ public:
   class Scheduler *scheduler;
 
   Node *node;
-  bool run_flag;
 };
 
 
@@ -59,7 +59,6 @@ void Scheduler::execute() {
   for (int i = 1; i <= threads_count; i++) {
     threads[i].thread_id = i;
     threads[i].scheduler = this;
-    threads[i].run_flag = true;
     if (i <= (int)one_thread_nodes.size()) {
       threads[i].node = one_thread_nodes[i - 1];
     }
@@ -67,10 +66,7 @@ void Scheduler::execute() {
   }
 
   while (true) {
-    if (tasks_before_sync_node > 0) {
-      usleep(250);
-      continue;
-    }
+    wait_for_tasks_before_sync_node();
     if (sync_nodes.empty()) {
       break;
     }
@@ -78,9 +74,12 @@ void Scheduler::execute() {
     sync_nodes.pop();
   }
 
+  {
+    std::lock_guard<std::mutex> lock{park_mutex};
+    run_flag = false;
+  }
+  park_cv.notify_all();
   for (int i = 1; i <= threads_count; i++) {
-    threads[i].run_flag = false;
-    __sync_synchronize();
     pthread_join(threads[i].pthread_id, nullptr);
   }
 
@@ -101,10 +100,36 @@ bool Scheduler::thread_process_node(Node *node) {
   }
   task->execute();
   delete task;
-  __sync_fetch_and_sub(&tasks_before_sync_node, 1);
+  if (__sync_sub_and_fetch(&tasks_before_sync_node, 1) == 0) {
+    std::lock_guard<std::mutex> lock{sync_mutex};
+    sync_cv.notify_one();
+  }
   return true;
 }
 
+void Scheduler::wait_for_tasks_before_sync_node() {
+  std::unique_lock<std::mutex> lock{sync_mutex};
+  sync_cv.wait(lock, [] { return tasks_before_sync_node == 0; });
+}
+
+void Scheduler::on_new_data() {
+  new_data_epoch.fetch_add(1);
+  // a thread increments parked_threads before checking the epoch, so either it sees the new epoch, or it's woken up here
+  if (parked_threads.load() > 0) {
+    std::lock_guard<std::mutex> lock{park_mutex};
+    park_cv.notify_all();
+  }
+}
+
+void Scheduler::park_thread(uint64_t seen_epoch) {
+  static CachedProfiler idle_profiler{"Scheduler idle"};
+  AutoProfiler profiler{*idle_profiler};
+  std::unique_lock<std::mutex> lock{park_mutex};
+  parked_threads.fetch_add(1);
+  park_cv.wait(lock, [&] { return new_data_epoch.load() != seen_epoch || !run_flag; });
+  parked_threads.fetch_sub(1);
+}
+
 void Scheduler::thread_execute(ThreadContext *tls) {
   set_thread_id(tls->thread_id);
 
@@ -115,7 +140,9 @@ void Scheduler::thread_execute(ThreadContext *tls) {
     }
     return at_least_one_task_executed;
   };
-  while (tls->run_flag) {
+  while (run_flag) {
+    // the epoch is read before looking for tasks: data pushed after that wakes the thread up even if it was missed
+    const uint64_t seen_epoch = new_data_epoch.load();
     bool at_least_one_task_executed = false;
     if (tls->node != nullptr) {
       at_least_one_task_executed = process_node(tls->node);
@@ -123,7 +150,7 @@ void Scheduler::thread_execute(ThreadContext *tls) {
       at_least_one_task_executed = std::count_if(nodes.begin(), nodes.end(), process_node) > 0;
     }
     if (!at_least_one_task_executed) {
-      usleep(250);
+      park_thread(seen_epoch);
     }
   }
 }
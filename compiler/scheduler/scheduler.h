@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <queue>
 #include <vector>
 
@@ -20,8 +24,21 @@ private:
   int threads_count;
   TaskPull *task_pull;
 
+  // idle threads are parked until new data is pushed into some stream instead of polling all nodes in a loop
+  std::mutex park_mutex;
+  std::condition_variable park_cv;
+  std::atomic<uint64_t> new_data_epoch{0};
+  std::atomic<int> parked_threads{0};
+  std::atomic<bool> run_flag{true};
+
+  // the main thread waits for all tasks before a sync node to be done
+  std::mutex sync_mutex;
+  std::condition_variable sync_cv;
+
   bool thread_process_node(Node *node);
   void thread_execute(ThreadContext *tls);
+  void park_thread(uint64_t seen_epoch);
+  void wait_for_tasks_before_sync_node();
   friend void *scheduler_thread_execute(void *arg);
 
 public:
@@ -31,6 +48,7 @@ public:
   void add_sync_node(Node *node) override;
   void add_task(Task *task) override;
   void execute() override;
+  void on_new_data() override;
 
   void set_threads_count(int new_threads_count);
 };
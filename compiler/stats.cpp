@@ -74,6 +74,8 @@ void Stats::write_to(std::ostream &out, bool with_indent) const {
   out << indent << "types.params_mixed: " << cnt_mixed_params << std::endl;
   out << indent << "types.const_params_mixed: " << cnt_const_mixed_params << std::endl;
   out << block_sep;
+  out << indent << "codegen.removed_refcount_ops: " << cnt_removed_refcount_ops << std::endl;
+  out << block_sep;
   out << indent << "functions.total: " << total_functions_ << std::endl;
   out << indent << "functions.total_inline: " << total_inline_functions_ << std::endl;
   out << indent << "functions.total_throwing: " << total_throwing_functions_ << std::endl;
@@ -91,6 +93,7 @@ void Stats::write_to(std::ostream &out, bool with_indent) const {
     std::string name = prof.first;
     std::replace_if(name.begin(), name.end(), [](char c) { return !std::isalnum(c); }, '_');
     out << "pipes." << name << ".working_time: " << std::chrono::duration<double>(prof.second.get_working_time()).count() << std::endl;
+    out << "pipes." << name << ".queue_time: " << std::chrono::duration<double>(prof.second.get_queue_time()).count() << std::endl;
     out << "pipes." << name << ".duration: " << std::chrono::duration<double>(prof.second.get_duration()).count() << std::endl;
     out << "pipes." << name << ".memory_usage: " << prof.second.get_memory_usage() << std::endl;
     out << "pipes." << name << ".memory_allocated: " << prof.second.get_memory_total_allocated() << std::endl;
@@ -25,6 +25,7 @@ public:
   std::atomic<std::uint64_t> cnt_mixed_vars{0u};
   std::atomic<std::uint64_t> cnt_const_mixed_params{0u};
   std::atomic<std::uint64_t> cnt_make_clone{0u};
+  std::atomic<std::uint64_t> cnt_removed_refcount_ops{0u};
 
   std::atomic<std::uint64_t> object_out_size{0u};
   std::atomic<double> transpilation_time{0.0};
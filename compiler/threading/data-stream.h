@@ -3,6 +3,7 @@
 // Distributed under the GPL v3 License, see LICENSE.notice.txt
 
 #pragma once
+#include <chrono>
 #include <forward_list>
 #include <mutex>
 #include <vector>
@@ -27,9 +28,16 @@ public:
   }
 
   bool get(DataType &result) {
+    std::chrono::steady_clock::time_point pushed_at;
+    return get(result, pushed_at);
+  }
+
+  // pushed_at is used to measure how long data waits in the queue of a pipe
+  bool get(DataType &result, std::chrono::steady_clock::time_point &pushed_at) {
     std::lock_guard<std::mutex> lock{mutex_};
     if (!queue_.empty()) {
-      result = std::move(queue_.front());
+      result = std::move(queue_.front().first);
+      pushed_at = queue_.front().second;
       queue_.pop_front();
       return true;
     }
@@ -40,13 +48,27 @@ public:
     if (!is_sink_mode_) {
       __sync_fetch_and_add(&tasks_before_sync_node, 1);
     }
-    std::lock_guard<std::mutex> lock{mutex_};
-    queue_.push_front(std::move(input));
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      queue_.emplace_front(std::move(input), is_sink_mode_ ? std::chrono::steady_clock::time_point{} : std::chrono::steady_clock::now());
+    }
+    if (!is_sink_mode_) {
+      notify_scheduler_about_new_data();
+    }
   }
 
   std::forward_list<DataType> flush() {
-    std::lock_guard<std::mutex> lock{mutex_};
-    return std::move(queue_);
+    std::forward_list<std::pair<DataType, std::chrono::steady_clock::time_point>> flushed;
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      flushed = std::move(queue_);
+    }
+    std::forward_list<DataType> result;
+    auto last = result.before_begin();
+    for (auto &data_and_time : flushed) {
+      last = result.emplace_after(last, std::move(data_and_time.first));
+    }
+    return result;
   }
 
   std::vector<DataType> flush_as_vector() {
@@ -56,7 +78,7 @@ public:
 
 private:
   std::mutex mutex_;
-  std::forward_list<DataT> queue_;
+  std::forward_list<std::pair<DataT, std::chrono::steady_clock::time_point>> queue_;
   const bool is_sink_mode_;
 };
 
@@ -4,80 +4,131 @@
 
 #pragma once
 
-#include <cassert>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "compiler/threading/locks.h"
 
-template<class T, int N = 1000000>
+// A concurrent hash table from a hash to a node with T, nodes are never removed and never move in memory.
+// It's split into shards, each of them grows independently:
+//  * lookups are lock-free: they probe an array of node pointers, that is atomically replaced on growing
+//    (old arrays are kept alive till the table destruction, so that concurrent readers never see freed memory);
+//  * insertions lock a shard, so they don't conflict with growing;
+//  * nodes are stored in a deque per shard, so get_all() is proportional to the number of nodes.
+template<class T>
 class TSHashTable {
 public:
   struct HTNode : Lockable {
     unsigned long long hash;
     T data;
 
-    HTNode() :
-      hash(0),
+    explicit HTNode(unsigned long long hash) :
+      hash(hash),
       data() {
     }
   };
 
 private:
-  HTNode *nodes;
-  int used_size;
-public:
-  TSHashTable() :
-    nodes(new HTNode[N]),
-    used_size(0) {
-  }
+  static constexpr int SHARDS_COUNT_BITS = 6;
+  static constexpr size_t SHARDS_COUNT = 1 << SHARDS_COUNT_BITS;
+  static constexpr size_t INITIAL_SLOTS_COUNT = 64;
 
-  HTNode *at(unsigned long long hash) {
-    int i = (unsigned)hash % (unsigned)N;
-    while (true) {
-      while (nodes[i].hash != 0 && nodes[i].hash != hash) {
-        i++;
-        if (i == N) {
-          i = 0;
+  struct Slots {
+    const size_t mask;
+    std::unique_ptr<std::atomic<HTNode *>[]> nodes;
+
+    explicit Slots(size_t count) :
+      mask(count - 1),
+      nodes(new std::atomic<HTNode *>[count]) {
+      for (size_t i = 0; i < count; ++i) {
+        nodes[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    // returns either a node with the hash or an empty slot
+    std::atomic<HTNode *> &probe(unsigned long long hash) const {
+      for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        HTNode *node = nodes[i].load(std::memory_order_acquire);
+        if (node == nullptr || node->hash == hash) {
+          return nodes[i];
         }
       }
-      if (nodes[i].hash == 0 && !__sync_bool_compare_and_swap(&nodes[i].hash, 0, hash)) {
-        int id = __sync_fetch_and_add(&used_size, 1);
-        assert(id * 2 < N);
-        continue;
+    }
+  };
+
+  struct alignas(64) Shard {
+    std::atomic<Slots *> slots{nullptr};
+    std::mutex mutex;
+    std::deque<HTNode> nodes;
+    std::vector<std::unique_ptr<Slots>> all_slots;
+
+    Shard() {
+      all_slots.emplace_back(new Slots(INITIAL_SLOTS_COUNT));
+      slots.store(all_slots.back().get(), std::memory_order_release);
+    }
+
+    // is called under the mutex, a load factor is kept below 1/2
+    void grow_if_needed() {
+      Slots *cur = slots.load(std::memory_order_relaxed);
+      if ((nodes.size() + 1) * 2 <= cur->mask + 1) {
+        return;
+      }
+      auto *grown = new Slots((cur->mask + 1) * 2);
+      for (HTNode &node : nodes) {
+        grown->probe(node.hash).store(&node, std::memory_order_relaxed);
       }
-      break;
+      all_slots.emplace_back(grown);
+      slots.store(grown, std::memory_order_release);
     }
-    return &nodes[i];
+  };
+
+  Shard shards[SHARDS_COUNT];
+
+  Shard &get_shard(unsigned long long hash) {
+    // slots are chosen by lower bits of a hash, so shards are chosen by upper bits of a mixed one
+    return shards[(hash * 0x9E3779B97F4A7C15ULL) >> (64 - SHARDS_COUNT_BITS)];
   }
 
-  const T *find(unsigned long long hash) {
-    int i = (unsigned)hash % (unsigned)N;
-    while (nodes[i].hash != 0 && nodes[i].hash != hash) {
-      i++;
-      if (i == N) {
-        i = 0;
-      }
+public:
+  HTNode *at(unsigned long long hash) {
+    Shard &shard = get_shard(hash);
+    if (HTNode *node = shard.slots.load(std::memory_order_acquire)->probe(hash).load(std::memory_order_acquire)) {
+      return node;
     }
 
-    return nodes[i].hash == hash ? &nodes[i].data : nullptr;
+    std::lock_guard<std::mutex> lock{shard.mutex};
+    shard.grow_if_needed();
+    std::atomic<HTNode *> &slot = shard.slots.load(std::memory_order_relaxed)->probe(hash);
+    if (HTNode *node = slot.load(std::memory_order_relaxed)) {
+      return node;
+    }
+    shard.nodes.emplace_back(hash);
+    slot.store(&shard.nodes.back(), std::memory_order_release);
+    return &shard.nodes.back();
+  }
+
+  const T *find(unsigned long long hash) {
+    HTNode *node = get_shard(hash).slots.load(std::memory_order_acquire)->probe(hash).load(std::memory_order_acquire);
+    return node ? &node->data : nullptr;
   }
 
   std::vector<T> get_all() {
-    std::vector<T> res;
-    for (int i = 0; i < N; i++) {
-      if (nodes[i].hash != 0) {
-        res.push_back(nodes[i].data);
-      }
-    }
-    return res;
+    return get_all_if([](const T &) { return true; });
   }
 
   template<class CondF>
   std::vector<T> get_all_if(const CondF &callbackF) {
     std::vector<T> res;
-    for (int i = 0; i < N; i++) {
-      if (nodes[i].hash != 0 && callbackF(nodes[i].data)) {
-        res.push_back(nodes[i].data);
+    for (Shard &shard : shards) {
+      std::lock_guard<std::mutex> lock{shard.mutex};
+      for (HTNode &node : shard.nodes) {
+        if (callbackF(node.data)) {
+          res.push_back(node.data);
+        }
       }
     }
     return res;
@@ -22,6 +22,7 @@ private:
   std::chrono::nanoseconds working_time_{std::chrono::nanoseconds::zero()};
   std::chrono::nanoseconds min_time_{std::chrono::nanoseconds::max()};
   std::chrono::nanoseconds max_time_{std::chrono::nanoseconds::min()};
+  std::chrono::nanoseconds queue_time_{std::chrono::nanoseconds::zero()};
   int64_t memory_usage_{0};
   size_t memory_total_allocated_{0};
   int started_{0};
@@ -71,6 +72,15 @@ public:
     return max_time_ - min_time_;
   }
 
+  // time that inputs of a pipe were waiting in its stream before being processed
+  void add_queue_time(std::chrono::nanoseconds queue_time) noexcept {
+    queue_time_ += queue_time;
+  }
+
+  std::chrono::nanoseconds get_queue_time() const noexcept {
+    return queue_time_;
+  }
+
   size_t get_calls() const noexcept {
     return calls_;
   }
@@ -80,6 +90,7 @@ public:
     working_time_ += other.working_time_;
     min_time_ = std::min(min_time_, other.min_time_);
     max_time_ = std::max(max_time_, other.max_time_);
+    queue_time_ += other.queue_time_;
     memory_usage_ += other.memory_usage_;
     memory_total_allocated_ += other.memory_total_allocated_;
     print_id = std::min(print_id, other.print_id);
@@ -151,7 +151,7 @@ static int tcp_rpcc_send_handshake_packet (struct connection *c) {
   }
   memset (&P, 0, sizeof (P));
   P.type = RPC_HANDSHAKE;
-  P.flags = default_rpc_flags & RPC_CRYPTO_USE_CRC32C;
+  P.flags = default_rpc_flags & (RPC_CRYPTO_USE_CRC32C | (TCP_RPCC_FUNC(c)->mode_flags & RPC_CRYPTO_ZSTD_PACKED));
   if (!D->remote_pid.port) {
     const uint32_t remote_ip = inet_sockaddr_address(&c->remote_endpoint);
     D->remote_pid.ip = (remote_ip == LOCALHOST ? 0 : remote_ip);
@@ -218,6 +218,13 @@ static int tcp_rpcc_process_handshake_packet (struct connection *c, raw_message_
     D->crypto_flags |= RPC_CRYPTO_USE_CRC32C;
     D->custom_crc_partial = crc32c_partial;
   }
+  if (P.flags & RPC_CRYPTO_ZSTD_PACKED) {
+    if (!(default_rpc_flags & TCP_RPCC_FUNC(c)->mode_flags & RPC_CRYPTO_ZSTD_PACKED)) {
+      tcp_rpcc_send_handshake_error_packet (c, -8);
+      return -8;
+    }
+    D->crypto_flags |= RPC_CRYPTO_ZSTD_PACKED;
+  }
   return 0;
 }
 
@@ -22,7 +22,7 @@ struct tcp_rpc_client_functions {
   int (*rpc_alarm)(struct connection *c);
   int (*rpc_ready)(struct connection *c);
   int (*rpc_close)(struct connection *c, int who);
-  int max_packet_len, mode_flags;
+  int max_packet_len, mode_flags;  /* mode_flags: RPC_CRYPTO_ZSTD_PACKED if execute() supports packed packets */
 };
 extern conn_type_t ct_tcp_rpc_client;
 conn_type_t get_default_tcp_rpc_client_conn_type();
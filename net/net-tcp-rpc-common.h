@@ -75,6 +75,8 @@ struct tcp_rpc_data {
 #define RPC_CRYPTO_ENCRYPTED_MASK     (RPC_CRYPTO_ALLOW_ENCRYPTED | RPC_CRYPTO_NONCE_SENT | RPC_CRYPTO_ENCRYPTION_ON)
 #define RPC_CRYPTO_ALLOW_QACK         0x00000200
 #define RPC_CRYPTO_USE_CRC32C         0x00000800
+/* handshake flags are shared with other RPC implementations: 0x00001000 is flagCancelReq of vkgo, low bits are kept for them */
+#define RPC_CRYPTO_ZSTD_PACKED        0x01000000  /* packets may be packed with zstd, see server/rpc-zstd-packing.h */
 
 #define RPC_NONCE           0x7acb87aa
 #define RPC_HANDSHAKE       0x7682eef5
@@ -84,7 +86,7 @@ struct tcp_rpc_data {
 #define RPC_CRYPTO_AES          1
 #define RPC_CRYPTO_NONE_OR_AES  2
 
-extern int default_rpc_flags;  /* 0 = compatibility mode, RPC_CRYPTO_USE_CRC32C = allow both CRC32C and CRC32 */
+extern int default_rpc_flags;  /* 0 = compatibility mode, RPC_CRYPTO_USE_CRC32C = allow both CRC32C and CRC32, RPC_CRYPTO_ZSTD_PACKED = allow zstd packing */
 
 void net_rpc_send_ping (struct connection *c, long long ping_id) ubsan_supp("alignment");
 
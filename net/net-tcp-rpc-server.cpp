@@ -194,7 +194,7 @@ static int tcp_rpcs_send_handshake_packet (struct connection *c) {
   assert (PID.pid);
   memset (&P, 0, sizeof (P));
   P.type = RPC_HANDSHAKE;
-  P.flags = D->crypto_flags & RPC_CRYPTO_USE_CRC32C;
+  P.flags = D->crypto_flags & (RPC_CRYPTO_USE_CRC32C | RPC_CRYPTO_ZSTD_PACKED);
   memcpy (&P.sender_pid, &PID, sizeof (struct process_id));
   memcpy (&P.peer_pid, &D->remote_pid, sizeof (struct process_id));
 
@@ -250,6 +250,9 @@ static int tcp_rpcs_process_handshake_packet (struct connection *c, raw_message_
   if (P.flags & default_rpc_flags & RPC_CRYPTO_USE_CRC32C) {
     D->crypto_flags |= RPC_CRYPTO_USE_CRC32C;
   }
+  if (P.flags & default_rpc_flags & TCP_RPCS_FUNC(c)->mode_flags & RPC_CRYPTO_ZSTD_PACKED) {
+    D->crypto_flags |= RPC_CRYPTO_ZSTD_PACKED;
+  }
   return 0;
 }
 
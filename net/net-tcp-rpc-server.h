@@ -22,7 +22,7 @@ struct tcp_rpc_server_functions {
   int (*rpc_alarm)(struct connection *c);
   int (*rpc_ready)(struct connection *c);
   int (*rpc_close)(struct connection *c, int who);
-  int max_packet_len, mode_flags;
+  int max_packet_len, mode_flags;  /* mode_flags: RPC_CRYPTO_ZSTD_PACKED if execute() supports packed packets */
   void *memcache_fallback_type, *memcache_fallback_extra;
   void *http_fallback_type, *http_fallback_extra;
 };
@@ -265,7 +265,8 @@ public:
 
 private:
   MallocStateHolder() = default;
-  bool is_malloc_replaced_{false};
+  // malloc is replaced only in the script thread, threads of the ThreadPool always use the libc heap
+  static inline thread_local bool is_malloc_replaced_{false};
   std::array<void *, 128> last_malloc_replacement_backtrace_{};
   int last_malloc_replacement_backtrace_size_{0};
 };
@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
 #include <type_traits>
 
 #include "common/algorithms/fastmod.h"
@@ -38,57 +42,366 @@ array_size &array_size::min(const array_size &other) noexcept {
 
 namespace dl {
 
-template<class T, class T1>
-void sort(T *begin_init, T *end_init, const T1 &compare) {
-  T *begin_stack[32];
-  T *end_stack[32];
+namespace sort_impl {
+
+// a pattern-defeating quicksort: median of 3 (ninther for large ranges) pivots, insertion sort for small ranges,
+// cheap detection of already sorted parts and heapsort when partitions keep getting unbalanced;
+// all scans are bounded, so inconsistent user comparators can't make it go out of the range
+constexpr ptrdiff_t INSERTION_SORT_THRESHOLD = 24;
+constexpr ptrdiff_t NINTHER_THRESHOLD = 128;
+constexpr int PARTIAL_INSERTION_SORT_LIMIT = 8;
+
+template<class T, class Less>
+void insertion_sort(T *begin, T *end, const Less &less) {
+  for (T *cur = begin + 1; cur < end; ++cur) {
+    if (less(*cur, cur[-1])) {
+      T tmp = std::move(*cur);
+      T *sift = cur;
+      do {
+        *sift = std::move(sift[-1]);
+        --sift;
+      } while (sift != begin && less(tmp, sift[-1]));
+      *sift = std::move(tmp);
+    }
+  }
+}
 
-  begin_stack[0] = begin_init;
-  end_stack[0] = end_init - 1;
+// returns false as soon as too many elements have been moved, the range is left in a valid but unsorted state then
+template<class T, class Less>
+bool partial_insertion_sort(T *begin, T *end, const Less &less) {
+  int moved = 0;
+  for (T *cur = begin + 1; cur < end; ++cur) {
+    if (less(*cur, cur[-1])) {
+      T tmp = std::move(*cur);
+      T *sift = cur;
+      do {
+        *sift = std::move(sift[-1]);
+        --sift;
+      } while (sift != begin && less(tmp, sift[-1]));
+      *sift = std::move(tmp);
+      moved += static_cast<int>(cur - sift);
+      if (moved > PARTIAL_INSERTION_SORT_LIMIT) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
 
-  for (int depth = 0; depth >= 0; --depth) {
-    T *begin = begin_stack[depth];
-    T *end = end_stack[depth];
+template<class T, class Less>
+void sort2(T *a, T *b, const Less &less) {
+  if (less(*b, *a)) {
+    swap(*a, *b);
+  }
+}
 
-    while (begin < end) {
-      const auto offset = (end - begin) >> 1;
-      swap(*begin, begin[offset]);
+template<class T, class Less>
+void sort3(T *a, T *b, T *c, const Less &less) {
+  sort2(a, b, less);
+  sort2(b, c, less);
+  sort2(a, b, less);
+}
 
-      T *i = begin + 1, *j = end;
+template<class T, class Less>
+void heap_sort(T *begin, T *end, const Less &less) {
+  std::make_heap(begin, end, less);
+  std::sort_heap(begin, end, less);
+}
 
-      while (1) {
-        while (i < j && compare(*begin, *i) > 0) {
-          i++;
-        }
+// partitions [begin, end) around the pivot *begin into [< pivot] pivot [>= pivot],
+// returns the pivot position and whether the range has already been partitioned
+template<class T, class Less>
+std::pair<T *, bool> partition_right(T *begin, T *end, const Less &less) {
+  T pivot = std::move(*begin);
+  T *first = begin + 1;
+  T *last = end;
+  while (first < last && less(*first, pivot)) {
+    ++first;
+  }
+  while (first < last && !less(last[-1], pivot)) {
+    --last;
+  }
+  const bool already_partitioned = first >= last;
+  while (first < last) {
+    --last;
+    swap(*first, *last);
+    ++first;
+    while (first < last && less(*first, pivot)) {
+      ++first;
+    }
+    while (first < last && !less(last[-1], pivot)) {
+      --last;
+    }
+  }
+  T *pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return {pivot_pos, already_partitioned};
+}
+
+// partitions [begin, end) around the pivot *begin into [<= pivot] pivot [> pivot],
+// used when the pivot equals an element before the range, so all elements equal to it are put in place at once
+template<class T, class Less>
+T *partition_left(T *begin, T *end, const Less &less) {
+  T pivot = std::move(*begin);
+  T *first = begin + 1;
+  T *last = end;
+  while (first < last && less(pivot, last[-1])) {
+    --last;
+  }
+  while (first < last && !less(pivot, *first)) {
+    ++first;
+  }
+  while (first < last) {
+    --last;
+    swap(*first, *last);
+    ++first;
+    while (first < last && less(pivot, last[-1])) {
+      --last;
+    }
+    while (first < last && !less(pivot, *first)) {
+      ++first;
+    }
+  }
+  T *pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return pivot_pos;
+}
 
-        while (i <= j && compare(*j, *begin) > 0) {
-          j--;
-        }
+// swaps a few elements of a badly partitioned side to break patterns, which made the pivot bad
+template<class T>
+void shuffle_unbalanced(T *begin, T *end) {
+  const ptrdiff_t size = end - begin;
+  if (size < INSERTION_SORT_THRESHOLD) {
+    return;
+  }
+  const ptrdiff_t quarter = size / 4;
+  swap(begin[0], begin[quarter]);
+  swap(end[-1], end[-quarter]);
+  if (size > NINTHER_THRESHOLD) {
+    swap(begin[1], begin[quarter + 1]);
+    swap(begin[2], begin[quarter + 2]);
+    swap(end[-2], end[-quarter - 1]);
+    swap(end[-3], end[-quarter - 2]);
+  }
+}
 
-        if (i >= j) {
-          break;
-        }
+template<class T, class Less>
+void pdqsort_loop(T *begin, T *end, const Less &less, int bad_allowed, bool leftmost) {
+  while (true) {
+    const ptrdiff_t size = end - begin;
+    if (size < INSERTION_SORT_THRESHOLD) {
+      insertion_sort(begin, end, less);
+      return;
+    }
+
+    const ptrdiff_t half = size / 2;
+    if (size > NINTHER_THRESHOLD) {
+      sort3(begin, begin + half, end - 1, less);
+      sort3(begin + 1, begin + (half - 1), end - 2, less);
+      sort3(begin + 2, begin + (half + 1), end - 3, less);
+      sort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+      swap(*begin, begin[half]);
+    } else {
+      sort3(begin + half, begin, end - 1, less);
+    }
+
+    // the element before the range is not greater than any element of it,
+    // if it equals the pivot there are many equal elements and they don't need to be sorted further
+    if (!leftmost && !less(begin[-1], *begin)) {
+      begin = partition_left(begin, end, less) + 1;
+      continue;
+    }
 
-        swap(*i++, *j--);
+    const auto partition = partition_right(begin, end, less);
+    T *pivot_pos = partition.first;
+    const ptrdiff_t left_size = pivot_pos - begin;
+    const ptrdiff_t right_size = end - (pivot_pos + 1);
+
+    if (left_size < size / 8 || right_size < size / 8) {
+      if (--bad_allowed == 0) {
+        heap_sort(begin, end, less);
+        return;
       }
+      shuffle_unbalanced(begin, pivot_pos);
+      shuffle_unbalanced(pivot_pos + 1, end);
+    } else if (partition.second && partial_insertion_sort(begin, pivot_pos, less) && partial_insertion_sort(pivot_pos + 1, end, less)) {
+      return;
+    }
 
-      swap(*begin, *j);
+    // recursion goes to the smaller side to bound the stack depth
+    if (left_size < right_size) {
+      pdqsort_loop(begin, pivot_pos, less, bad_allowed, leftmost);
+      begin = pivot_pos + 1;
+      leftmost = false;
+    } else {
+      pdqsort_loop(pivot_pos + 1, end, less, bad_allowed, false);
+      end = pivot_pos;
+    }
+  }
+}
 
-      if (j - begin <= end - j) {
-        if (j + 1 < end) {
-          begin_stack[depth] = j + 1;
-          end_stack[depth++] = end;
-        }
-        end = j - 1;
-      } else {
-        if (begin < j - 1) {
-          begin_stack[depth] = begin;
-          end_stack[depth++] = j - 1;
-        }
-        begin = j + 1;
+// branchless compare-exchange network (odd-even transposition) for tiny ranges of numbers
+template<class T, class Less>
+void sorting_network(T *begin, size_t n, const Less &less) {
+  for (size_t round = 0; round < n; ++round) {
+    for (size_t i = round & 1; i + 1 < n; i += 2) {
+      const T a = begin[i];
+      const T b = begin[i + 1];
+      const bool greater = less(b, a);
+      begin[i] = greater ? b : a;
+      begin[i + 1] = greater ? a : b;
+    }
+  }
+}
+
+inline uint64_t radix_key(int64_t v) noexcept {
+  return static_cast<uint64_t>(v) ^ (uint64_t{1} << 63);
+}
+
+inline uint64_t radix_key(double v) noexcept {
+  uint64_t bits = 0;
+  memcpy(&bits, &v, sizeof(bits));
+  return (bits >> 63) ? ~bits : bits | (uint64_t{1} << 63);
+}
+
+template<class T>
+T from_radix_key(uint64_t key) noexcept {
+  if constexpr (std::is_same<T, int64_t>{}) {
+    return static_cast<int64_t>(key ^ (uint64_t{1} << 63));
+  } else {
+    const uint64_t bits = (key >> 63) ? key & ~(uint64_t{1} << 63) : ~key;
+    double v = 0;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+}
+
+// stable LSD radix sort by bytes of key_of(item), passes over bytes that are equal for all items are skipped;
+// the result is in items, buffer is a scratch space of the same size
+template<class Item, class KeyOf>
+void radix_sort(Item *items, Item *buffer, size_t n, const KeyOf &key_of) {
+  uint32_t counts[8][256] = {};
+  for (size_t i = 0; i < n; ++i) {
+    const uint64_t key = key_of(items[i]);
+    for (int byte = 0; byte < 8; ++byte) {
+      ++counts[byte][(key >> (8 * byte)) & 0xff];
+    }
+  }
+
+  Item *from = items;
+  Item *to = buffer;
+  const uint64_t first_key = key_of(items[0]);
+  for (int byte = 0; byte < 8; ++byte) {
+    const int shift = 8 * byte;
+    uint32_t *count = counts[byte];
+    if (count[(first_key >> shift) & 0xff] == n) {
+      continue;
+    }
+    uint32_t offset = 0;
+    for (int digit = 0; digit < 256; ++digit) {
+      const uint32_t digit_count = count[digit];
+      count[digit] = offset;
+      offset += digit_count;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      to[count[(key_of(from[i]) >> shift) & 0xff]++] = from[i];
+    }
+    std::swap(from, to);
+  }
+  if (from != items) {
+    memcpy(items, from, n * sizeof(Item));
+  }
+}
+
+} // namespace sort_impl
+
+template<class T, class T1>
+void sort(T *begin, T *end, const T1 &compare) {
+  // compare(a, b) > 0 means that a must be placed after b
+  const auto less = [&compare](const T &lhs, const T &rhs) {
+    return compare(rhs, lhs) > 0;
+  };
+  const ptrdiff_t size = end - begin;
+  if (size < 2) {
+    return;
+  }
+  int bad_allowed = 1;
+  for (ptrdiff_t i = size; i > 1; i >>= 1) {
+    ++bad_allowed;
+  }
+  sort_impl::pdqsort_loop(begin, end, less, bad_allowed, true);
+}
+
+// sorts int64_t or double values in the given order, returns false if values can't be sorted without a comparator
+template<class T>
+bool sort_numbers(T *begin, size_t n, sort_order order) {
+  static_assert(std::is_same<T, int64_t>{} || std::is_same<T, double>{}, "only int64_t and double are supported");
+  if constexpr (std::is_same<T, double>{}) {
+    // NaNs are not ordered, the comparator gives them some place which neither sorting network nor radix sort can reproduce
+    for (size_t i = 0; i < n; ++i) {
+      if (std::isnan(begin[i])) {
+        return false;
       }
     }
   }
+  if (n <= SORTING_NETWORK_MAX_SIZE) {
+    if (order == sort_order::ascending) {
+      sort_impl::sorting_network(begin, n, std::less<T>{});
+    } else {
+      sort_impl::sorting_network(begin, n, std::greater<T>{});
+    }
+    return true;
+  }
+  if (n < RADIX_SORT_MIN_SIZE) {
+    return false;
+  }
+
+  const uint64_t flip = order == sort_order::ascending ? 0 : ~uint64_t{0};
+  auto *keys = static_cast<uint64_t *>(dl::allocate(2 * n * sizeof(uint64_t)));
+  for (size_t i = 0; i < n; ++i) {
+    keys[i] = sort_impl::radix_key(begin[i]) ^ flip;
+  }
+  sort_impl::radix_sort(keys, keys + n, n, [](uint64_t key) { return key; });
+  for (size_t i = 0; i < n; ++i) {
+    begin[i] = sort_impl::from_radix_key<T>(keys[i] ^ flip);
+  }
+  dl::deallocate(keys, 2 * n * sizeof(uint64_t));
+  return true;
+}
+
+// sorts pointers to buckets by their int64_t or double values in the given order, equal values keep their relative order
+template<class Bucket>
+bool sort_buckets_by_numbers(Bucket **begin, size_t n, sort_order order) {
+  using T = std::decay_t<decltype(begin[0]->value)>;
+  static_assert(std::is_same<T, int64_t>{} || std::is_same<T, double>{}, "only int64_t and double are supported");
+  if (n < RADIX_SORT_MIN_SIZE) {
+    return false;
+  }
+  if constexpr (std::is_same<T, double>{}) {
+    for (size_t i = 0; i < n; ++i) {
+      if (std::isnan(begin[i]->value)) {
+        return false;
+      }
+    }
+  }
+
+  struct Item {
+    uint64_t key;
+    Bucket *bucket;
+  };
+  const uint64_t flip = order == sort_order::ascending ? 0 : ~uint64_t{0};
+  auto *items = static_cast<Item *>(dl::allocate(2 * n * sizeof(Item)));
+  for (size_t i = 0; i < n; ++i) {
+    items[i] = Item{sort_impl::radix_key(begin[i]->value) ^ flip, begin[i]};
+  }
+  sort_impl::radix_sort(items, items + n, n, [](const Item &item) { return item.key; });
+  for (size_t i = 0; i < n; ++i) {
+    begin[i] = items[i].bucket;
+  }
+  dl::deallocate(items, 2 * n * sizeof(Item));
+  return true;
 }
 
 } // namespace dl
@@ -318,6 +631,21 @@ T &array<T>::array_inner::push_back_vector_value(const T &v) {
   return emplace_back_vector_value(v);
 }
 
+template<class T>
+void array<T>::array_inner::push_back_vector_values(const T *values, uint32_t count) noexcept {
+  php_assert (size + count <= buf_size);
+  T *dst = reinterpret_cast<T *>(entries) + size;
+  if constexpr (std::is_trivially_copyable<T>{}) {
+    if (count) {
+      memcpy(dst, values, count * sizeof(T));
+    }
+  } else {
+    std::uninitialized_copy(values, values + count, dst);
+  }
+  max_key += count;
+  size += count;
+}
+
 template<class T>
 T &array<T>::array_inner::get_vector_value(int64_t int_key) {
   return reinterpret_cast<T *>(entries)[int_key];
@@ -662,12 +990,7 @@ bool array<T>::mutate_to_size_if_vector_shared(int64_t int_size) {
   if (p->ref_cnt > 0) {
     array_inner *new_array = array_inner::create(int_size, true);
 
-    const auto size = static_cast<uint32_t>(p->size);
-    T *it = (T *)p->entries;
-
-    for (uint32_t i = 0; i < size; i++) {
-      new_array->push_back_vector_value(it[i]);
-    }
+    new_array->push_back_vector_values(reinterpret_cast<const T *>(p->entries), p->size);
 
     p->dispose();
     p = new_array;
@@ -1538,6 +1861,19 @@ array_size array<T>::size() const {
 template<class T>
 template<class T1, class>
 void array<T>::merge_with(const array<T1> &other) noexcept {
+  if constexpr (std::is_same<T, T1>{}) {
+    // int keys are renumbered anyway, so vectors of the same type are appended at once
+    if (is_vector() && other.is_vector() && !other.empty()) {
+      const uint32_t other_size = other.p->size;
+      const int64_t new_size = int64_t{p->size} + other_size;
+      if (!mutate_to_size_if_vector_shared(new_size) && p->buf_size < new_size) {
+        mutate_to_size(std::max(new_size, int64_t{p->buf_size} * 2));
+      }
+      // other.p is reread, as other may be this array
+      p->push_back_vector_values(reinterpret_cast<const T *>(other.p->entries), other_size);
+      return;
+    }
+  }
   for (auto it : other) {
     push_back_iterator(it);
   }
@@ -1582,9 +1918,7 @@ const array<T> array<T>::operator+(const array<T> &other) const {
     T *it = (T *)p->entries;
 
     if (result.is_vector()) {
-      for (uint32_t i = 0; i < size; i++) {
-        result.p->push_back_vector_value(it[i]);
-      }
+      result.p->push_back_vector_values(it, size);
     } else {
       for (uint32_t i = 0; i < size; i++) {
         result.p->set_map_value(overwrite_element::YES, i, it[i]);
@@ -1605,8 +1939,8 @@ const array<T> array<T>::operator+(const array<T> &other) const {
     T *it = (T *)other.p->entries;
 
     if (result.is_vector()) {
-      for (uint32_t i = p->size; i < size; i++) {
-        result.p->push_back_vector_value(it[i]);
+      if (p->size < size) {
+        result.p->push_back_vector_values(it + p->size, size - p->size);
       }
     } else {
       for (uint32_t i = 0; i < size; i++) {
@@ -1641,10 +1975,7 @@ array<T> &array<T>::operator+=(const array<T> &other) {
         T *my_it = (T *)p->entries;
 
         array_inner *new_array = array_inner::create(max(size, my_size), true);
-
-        for (uint32_t i = 0; i < my_size; i++) {
-          new_array->push_back_vector_value(my_it[i]);
-        }
+        new_array->push_back_vector_values(my_it, my_size);
 
         p->dispose();
         p = new_array;
@@ -1658,8 +1989,8 @@ array<T> &array<T>::operator+=(const array<T> &other) {
         php_warning("Strange usage of array operator += on two vectors. Did you mean array_merge?");
       }
 
-      for (uint32_t i = p->size; i < size; i++) {
-        p->push_back_vector_value(it[i]);
+      if (p->size < size) {
+        p->push_back_vector_values(it + p->size, size - p->size);
       }
 
       return *this;
@@ -1875,11 +2206,16 @@ void array<T>::sort(const T1 &compare, bool renumber) {
       mutate_if_vector_shared();
     }
 
+    T *begin = reinterpret_cast<T *>(p->entries);
+    if constexpr (dl::numeric_sort_order<T1>::value != dl::sort_order::none && (std::is_same<T, int64_t>{} || std::is_same<T, double>{})) {
+      if (dl::sort_numbers(begin, n, dl::numeric_sort_order<T1>::value)) {
+        return;
+      }
+    }
     const auto elements_cmp =
       [&compare](const T &lhs, const T &rhs) {
         return compare(lhs, rhs) > 0;
       };
-    T *begin = reinterpret_cast<T *>(p->entries);
     dl::sort<T, decltype(elements_cmp)>(begin, begin + n, elements_cmp);
     return;
   }
@@ -1901,11 +2237,17 @@ void array<T>::sort(const T1 &compare, bool renumber) {
   }
   php_assert (i == n);
 
-  const auto hash_entry_cmp =
-    [&compare](const array_bucket *lhs, const array_bucket *rhs) {
-      return compare(lhs->value, rhs->value) > 0;
-    };
-  dl::sort<array_bucket *, decltype(hash_entry_cmp)>(arTmp, arTmp + n, hash_entry_cmp);
+  bool sorted = false;
+  if constexpr (dl::numeric_sort_order<T1>::value != dl::sort_order::none && (std::is_same<T, int64_t>{} || std::is_same<T, double>{})) {
+    sorted = dl::sort_buckets_by_numbers(arTmp, n, dl::numeric_sort_order<T1>::value);
+  }
+  if (!sorted) {
+    const auto hash_entry_cmp =
+      [&compare](const array_bucket *lhs, const array_bucket *rhs) {
+        return compare(lhs->value, rhs->value) > 0;
+      };
+    dl::sort<array_bucket *, decltype(hash_entry_cmp)>(arTmp, arTmp + n, hash_entry_cmp);
+  }
 
   arTmp[0]->prev = p->get_pointer(p->end());
   p->end()->next = p->get_pointer(arTmp[0]);
@@ -1940,7 +2282,23 @@ void array<T>::ksort(const T1 &compare) {
   }
 
   key_type *keysp = (key_type *)keys.p->entries;
-  dl::sort<key_type, T1>(keysp, keysp + n, compare);
+  bool sorted = false;
+  if constexpr (dl::numeric_sort_order<T1>::value != dl::sort_order::none) {
+    if (p->has_no_string_keys() && n >= dl::RADIX_SORT_MIN_SIZE) {
+      auto *int_keys = static_cast<int64_t *>(dl::allocate(n * sizeof(int64_t)));
+      for (uint32_t j = 0; j < n; j++) {
+        int_keys[j] = keysp[j].as_int();
+      }
+      sorted = dl::sort_numbers(int_keys, n, dl::numeric_sort_order<T1>::value);
+      for (uint32_t j = 0; j < n; j++) {
+        keysp[j] = int_keys[j];
+      }
+      dl::deallocate(int_keys, n * sizeof(int64_t));
+    }
+  }
+  if (!sorted) {
+    dl::sort<key_type, T1>(keysp, keysp + n, compare);
+  }
 
   list_hash_entry *prev = (list_hash_entry *)p->end();
   for (uint32_t j = 0; j < n; j++) {
@@ -2183,6 +2541,11 @@ bool array<T>::is_equal_inner_pointer(const array &other) const noexcept {
   return p == other.p;
 }
 
+template<class T>
+const void *array<T>::get_inner_pointer() const noexcept {
+  return p;
+}
+
 template<class T>
 void swap(array<T> &lhs, array<T> &rhs) {
   lhs.swap(rhs);
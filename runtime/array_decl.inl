@@ -35,9 +35,25 @@ struct array_size {
 #endif
 
 namespace dl {
-template<class T, class TT, class T1>
-void sort(TT *begin_init, TT *end_init, const T1 &compare);
-}
+template<class T, class T1>
+void sort(T *begin, T *end, const T1 &compare);
+
+enum class sort_order { none, ascending, descending };
+
+// comparators that order int64_t or double values (or int keys) by their numeric value specialize it,
+// so sorting by them can go without calling the comparator
+template<class T1>
+struct numeric_sort_order : std::integral_constant<sort_order, sort_order::none> {};
+
+constexpr size_t SORTING_NETWORK_MAX_SIZE = 8;
+constexpr size_t RADIX_SORT_MIN_SIZE = 256;
+
+template<class T>
+bool sort_numbers(T *begin, size_t n, sort_order order);
+
+template<class Bucket>
+bool sort_buckets_by_numbers(Bucket **begin, size_t n, sort_order order);
+} // namespace dl
 
 enum class overwrite_element { YES, NO };
 
@@ -140,6 +156,8 @@ private:
     template<class ...Args>
     inline T &emplace_back_vector_value(Args &&... args) noexcept;
     inline T &push_back_vector_value(const T &v); //unsafe
+    // appends values at once, trivially copyable ones (int64_t, double, etc.) by memcpy
+    inline void push_back_vector_values(const T *values, uint32_t count) noexcept; //unsafe
 
     template<class ...Args>
     inline T &emplace_vector_value(int64_t int_key, Args &&... args) noexcept;
@@ -419,6 +437,7 @@ public:
   T *get_vector_pointer(); // unsafe
 
   bool is_equal_inner_pointer(const array &other) const noexcept;
+  const void *get_inner_pointer() const noexcept; // for identity checks only
 
   void reserve(int64_t int_size, bool make_vector_if_possible);
 
@@ -7,6 +7,7 @@
 #include <climits>
 #include <numeric>
 
+#include "common/algorithms/simd-numeric-kernels.h"
 #include "common/type_traits/function_traits.h"
 #include "common/vector-product.h"
 
@@ -968,8 +969,34 @@ bool f$array_key_exists(K, const array<T> &) {
   return false;
 }
 
+// for vectors of int64_t and double with the needle of the same type both == and === are just ==
+template<class T, class T1>
+inline constexpr bool is_primitive_vector_search_v = std::is_same_v<T, T1> && (std::is_same_v<T, int64_t> || std::is_same_v<T, double>);
+
+// returns the index of the value in the vector a, or -1
+template<class T>
+int64_t primitive_vector_search(T value, const array<T> &a) {
+  const auto size = static_cast<size_t>(a.count());
+  if (size == 0) {
+    return -1;
+  }
+  size_t pos = 0;
+  if constexpr (std::is_same_v<T, int64_t>) {
+    pos = simd_find_int64(a.get_const_vector_pointer(), size, value);
+  } else {
+    pos = simd_find_double(a.get_const_vector_pointer(), size, value);
+  }
+  return pos == size ? -1 : static_cast<int64_t>(pos);
+}
+
 template<class T, class T1>
 typename array<T>::key_type f$array_search(const T1 &val, const array<T> &a, bool strict) {
+  if constexpr (is_primitive_vector_search_v<T, T1>) {
+    if (a.is_vector()) {
+      const int64_t pos = primitive_vector_search(val, a);
+      return pos == -1 ? typename array<T>::key_type(false) : typename array<T>::key_type(pos);
+    }
+  }
   for (const auto &it : a) {
     if (strict ? equals(it.get_value(), val) : eq2(it.get_value(), val)) {
       return it.get_key();
@@ -1114,6 +1141,11 @@ array<typename array<T>::key_type> f$array_flip(const array<T> &a) {
 
 template<class T, class T1>
 bool f$in_array(const T1 &value, const array<T> &a, bool strict) {
+  if constexpr (is_primitive_vector_search_v<T, T1>) {
+    if (a.is_vector()) {
+      return primitive_vector_search(value, a) != -1;
+    }
+  }
   if (!strict) {
     for (const auto &it : a) {
       if (eq2(it.get_value(), value)) {
@@ -1392,6 +1424,37 @@ struct rsort_compare_string {
   }
 };
 
+namespace dl {
+
+template<>
+struct numeric_sort_order<sort_compare<int64_t>> : std::integral_constant<sort_order, sort_order::ascending> {};
+template<>
+struct numeric_sort_order<sort_compare<double>> : std::integral_constant<sort_order, sort_order::ascending> {};
+template<>
+struct numeric_sort_order<sort_compare_numeric<int64_t>> : std::integral_constant<sort_order, sort_order::ascending> {};
+template<>
+struct numeric_sort_order<sort_compare_numeric<double>> : std::integral_constant<sort_order, sort_order::ascending> {};
+template<>
+struct numeric_sort_order<rsort_compare<int64_t>> : std::integral_constant<sort_order, sort_order::descending> {};
+template<>
+struct numeric_sort_order<rsort_compare<double>> : std::integral_constant<sort_order, sort_order::descending> {};
+template<>
+struct numeric_sort_order<rsort_compare_numeric<int64_t>> : std::integral_constant<sort_order, sort_order::descending> {};
+template<>
+struct numeric_sort_order<rsort_compare_numeric<double>> : std::integral_constant<sort_order, sort_order::descending> {};
+
+// for array keys these comparators are used only by ksort and krsort, which check that all keys are ints
+template<>
+struct numeric_sort_order<sort_compare<mixed>> : std::integral_constant<sort_order, sort_order::ascending> {};
+template<>
+struct numeric_sort_order<sort_compare_numeric<mixed>> : std::integral_constant<sort_order, sort_order::ascending> {};
+template<>
+struct numeric_sort_order<rsort_compare<mixed>> : std::integral_constant<sort_order, sort_order::descending> {};
+template<>
+struct numeric_sort_order<rsort_compare_numeric<mixed>> : std::integral_constant<sort_order, sort_order::descending> {};
+
+} // namespace dl
+
 template<class T>
 void f$rsort(array<T> &a, int64_t flag) {
   switch (flag) {
@@ -1489,6 +1552,23 @@ template<class T, class ReturnT>
 ReturnT f$array_sum(const array<T> &a) {
   static_assert(!std::is_same_v<T, int>, "int is forbidden");
 
+  if constexpr (std::is_same_v<T, int64_t>) {
+    if (a.is_vector()) {
+      return simd_sum_int64(a.get_const_vector_pointer(), a.count());
+    }
+  }
+  if constexpr (std::is_same_v<T, double>) {
+    if (a.is_vector()) {
+      // summation order is kept to get exactly the same result
+      const double *values = a.get_const_vector_pointer();
+      ReturnT result = 0;
+      for (int64_t i = 0, size = a.count(); i < size; ++i) {
+        result += values[i];
+      }
+      return result;
+    }
+  }
+
   ReturnT result = 0;
   for (const auto &it : a) {
     if constexpr (std::is_same_v<T, int64_t>) {
@@ -40,6 +40,14 @@ class_instance<T> class_instance<T>::alloc(Args &&... args) {
   return *this;
 }
 
+template<class T>
+class_instance<T> class_instance<T>::alloc_in(class_instance_stack_storage<T> &storage) {
+  static_assert(!std::is_empty<T>{}, "class T may not be empty");
+  php_assert(!o);
+  new (&o) vk::intrusive_ptr<T>(storage.emplace());
+  return *this;
+}
+
 template<class T>
 inline class_instance<T> class_instance<T>::empty_alloc() {
   static_assert(std::is_empty<T>{}, "class T must be empty");
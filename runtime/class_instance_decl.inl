@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/mixin/not_copyable.h"
 #include "common/smart_ptrs/intrusive_ptr.h"
 
 #ifndef INCLUDED_FROM_KPHP_CORE
@@ -21,6 +22,9 @@
 
 class abstract_refcountable_php_interface;
 
+template<class T>
+class class_instance_stack_storage;
+
 template<class T>
 class class_instance {
   vk::intrusive_ptr<T> o;
@@ -76,6 +80,8 @@ public:
   template<class... Args>
   inline class_instance<T> alloc(Args &&... args) __attribute__((always_inline));
   inline class_instance<T> empty_alloc() __attribute__((always_inline));
+  // for instances that never escape the function, the storage is a local variable of the function
+  inline class_instance<T> alloc_in(class_instance_stack_storage<T> &storage) __attribute__((always_inline));
   inline void destroy() { o.reset(); }
   int64_t get_reference_counter() const { return o ? o->get_refcnt() : 0; }
 
@@ -141,6 +147,13 @@ public:
     return res;
   }
 
+  // for C++ virtual members dispatching virtual methods: wraps `this`, the reference counter is incremented
+  static class_instance create_from_this(T *object) noexcept {
+    class_instance res;
+    res.o = vk::intrusive_ptr<T>{object};
+    return res;
+  }
+
   inline T *operator->() __attribute__ ((always_inline));
   inline T *operator->() const __attribute__ ((always_inline));
 
@@ -184,6 +197,39 @@ private:
   class_instance<T> clone_impl(std::false_type /*is empty*/) const;
 };
 
+// Holds an instance that is proven by the compiler not to escape the function.
+// The instance is never freed through the reference counter: it's destroyed on the next allocation in the same storage
+// or when the storage goes out of scope, so the storage is declared before the variable that refers to the instance.
+template<class T>
+class class_instance_stack_storage : vk::not_copyable {
+public:
+  class_instance_stack_storage() = default;
+
+  ~class_instance_stack_storage() {
+    if (constructed_) {
+      get()->~T();
+    }
+  }
+
+  T *emplace() {
+    if (constructed_) {
+      get()->~T();
+    }
+    new (buffer_) T{};
+    constructed_ = true;
+    get()->set_refcnt(ExtraRefCnt::for_global_const);
+    return get();
+  }
+
+private:
+  T *get() noexcept {
+    return reinterpret_cast<T *>(buffer_);
+  }
+
+  alignas(T) char buffer_[sizeof(T)];
+  bool constructed_{false};
+};
+
 template<class T, class ...Args>
 class_instance<T> make_instance(Args &&...args) noexcept {
   class_instance<T> instance;
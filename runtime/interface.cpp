@@ -2411,6 +2411,7 @@ static void free_runtime_libs() {
 #endif
   vk::singleton<database_drivers::Adaptor>::get().reset();
   vk::singleton<curl_async::CurlAdaptor>::get().reset();
+  vk::singleton<ThreadPool>::get().reset();
   vk::singleton<OomHandler>::get().reset();
   free_interface_lib();
   hard_reset_var(JsonEncoderError::msg);
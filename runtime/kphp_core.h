@@ -369,7 +369,12 @@ inline bool f$is_a(const class_instance<Base> &base) {
 
 template<class ClassInstanceDerived, class Base>
 inline ClassInstanceDerived f$instance_cast(const class_instance<Base> &base, const string &) {
-  return base.template cast_to<typename ClassInstanceDerived::ClassType>();
+  if constexpr (std::is_same<typename ClassInstanceDerived::ClassType, Base>{}) {
+    // e.g. in C++ virtual members dispatching virtual methods, a type is already known
+    return base;
+  } else {
+    return base.template cast_to<typename ClassInstanceDerived::ClassType>();
+  }
 }
 
 inline const char *get_type_c_str(bool);
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "common/algorithms/simd-numeric-kernels.h"
+
 #include "runtime/kphp_core.h"
 
 int64_t f$bindec(const string &number) noexcept;
@@ -142,6 +144,16 @@ T f$min(const array<T> &a) {
     php_warning("Empty array specified to function min");
     return T();
   }
+  if constexpr (std::is_same_v<T, int64_t>) {
+    if (a.is_vector()) {
+      return simd_min_int64(a.get_const_vector_pointer(), a.count());
+    }
+  }
+  if constexpr (std::is_same_v<T, double>) {
+    if (a.is_vector()) {
+      return simd_min_double(a.get_const_vector_pointer(), a.count());
+    }
+  }
 
   typename array<T>::const_iterator p = a.begin();
   T res = p.get_value();
@@ -159,6 +171,16 @@ T f$max(const array<T> &a) {
     php_warning("Empty array specified to function max");
     return T();
   }
+  if constexpr (std::is_same_v<T, int64_t>) {
+    if (a.is_vector()) {
+      return simd_max_int64(a.get_const_vector_pointer(), a.count());
+    }
+  }
+  if constexpr (std::is_same_v<T, double>) {
+    if (a.is_vector()) {
+      return simd_max_double(a.get_const_vector_pointer(), a.count());
+    }
+  }
 
   typename array<T>::const_iterator p = a.begin();
   T res = p.get_value();
@@ -4,6 +4,8 @@
 
 #include "runtime/mbstring.h"
 
+#include "common/algorithms/simd-string-kernels.h"
+#include "common/algorithms/simd-utf8.h"
 #include "common/unicode/unicode-utils.h"
 #include "common/unicode/utf8-utils.h"
 
@@ -53,81 +55,18 @@ static int mb_detect_encoding(const string &encoding) {
   return -1;
 }
 
-static int64_t mb_UTF8_strlen(const char *s) {
-  int64_t res = 0;
-  for (int64_t i = 0; s[i]; i++) {
-    if ((((unsigned char)s[i]) & 0xc0) != 0x80) {
-      res++;
-    }
-  }
-  return res;
+static int64_t mb_UTF8_strlen(const string &str) {
+  return simd_utf8_length(str.c_str(), str.size());
 }
 
-static int64_t mb_UTF8_advance(const char *s, int64_t cnt) {
+// returns the byte offset of the cnt-th character counting from the byte offset from
+static int64_t mb_UTF8_advance(const string &str, int64_t from, int64_t cnt) {
   php_assert (cnt >= 0);
-  int64_t i;
-  for (i = 0; s[i] && cnt >= 0; i++) {
-    if ((((unsigned char)s[i]) & 0xc0) != 0x80) {
-      cnt--;
-    }
-  }
-  if (cnt < 0) {
-    i--;
-  }
-  return i;
+  return from + simd_utf8_advance(str.c_str() + from, str.size() - from, cnt);
 }
 
-static int64_t mb_UTF8_get_offset(const char *s, int64_t pos) {
-  int64_t res = 0;
-  for (int64_t i = 0; i < pos && s[i]; i++) {
-    if ((((unsigned char)s[i]) & 0xc0) != 0x80) {
-      res++;
-    }
-  }
-  return res;
-}
-
-bool mb_UTF8_check(const char *s) {
-  do {
-#define CHECK(condition) if (!(condition)) {return false;}
-    unsigned int a = (unsigned char)(*s++);
-    if ((a & 0x80) == 0) {
-      if (a == 0) {
-        return true;
-      }
-      continue;
-    }
-
-    CHECK ((a & 0x40) != 0);
-
-    unsigned int b = (unsigned char)(*s++);
-    CHECK((b & 0xc0) == 0x80);
-    if ((a & 0x20) == 0) {
-      CHECK((a & 0x1e) > 0);
-      continue;
-    }
-
-    unsigned int c = (unsigned char)(*s++);
-    CHECK((c & 0xc0) == 0x80);
-    if ((a & 0x10) == 0) {
-      int x = (((a & 0x0f) << 6) | (b & 0x20));
-      CHECK(x != 0 && x != 0x360);//surrogates
-      continue;
-    }
-
-    unsigned int d = (unsigned char)(*s++);
-    CHECK((d & 0xc0) == 0x80);
-    if ((a & 0x08) == 0) {
-      int t = (((a & 0x07) << 6) | (b & 0x30));
-      CHECK(0 < t && t < 0x110);//end of unicode
-      continue;
-    }
-
-    return false;
-#undef CHECK
-  } while (true);
-
-  php_assert (0);
+bool mb_UTF8_check(const char *s, size_t len) {
+  return simd_utf8_validate(s, len);
 }
 
 bool f$mb_check_encoding(const string &str, const string &encoding) {
@@ -141,7 +80,7 @@ bool f$mb_check_encoding(const string &str, const string &encoding) {
     return true;
   }
 
-  return mb_UTF8_check(str.c_str());
+  return mb_UTF8_check(str.c_str(), str.size());
 }
 
 
@@ -156,7 +95,7 @@ int64_t f$mb_strlen(const string &str, const string &encoding) {
     return str.size();
   }
 
-  return mb_UTF8_strlen(str.c_str());
+  return mb_UTF8_strlen(str);
 }
 
 
@@ -209,16 +148,25 @@ string f$mb_strtolower(const string &str, const string &encoding) {
   } else {
     string res(len * 3, false);
     const char *s = str.c_str();
+    const char *s_end = s + len;
     int res_len = 0;
-    int p;
-    int ch;
-    while ((p = get_char_utf8(&ch, s)) > 0) {
+    while (s != s_end) {
+      // ASCII runs are converted by blocks, other characters go through the unicode tables
+      const size_t ascii_len = simd_ascii_tolower(s, &res[res_len], s_end - s);
+      s += ascii_len;
+      res_len += static_cast<int>(ascii_len);
+      if (s == s_end) {
+        break;
+      }
+      int ch;
+      const int p = get_char_utf8(&ch, s);
+      if (p <= 0) {
+        php_warning("Incorrect UTF-8 string \"%s\" in function mb_strtolower", str.c_str());
+        break;
+      }
       s += p;
       res_len += put_char_utf8(unicode_tolower(ch), &res[res_len]);
     }
-    if (p < 0) {
-      php_warning("Incorrect UTF-8 string \"%s\" in function mb_strtolower", str.c_str());
-    }
     res.shrink(res_len);
 
     return res;
@@ -279,16 +227,25 @@ string f$mb_strtoupper(const string &str, const string &encoding) {
   } else {
     string res(len * 3, false);
     const char *s = str.c_str();
+    const char *s_end = s + len;
     int res_len = 0;
-    int p;
-    int ch;
-    while ((p = get_char_utf8(&ch, s)) > 0) {
+    while (s != s_end) {
+      // ASCII runs are converted by blocks, other characters go through the unicode tables
+      const size_t ascii_len = simd_ascii_toupper(s, &res[res_len], s_end - s);
+      s += ascii_len;
+      res_len += static_cast<int>(ascii_len);
+      if (s == s_end) {
+        break;
+      }
+      int ch;
+      const int p = get_char_utf8(&ch, s);
+      if (p <= 0) {
+        php_warning("Incorrect UTF-8 string \"%s\" in function mb_strtoupper", str.c_str());
+        break;
+      }
       s += p;
       res_len += put_char_utf8(unicode_toupper(ch), &res[res_len]);
     }
-    if (p < 0) {
-      php_warning("Incorrect UTF-8 string \"%s\" in function mb_strtoupper", str.c_str());
-    }
     res.shrink(res_len);
 
     return res;
@@ -320,12 +277,12 @@ Optional<int64_t> mp_strpos_impl(const string &haystack, const string &needle, i
     return f$strpos(haystack, needle, offset);
   }
 
-  int64_t UTF8_offset = mb_UTF8_advance(haystack.c_str(), offset);
+  int64_t UTF8_offset = mb_UTF8_advance(haystack, 0, offset);
   const char *s = static_cast<const char *>(memmem(haystack.c_str() + UTF8_offset, haystack.size() - UTF8_offset, needle.c_str(), needle.size()));
   if (unlikely(s == nullptr)) {
     return false;
   }
-  return mb_UTF8_get_offset(haystack.c_str() + UTF8_offset, s - (haystack.c_str() + UTF8_offset)) + offset;
+  return static_cast<int64_t>(simd_utf8_length(haystack.c_str() + UTF8_offset, s - (haystack.c_str() + UTF8_offset))) + offset;
 }
 
 } // namespace
@@ -366,7 +323,7 @@ string f$mb_substr(const string &str, int64_t start, const mixed &length_var, co
     return res.val();
   }
 
-  int64_t len = mb_UTF8_strlen(str.c_str());
+  int64_t len = mb_UTF8_strlen(str);
   if (start < 0) {
     start += len;
   }
@@ -383,8 +340,8 @@ string f$mb_substr(const string &str, int64_t start, const mixed &length_var, co
     length = len - start;
   }
 
-  int64_t UTF8_start = mb_UTF8_advance(str.c_str(), start);
-  int64_t UTF8_length = mb_UTF8_advance(str.c_str() + UTF8_start, length);
+  int64_t UTF8_start = mb_UTF8_advance(str, 0, start);
+  int64_t UTF8_end = mb_UTF8_advance(str, UTF8_start, length);
 
-  return {str.c_str() + UTF8_start, static_cast<string::size_type>(UTF8_length)};
+  return {str.c_str() + UTF8_start, static_cast<string::size_type>(UTF8_end - UTF8_start)};
 }
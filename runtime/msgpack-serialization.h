@@ -5,6 +5,7 @@
 #pragma once
 
 #include "runtime/msgpack/adaptors.h"
+#include "runtime/msgpack/direct_unpacker.h"
 #include "runtime/msgpack/packer.h"
 #include "runtime/msgpack/unpacker.h"
 #include "runtime/msgpack/unpack_exception.h"
@@ -104,6 +105,16 @@ inline ResultType f$msgpack_deserialize(const string &buffer, string *out_err_ms
   }
 
   const auto malloc_replacement_guard = make_malloc_replacement_with_script_allocator();
+  try {
+    vk::msgpack::direct_unpacker direct_unpacker{buffer};
+    auto result = direct_unpacker.template unpack<ResultType>();
+    if (direct_unpacker.is_finished()) {
+      return result;
+    }
+  } catch (...) {
+    // the buffer is malformed or doesn't match ResultType: unpack it again through the object tree to get the error message
+  }
+
   string err_msg;
   try {
     vk::msgpack::unpacker unpacker{buffer};
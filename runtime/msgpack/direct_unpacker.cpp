@@ -0,0 +1,201 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/msgpack/direct_unpacker.h"
+
+#include <cstring>
+
+#include "runtime/msgpack/sysdep.h"
+
+namespace vk::msgpack {
+
+namespace {
+
+template<typename T>
+T load_be(const char *p) noexcept {
+  T res;
+  if constexpr (sizeof(T) == 1) {
+    std::memcpy(&res, p, 1);
+  } else if constexpr (sizeof(T) == 2) {
+    _msgpack_load16(T, p, &res);
+  } else if constexpr (sizeof(T) == 4) {
+    _msgpack_load32(T, p, &res);
+  } else {
+    _msgpack_load64(T, p, &res);
+  }
+  return res;
+}
+
+msgpack::object make_integer(int64_t v) noexcept {
+  msgpack::object obj;
+  if (v >= 0) {
+    obj.type = stored_type::POSITIVE_INTEGER;
+    obj.via.u64 = static_cast<uint64_t>(v);
+  } else {
+    obj.type = stored_type::NEGATIVE_INTEGER;
+    obj.via.i64 = v;
+  }
+  return obj;
+}
+
+msgpack::object make_unsigned(uint64_t v) noexcept {
+  msgpack::object obj;
+  obj.type = stored_type::POSITIVE_INTEGER;
+  obj.via.u64 = v;
+  return obj;
+}
+
+} // namespace
+
+const char *direct_unpacker::consume(size_t len) {
+  if (static_cast<size_t>(end_ - pos_) < len) {
+    throw msgpack::insufficient_bytes("insufficient bytes");
+  }
+  const char *res = pos_;
+  pos_ += len;
+  return res;
+}
+
+msgpack::object direct_unpacker::unpack_header() {
+  const auto selector = static_cast<uint8_t>(*consume(1));
+  msgpack::object obj;
+
+  auto set_str = [this, &obj](uint32_t size) {
+    obj.type = stored_type::STR;
+    obj.via.str.size = size;
+    obj.via.str.ptr = consume(size);
+  };
+  auto set_array = [&obj](uint32_t size) {
+    obj.type = stored_type::ARRAY;
+    obj.via.array.size = size;
+    obj.via.array.ptr = nullptr;
+  };
+  auto set_map = [&obj](uint32_t size) {
+    obj.type = stored_type::MAP;
+    obj.via.map.size = size;
+    obj.via.map.ptr = nullptr;
+  };
+
+  if (selector <= 0x7f) {
+    return make_unsigned(selector);
+  }
+  if (selector >= 0xe0) {
+    return make_integer(static_cast<int8_t>(selector));
+  }
+  if (selector >= 0xa0 && selector <= 0xbf) {
+    set_str(selector & 0x1f);
+    return obj;
+  }
+  if (selector >= 0x90 && selector <= 0x9f) {
+    set_array(selector & 0x0f);
+    return obj;
+  }
+  if (selector <= 0x8f) {
+    set_map(selector & 0x0f);
+    return obj;
+  }
+
+  switch (selector) {
+    case 0xc0:
+      obj.type = stored_type::NIL;
+      return obj;
+    case 0xc2:
+    case 0xc3:
+      obj.type = stored_type::BOOLEAN;
+      obj.via.boolean = selector == 0xc3;
+      return obj;
+    case 0xca: {
+      union {
+        uint32_t i;
+        float f;
+      } mem;
+      mem.i = load_be<uint32_t>(consume(4));
+      obj.type = stored_type::FLOAT32;
+      obj.via.f64 = mem.f;
+      return obj;
+    }
+    case 0xcb: {
+      union {
+        uint64_t i;
+        double f;
+      } mem;
+      mem.i = load_be<uint64_t>(consume(8));
+      obj.type = stored_type::FLOAT64;
+      obj.via.f64 = mem.f;
+      return obj;
+    }
+    case 0xcc:
+      return make_unsigned(load_be<uint8_t>(consume(1)));
+    case 0xcd:
+      return make_unsigned(load_be<uint16_t>(consume(2)));
+    case 0xce:
+      return make_unsigned(load_be<uint32_t>(consume(4)));
+    case 0xcf:
+      return make_unsigned(load_be<uint64_t>(consume(8)));
+    case 0xd0:
+      return make_integer(load_be<int8_t>(consume(1)));
+    case 0xd1:
+      return make_integer(load_be<int16_t>(consume(2)));
+    case 0xd2:
+      return make_integer(load_be<int32_t>(consume(4)));
+    case 0xd3:
+      return make_integer(load_be<int64_t>(consume(8)));
+    case 0xd9:
+      set_str(load_be<uint8_t>(consume(1)));
+      return obj;
+    case 0xda:
+      set_str(load_be<uint16_t>(consume(2)));
+      return obj;
+    case 0xdb:
+      set_str(load_be<uint32_t>(consume(4)));
+      return obj;
+    case 0xdc:
+      set_array(load_be<uint16_t>(consume(2)));
+      return obj;
+    case 0xdd:
+      set_array(load_be<uint32_t>(consume(4)));
+      return obj;
+    case 0xde:
+      set_map(load_be<uint16_t>(consume(2)));
+      return obj;
+    case 0xdf:
+      set_map(load_be<uint32_t>(consume(4)));
+      return obj;
+    default:
+      // bin and ext types are not supported, as in the parser
+      throw msgpack::parse_error("parse error");
+  }
+}
+
+void direct_unpacker::skip() {
+  uint64_t rest = 1;
+  while (rest != 0) {
+    --rest;
+    const msgpack::object header = unpack_header();
+    if (header.type == stored_type::ARRAY) {
+      rest += header.via.array.size;
+    } else if (header.type == stored_type::MAP) {
+      rest += 2 * static_cast<uint64_t>(header.via.map.size);
+    }
+  }
+}
+
+uint32_t direct_unpacker::unpack_instance_fields_count(const msgpack::object &header) {
+  if (header.type != stored_type::ARRAY) {
+    throw type_error{};
+  }
+  if (header.via.array.size % 2 != 0) {
+    throw msgpack::unpack_error("expected pairs of tags and fields in instance unpacking");
+  }
+  check_values_count(header.via.array.size);
+  return header.via.array.size / 2;
+}
+
+void direct_unpacker::check_values_count(uint64_t count) const {
+  if (static_cast<uint64_t>(end_ - pos_) < count) {
+    throw msgpack::insufficient_bytes("insufficient bytes");
+  }
+}
+
+} // namespace vk::msgpack
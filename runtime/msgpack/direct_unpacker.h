@@ -0,0 +1,201 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "common/mixin/not_copyable.h"
+#include "runtime/kphp_core.h"
+#include "runtime/msgpack/adaptors.h"
+#include "runtime/msgpack/object.h"
+#include "runtime/msgpack/unpack_exception.h"
+
+namespace vk::msgpack {
+
+namespace adaptor {
+
+template<typename T>
+struct direct_convert;
+
+} // namespace adaptor
+
+// Unpacks values right from the input without building the msgpack::object tree in a zone like unpacker does.
+// Every value starts with a header that is read into msgpack::object without children:
+// scalars are converted by the same adaptor::convert as in unpacker, container elements are read from the input one by one.
+// Errors are reported by exceptions without details, the caller is expected to repeat unpacking with unpacker to get the error message.
+class direct_unpacker : private vk::not_copyable {
+public:
+  explicit direct_unpacker(const string &input) noexcept
+    : pos_(input.c_str())
+    , end_(input.c_str() + input.size()) {}
+
+  template<typename T>
+  void unpack(T &v) {
+    adaptor::direct_convert<T>{}(*this, unpack_header(), v);
+  }
+
+  template<typename T>
+  T unpack() {
+    T v;
+    unpack(v);
+    return v;
+  }
+
+  // strings of the returned object point to the input; for arrays and maps only sizes are filled, their elements follow
+  msgpack::object unpack_header();
+  void skip();
+
+  // checks the header of an instance packed as [tag_1, field_1, ..., tag_n, field_n] and returns the number of fields
+  uint32_t unpack_instance_fields_count(const msgpack::object &header);
+
+  // each value takes at least 1 byte, so huge sizes of truncated containers are rejected before any allocation
+  void check_values_count(uint64_t count) const;
+
+  bool is_finished() const noexcept {
+    return pos_ == end_;
+  }
+
+private:
+  const char *consume(size_t len);
+
+  const char *pos_;
+  const char *end_;
+};
+
+namespace adaptor {
+
+template<typename T, typename = void>
+struct has_direct_msgpack_unpack : std::false_type {};
+
+template<typename T>
+struct has_direct_msgpack_unpack<T, std::void_t<decltype(std::declval<T &>().msgpack_unpack(std::declval<direct_unpacker &>(), std::declval<const msgpack::object &>()))>>
+  : std::true_type {};
+
+template<typename T>
+struct direct_convert {
+  void operator()(direct_unpacker &unpacker, const msgpack::object &header, T &v) const {
+    if constexpr (has_direct_msgpack_unpack<T>::value) {
+      v.msgpack_unpack(unpacker, header);
+    } else {
+      // scalars only, their headers are complete objects
+      if (header.type == stored_type::ARRAY || header.type == stored_type::MAP) {
+        throw type_error{};
+      }
+      header.convert(v);
+    }
+  }
+};
+
+template<class T>
+struct direct_convert<array<T>> {
+  void operator()(direct_unpacker &unpacker, const msgpack::object &header, array<T> &res_arr) const {
+    if (header.type == stored_type::ARRAY) {
+      const uint32_t size = header.via.array.size;
+      unpacker.check_values_count(size);
+      res_arr.reserve(size, true);
+      for (uint32_t i = 0; i < size; ++i) {
+        res_arr.set_value(static_cast<int64_t>(i), unpacker.unpack<T>());
+      }
+      return;
+    }
+
+    if (header.type == stored_type::MAP) {
+      const uint32_t size = header.via.map.size;
+      unpacker.check_values_count(2 * static_cast<uint64_t>(size));
+      res_arr.reserve(size, false);
+      for (uint32_t i = 0; i < size; ++i) {
+        const msgpack::object key = unpacker.unpack_header();
+        switch (key.type) {
+          case stored_type::POSITIVE_INTEGER:
+          case stored_type::NEGATIVE_INTEGER: {
+            const auto key_php = key.as<int64_t>();
+            res_arr.set_value(key_php, unpacker.unpack<T>());
+            break;
+          }
+          case stored_type::STR: {
+            const auto &key_php = key.as<string>();
+            res_arr.set_value(key_php, unpacker.unpack<T>());
+            break;
+          }
+          default:
+            throw msgpack::unpack_error("expected string or integer in array unpacking");
+        }
+      }
+      return;
+    }
+
+    throw msgpack::unpack_error("couldn't recognize type of unpacking array");
+  }
+};
+
+template<class T>
+struct direct_convert<class_instance<T>> {
+  void operator()(direct_unpacker &unpacker, const msgpack::object &header, class_instance<T> &instance) const {
+    switch (header.type) {
+      case stored_type::NIL:
+        instance = class_instance<T>{};
+        break;
+      case stored_type::ARRAY:
+        instance = class_instance<T>{}.alloc();
+        direct_convert<T>{}(unpacker, header, *instance.get());
+        break;
+      default:
+        throw msgpack::unpack_error("Expected NIL or ARRAY type for unpacking class_instance");
+    }
+  }
+};
+
+template<typename... Args>
+struct direct_convert<std::tuple<Args...>> {
+  void operator()(direct_unpacker &unpacker, const msgpack::object &header, std::tuple<Args...> &v) const {
+    if (header.type != stored_type::ARRAY) {
+      throw type_error{};
+    }
+    // as with unpacker, missing elements are left untouched and extra elements are ignored
+    const uint32_t size = header.via.array.size;
+    unpack_elements(unpacker, size, v, std::index_sequence_for<Args...>{});
+    for (uint32_t i = sizeof...(Args); i < size; ++i) {
+      unpacker.skip();
+    }
+  }
+
+private:
+  template<size_t... Is>
+  static void unpack_elements(direct_unpacker &unpacker, uint32_t size, std::tuple<Args...> &v, std::index_sequence<Is...>) {
+    ((Is < size ? unpacker.unpack(std::get<Is>(v)) : void()), ...);
+  }
+};
+
+template<class T>
+struct direct_convert<Optional<T>> {
+  void operator()(direct_unpacker &unpacker, const msgpack::object &header, Optional<T> &v) const {
+    if (header.type == stored_type::BOOLEAN || header.type == stored_type::NIL) {
+      header.convert(v);
+      return;
+    }
+    T value;
+    direct_convert<T>{}(unpacker, header, value);
+    v = std::move(value);
+  }
+};
+
+template<>
+struct direct_convert<mixed> {
+  void operator()(direct_unpacker &unpacker, const msgpack::object &header, mixed &v) const {
+    if (header.type == stored_type::ARRAY || header.type == stored_type::MAP) {
+      array<mixed> arr;
+      direct_convert<array<mixed>>{}(unpacker, header, arr);
+      v = std::move(arr);
+      return;
+    }
+    header.convert(v);
+  }
+};
+
+} // namespace adaptor
+
+} // namespace vk::msgpack
@@ -11,6 +11,7 @@
 #include "runtime/curl.h"
 #include "runtime/job-workers/job-interface.h"
 #include "runtime/rpc.h"
+#include "runtime/thread-pool.h"
 #include "server/curl-adaptor.h"
 #include "server/database-drivers/adaptor.h"
 #include "server/database-drivers/response.h"
@@ -61,6 +62,9 @@ bool process_net_event(net_event_t *e) {
      [&](curl_async::CurlResponse *response) {
          php_assert(e->slot_id == response->bound_request_id);
          vk::singleton<curl_async::CurlAdaptor>::get().process_response_event(std::unique_ptr<curl_async::CurlResponse>(response));
+     },
+     [&](const net_events_data::thread_pool_task_finished &) {
+         vk::singleton<ThreadPool>::get().process_finished_task(e->slot_id);
      }
     }, e->data);
 
@@ -6,6 +6,8 @@
 
 #include <cerrno>
 #include <memory>
+#include <string>
+#include <vector>
 #include <netdb.h>
 #include <openssl/asn1.h>
 #include <openssl/err.h>
@@ -35,6 +37,7 @@
 #include "runtime/net_events.h"
 #include "runtime/streams.h"
 #include "runtime/string_functions.h"
+#include "runtime/thread-pool.h"
 #include "runtime/url.h"
 
 namespace {
@@ -79,6 +82,35 @@ public:
       php_assert (md_len == hash_len);
     });
   }
+
+  string from_digest(const unsigned char *digest, bool raw_output) const noexcept {
+    return call_hash_algo(raw_output, [this, digest](string &out) {
+      memcpy(out.buffer(), digest, hash_len);
+    });
+  }
+};
+
+class HashTask final : public ThreadPoolTaskWithResult<string> {
+public:
+  HashTask(const HashTraits &traits, const string &s, bool raw_output)
+    : traits_(traits)
+    , data_(s.c_str(), s.size())
+    , digest_(traits.hash_len, 0)
+    , raw_output_(raw_output) {}
+
+  void run() noexcept final {
+    traits_.algo_function(reinterpret_cast<const unsigned char *>(data_.data()), data_.size(), digest_.data());
+  }
+
+  string make_result() noexcept final {
+    return traits_.from_digest(digest_.data(), raw_output_);
+  }
+
+private:
+  const HashTraits &traits_;
+  std::string data_;
+  std::vector<unsigned char> digest_;
+  bool raw_output_;
 };
 
 HashTraits make_sha1_traits() noexcept {
@@ -131,6 +163,12 @@ string f$hash(const string &algo, const string &s, bool raw_output) noexcept {
   return find_hash_algorithm(algo.c_str()).hash(s, raw_output);
 }
 
+int64_t f$thread_pool_hash(const string &algo, const string &s, bool raw_output) noexcept {
+  const HashTraits &hash_traits = find_hash_algorithm(algo.c_str());
+  dl::CriticalSectionGuard critical_section;
+  return start_thread_pool_task<string>(std::make_unique<HashTask>(hash_traits, s, raw_output));
+}
+
 string f$hash_hmac(const string &algo, const string &data, const string &key, bool raw_output) noexcept {
   return find_hash_algorithm(algo.c_str()).hash_hmac(data, key, raw_output);
 }
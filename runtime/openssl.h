@@ -27,6 +27,9 @@ array<string> f$hash_hmac_algos() noexcept;
 
 string f$hash(const string &algo, const string &s, bool raw_output = false) noexcept;
 
+// returns a future of the hash, which is calculated in the thread pool
+int64_t f$thread_pool_hash(const string &algo, const string &s, bool raw_output = false) noexcept;
+
 string f$hash_hmac(const string &algo, const string &data, const string &key, bool raw_output = false) noexcept;
 
 string f$sha1(const string &s, bool raw_output = false) noexcept;
@@ -479,7 +479,7 @@ void regexp::init(const char *regexp_string, int64_t regexp_len, const char *fun
 
   can_use_RE2 = can_use_RE2 && is_valid_RE2_regexp(static_SB.c_str(), static_SB.size(), is_utf8, function, file);
 
-  if (is_utf8 && !mb_UTF8_check(static_SB.c_str())) {
+  if (is_utf8 && !mb_UTF8_check(static_SB.c_str(), static_SB.size())) {
     pattern_compilation_warning(function, file, "Regexp \"%s\" contains not UTF-8 symbols", static_SB.c_str());
     clean();
     return;
@@ -674,7 +674,7 @@ Optional<int64_t> regexp::match(const string &subject, bool all_matches) const {
     return false;
   }
 
-  if (is_utf8 && !mb_UTF8_check(subject.c_str())) {
+  if (is_utf8 && !mb_UTF8_check(subject.c_str(), subject.size())) {
     pcre_last_error = PCRE_ERROR_BADUTF8;
     return false;
   }
@@ -748,7 +748,7 @@ Optional<int64_t> regexp::match(const string &subject, mixed &matches, bool all_
     pcre_last_error = PCRE_ERROR_BADUTF8_OFFSET;
     return false;
   }
-  if (is_utf8 && !mb_UTF8_check(subject.c_str())) {
+  if (is_utf8 && !mb_UTF8_check(subject.c_str(), subject.size())) {
     matches = array<mixed>{};
     pcre_last_error = PCRE_ERROR_BADUTF8;
     return false;
@@ -869,7 +869,7 @@ Optional<int64_t> regexp::match(const string &subject, mixed &matches, int64_t f
     pcre_last_error = PCRE_ERROR_BADUTF8_OFFSET;
     return false;
   }
-  if (is_utf8 && !mb_UTF8_check(subject.c_str())) {
+  if (is_utf8 && !mb_UTF8_check(subject.c_str(), subject.size())) {
     matches = array<mixed>{};
     pcre_last_error = PCRE_ERROR_BADUTF8;
     return false;
@@ -966,7 +966,7 @@ Optional<array<mixed>> regexp::split(const string &subject, int64_t limit, int64
     return false;
   }
 
-  if (is_utf8 && !mb_UTF8_check(subject.c_str())) {
+  if (is_utf8 && !mb_UTF8_check(subject.c_str(), subject.size())) {
     pcre_last_error = PCRE_ERROR_BADUTF8;
     return false;
   }
@@ -281,7 +281,7 @@ Optional<string> regexp::replace(const T &replace_val, const string &subject, in
     return {};
   }
 
-  if (is_utf8 && !mb_UTF8_check(subject.c_str())) {
+  if (is_utf8 && !mb_UTF8_check(subject.c_str(), subject.size())) {
     pcre_last_error = PCRE_ERROR_BADUTF8;
     return {};
   }
@@ -7,6 +7,7 @@
 #include <cstdarg>
 #include <chrono>
 
+#include "common/algorithms/simd-numeric-kernels.h"
 #include "common/rpc-error-codes.h"
 #include "common/rpc-headers.h"
 #include "common/tl/constants/common.h"
@@ -222,6 +223,13 @@ string f$fetch_lookup_data(int64_t x4_bytes_length) {
                 static_cast<string::size_type>(x4_bytes_length * 4)};
 }
 
+string rpc_fetch_rest() {
+  string rest{reinterpret_cast<const char *>(rpc_data), static_cast<string::size_type>(rpc_data_len * sizeof(int32_t))};
+  rpc_data += rpc_data_len;
+  rpc_data_len = 0;
+  return rest;
+}
+
 int64_t f$fetch_long() {
   TRY_CALL_VOID(int64_t, (check_rpc_data_len(2)));
   long long result = *reinterpret_cast<const long long *>(rpc_data);
@@ -253,6 +261,21 @@ void f$fetch_raw_vector_double(array<double> &out, int64_t n_elems) {
   rpc_data += rpc_data_buf_offset;
 }
 
+void fetch_raw_vector_long(array<int64_t> &out, int64_t n_elems) {
+  TRY_CALL_VOID(void, (check_rpc_data_len(n_elems * 2)));
+  out.memcpy_vector(n_elems, rpc_data);
+  rpc_data += n_elems * 2;
+}
+
+void fetch_raw_vector_int(array<int64_t> &out, int64_t n_elems) {
+  TRY_CALL_VOID(void, (check_rpc_data_len(n_elems)));
+  if (n_elems) {
+    out.fill_vector(n_elems, 0);
+    simd_widen_int32_to_int64(rpc_data, n_elems, out.get_vector_pointer());
+    rpc_data += n_elems;
+  }
+}
+
 static inline const char *f$fetch_string_raw(int *string_len) {
   TRY_CALL_VOID_(check_rpc_data_len(1), return nullptr);
   const char *str = reinterpret_cast <const char *> (rpc_data);
@@ -352,6 +375,48 @@ class_instance<C$RpcConnection> f$new_rpc_connection(const string &host_name, in
                                         timeout_convert_to_ms(connect_timeout), timeout_convert_to_ms(reconnect_timeout));
 }
 
+class_instance<C$RpcConnection> f$new_rpc_connection_group(const array<string> &addresses, const mixed &actor_id, double timeout, double connect_timeout, double reconnect_timeout) {
+  if (addresses.empty()) {
+    php_warning("Can't create RPC connection group without addresses");
+    return {};
+  }
+
+  array<int64_t> host_nums{array_size(addresses.count(), true)};
+  int32_t first_port = -1;
+  for (const auto &it : addresses) {
+    const string &address = it.get_value();
+    // the port is after the last colon, the host is a name or an IPv4 address
+    string::size_type port_begin = address.size();
+    while (port_begin != 0 && address[port_begin - 1] != ':') {
+      --port_begin;
+    }
+    int64_t port = 0;
+    if (port_begin == 0 || !php_try_to_int(address.c_str() + port_begin, address.size() - port_begin, &port) || port <= 0 || port >= 65536) {
+      php_warning("Wrong RPC address \"%s\" in connection group, \"host:port\" is expected", address.c_str());
+      return {};
+    }
+    const string host_name = address.substr(0, port_begin - 1);
+    const int32_t host_num = rpc_connect_to(host_name.c_str(), static_cast<int32_t>(port));
+    if (host_num < 0) {
+      return {};
+    }
+    if (first_port == -1) {
+      first_port = static_cast<int32_t>(port);
+    }
+    host_nums.push_back(host_num);
+  }
+
+  const int32_t group_host_num = rpc_connect_to_group(host_nums.get_const_vector_pointer(), host_nums.count());
+  if (group_host_num < 0) {
+    php_warning("Can't create RPC connection group");
+    return {};
+  }
+
+  return make_instance<C$RpcConnection>(group_host_num, first_port, timeout_convert_to_ms(timeout),
+                                        store_parse_number<int32_t>(actor_id),
+                                        timeout_convert_to_ms(connect_timeout), timeout_convert_to_ms(reconnect_timeout));
+}
+
 static string_buffer data_buf;
 
 bool rpc_stored;
@@ -414,6 +479,26 @@ void f$store_raw_vector_double(const array<double> &vector) {
                   sizeof(double) * vector.count());
 }
 
+void store_raw_vector_long(const array<int64_t> &vector) {
+  data_buf.append(reinterpret_cast<const char *>(vector.get_const_vector_pointer()),
+                  sizeof(int64_t) * vector.count());
+}
+
+bool store_raw_vector_int(const array<int64_t> &vector) {
+  const int64_t n_elems = vector.count();
+  const string::size_type pos = data_buf.size();
+  data_buf.reserve(static_cast<int>(sizeof(int32_t) * n_elems));
+  if (unlikely(string_buffer::string_buffer_error_flag == STRING_BUFFER_ERROR_FLAG_FAILED)) {
+    return true;
+  }
+  auto *dst = reinterpret_cast<int32_t *>(data_buf.buffer() + pos);
+  if (simd_narrow_int64_to_int32(vector.get_const_vector_pointer(), n_elems, dst) != n_elems) {
+    return false;
+  }
+  data_buf.set_pos(pos + sizeof(int32_t) * n_elems);
+  return true;
+}
+
 bool store_header(long long cluster_id, int64_t flags) {
   if (flags) {
     store_int(TL_RPC_DEST_ACTOR_FLAGS);
@@ -1085,8 +1170,9 @@ class_instance<RpcTlQuery> store_function(const mixed &tl_object) {
     CurrentProcessingQuery::get().raise_storing_error("Not an array passed to function rpc_tl_query");
     return {};
   }
-  string fun_name = tl_arr_get(tl_object, tl_str_underscore, 0).to_string();
-  if (!tl_storers_ht.has_key(fun_name)) {
+  string fun_name = tl_arr_get(tl_object, tl_str_underscore, 0, tl_str_underscore_hash).to_string();
+  const tl_storer_ptr *untyped_storer = tl_storers_ht.find_value(fun_name);
+  if (!untyped_storer) {
     CurrentProcessingQuery::get().raise_storing_error("Function \"%s\" not found in tl-scheme", fun_name.c_str());
     return {};
   }
@@ -1094,8 +1180,7 @@ class_instance<RpcTlQuery> store_function(const mixed &tl_object) {
   rpc_query.alloc();
   rpc_query.get()->tl_function_name = fun_name;
   CurrentProcessingQuery::get().set_current_tl_function(fun_name);
-  const auto &untyped_storer = tl_storers_ht.get_value(fun_name);
-  rpc_query.get()->result_fetcher = make_unique_on_script_memory<RpcRequestResultUntyped>(untyped_storer(tl_object));
+  rpc_query.get()->result_fetcher = make_unique_on_script_memory<RpcRequestResultUntyped>((*untyped_storer)(tl_object));
   CurrentProcessingQuery::get().reset();
   return rpc_query;
 }
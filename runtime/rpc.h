@@ -82,6 +82,8 @@ int64_t f$fetch_int();
 
 int64_t f$fetch_lookup_int();
 string f$fetch_lookup_data(int64_t x4_bytes_length);
+// fetches all the data left
+string rpc_fetch_rest();
 
 int64_t f$fetch_long();
 
@@ -100,6 +102,9 @@ bool f$fetch_eof();
 bool f$fetch_end();
 
 void f$fetch_raw_vector_double(array<double> &out, int64_t n_elems);
+void fetch_raw_vector_long(array<int64_t> &out, int64_t n_elems);
+// widens TL ints
+void fetch_raw_vector_int(array<int64_t> &out, int64_t n_elems);
 
 void estimate_and_flush_overflow(size_t &bytes_sent);
 
@@ -150,6 +155,9 @@ struct C$RpcConnection final : public refcountable_php_classes<C$RpcConnection>,
 
 class_instance<C$RpcConnection> f$new_rpc_connection(const string &host_name, int64_t port, const mixed &actor_id = 0, double timeout = 0.3, double connect_timeout = 0.3, double reconnect_timeout = 17);
 
+// addresses are "host:port" of replicas, each query goes to the least loaded healthy one
+class_instance<C$RpcConnection> f$new_rpc_connection_group(const array<string> &addresses, const mixed &actor_id = 0, double timeout = 0.3, double connect_timeout = 0.3, double reconnect_timeout = 17);
+
 void f$store_gzip_pack_threshold(int64_t pack_threshold_bytes);
 
 void f$store_start_gzip_pack();
@@ -163,6 +171,9 @@ bool f$store_error(int64_t error_code, const string &error_text);
 bool f$store_raw(const string &data);
 
 void f$store_raw_vector_double(const array<double> &vector);
+void store_raw_vector_long(const array<int64_t> &vector);
+// stores nothing and returns false if some element overflows TL int, see is_int32_overflow()
+bool store_raw_vector_int(const array<int64_t> &vector);
 
 bool f$set_fail_rpc_on_int32_overflow(bool fail_rpc); // TODO: remove when all RPC errors will be fixed
 
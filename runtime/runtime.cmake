@@ -17,6 +17,7 @@ prepend(KPHP_RUNTIME_MEMORY_RESOURCE_SOURCES memory_resource/
 
 prepend(KPHP_RUNTIME_MSGPACK_SOURCES msgpack/
         check_instance_depth.cpp
+        direct_unpacker.cpp
         object_visitor.cpp
         packer.cpp
         parser.cpp
@@ -103,6 +104,7 @@ prepend(KPHP_RUNTIME_SOURCES ${BASE_DIR}/runtime/
         serialize-functions.cpp
         storage.cpp
         streams.cpp
+        string-replace-trie.cpp
         string.cpp
         string_buffer.cpp
         string_cache.cpp
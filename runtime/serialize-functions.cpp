@@ -4,6 +4,9 @@
 
 #include "runtime/serialize-functions.h"
 
+#include <algorithm>
+#include <cstring>
+
 void impl_::PhpSerializer::serialize(bool b) noexcept {
   static_SB.reserve(4);
   static_SB.append_char('b');
@@ -65,7 +68,42 @@ void impl_::PhpSerializer::serialize(const mixed &v) noexcept {
 
 namespace {
 
-int do_unserialize(const char *s, int s_len, mixed &out_var_value) noexcept {
+// Creates strings of one unserialize call: short strings are looked up in the constant caches first
+// and then in a small table of already created ones, so repeated keys of similar arrays share one allocation
+class UnserializeStrings : vk::not_copyable {
+public:
+  string make(const char *s, uint32_t len) noexcept {
+    if (len <= 1) {
+      return string{s, len};
+    }
+    if (len <= 4 && s[0] != '0') {
+      int64_t number = 0;
+      uint32_t i = 0;
+      for (; i < len && '0' <= s[i] && s[i] <= '9'; ++i) {
+        number = number * 10 + s[i] - '0';
+      }
+      if (i == len) {
+        return string{number};
+      }
+    }
+    if (len > MAX_INTERNED_LENGTH) {
+      return string{s, len};
+    }
+    string &interned = interned_[static_cast<uint64_t>(string_hash(s, len)) % INTERNED_COUNT];
+    if (interned.size() != len || std::memcmp(interned.c_str(), s, len) != 0) {
+      interned = string{s, len};
+    }
+    return interned;
+  }
+
+private:
+  static constexpr uint32_t MAX_INTERNED_LENGTH = 32;
+  static constexpr size_t INTERNED_COUNT = 64;
+
+  string interned_[INTERNED_COUNT];
+};
+
+int do_unserialize(const char *s, int s_len, mixed &out_var_value, UnserializeStrings &strings) noexcept {
   if (!out_var_value.is_null()) {
     out_var_value = mixed{};
   }
@@ -134,7 +172,7 @@ int do_unserialize(const char *s, int s_len, mixed &out_var_value) noexcept {
           s += j + 2;
 
           if (s[len] == '"' && s[len + 1] == ';') {
-            out_var_value = mixed(s, len);
+            out_var_value = strings.make(s, len);
             return len + 6 + j;
           }
         }
@@ -153,9 +191,12 @@ int do_unserialize(const char *s, int s_len, mixed &out_var_value) noexcept {
           s += j + 2;
           s_len -= j + 4;
 
-          array_size size(len, false);
+          // the declared count gives the final size, but every element takes at least 6 bytes ("i:0;N;"),
+          // so a broken count can't make us allocate more than the payload justifies
+          const int size_hint = std::min(len, std::max(s_len, 0) / 6);
+          array_size size(size_hint, false);
           if (s[0] == 'i') {//try to cheat
-            size = array_size(len, s[1] == ':' && s[2] == '0' && s[3] == ';');
+            size = array_size(size_hint, s[1] == ':' && s[2] == '0' && s[3] == ';');
           }
           array<mixed> res(size);
 
@@ -169,7 +210,7 @@ int do_unserialize(const char *s, int s_len, mixed &out_var_value) noexcept {
                   if (php_try_to_int(s, k, &intval)) {
                     s += k + 1;
                     s_len -= k + 3;
-                    int length = do_unserialize(s, s_len, res[intval]);
+                    int length = do_unserialize(s, s_len, res[intval], strings);
                     if (!length) {
                       return 0;
                     }
@@ -189,7 +230,7 @@ int do_unserialize(const char *s, int s_len, mixed &out_var_value) noexcept {
                     string key(s, k);
                     s += k + 1;
                     s_len -= k + 3;
-                    int length = do_unserialize(s, s_len, res[key]);
+                    int length = do_unserialize(s, s_len, res[key], strings);
                     if (!length) {
                       return 0;
                     }
@@ -212,15 +253,17 @@ int do_unserialize(const char *s, int s_len, mixed &out_var_value) noexcept {
                 s += k + 2;
 
                 if (s[str_len] == '"' && s[str_len + 1] == ';') {
-                  string key(s, str_len);
+                  const string key = strings.make(s, str_len);
                   s += str_len + 2;
                   s_len -= str_len + 6 + k;
-                  int length = do_unserialize(s, s_len, res[key]);
+                  int length = do_unserialize(s, s_len, res[key], strings);
                   if (!length) {
                     return 0;
                   }
                   s += length;
                   s_len -= length;
+                } else {
+                  return 0;
                 }
               } else {
                 return 0;
@@ -245,8 +288,9 @@ int do_unserialize(const char *s, int s_len, mixed &out_var_value) noexcept {
 
 mixed unserialize_raw(const char *v, int32_t v_len) noexcept {
   mixed result;
+  UnserializeStrings strings;
 
-  if (do_unserialize(v, v_len, result) == v_len) {
+  if (do_unserialize(v, v_len, result, strings) == v_len) {
     return result;
   }
 
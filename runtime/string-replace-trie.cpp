@@ -0,0 +1,380 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/string-replace-trie.h"
+
+#include <algorithm>
+#include <bitset>
+
+#include "common/algorithms/simd-string-kernels.h"
+
+#include "runtime/allocator.h"
+#include "runtime/critical_section.h"
+
+ReplaceTrie::ReplaceTrie(int32_t needles_count, size_t needles_total_len, size_t replacements_total_len, bool use_heap_memory) noexcept:
+  use_heap_memory_(use_heap_memory),
+  needles_capacity_(needles_count),
+  nodes_capacity_(needles_total_len + 1),
+  data_capacity_(needles_total_len + replacements_total_len) {
+  nodes_ = static_cast<Node *>(allocate(sizeof(Node) * nodes_capacity_));
+  needles_ = static_cast<Piece *>(allocate(sizeof(Piece) * needles_capacity_));
+  replacements_ = static_cast<Piece *>(allocate(sizeof(Piece) * needles_capacity_));
+  data_ = static_cast<char *>(allocate(data_capacity_));
+  new(nodes_) Node{};
+  std::fill(std::begin(root_children_), std::end(root_children_), NO_MATCH);
+}
+
+ReplaceTrie::~ReplaceTrie() noexcept {
+  deallocate(nodes_, sizeof(Node) * nodes_capacity_);
+  deallocate(needles_, sizeof(Piece) * needles_capacity_);
+  deallocate(replacements_, sizeof(Piece) * needles_capacity_);
+  deallocate(data_, data_capacity_);
+}
+
+void *ReplaceTrie::allocate(size_t size) const noexcept {
+  if (size == 0) {
+    return nullptr;
+  }
+  return use_heap_memory_ ? dl::heap_allocate(size) : dl::allocate(size);
+}
+
+void ReplaceTrie::deallocate(void *mem, size_t size) const noexcept {
+  if (size == 0) {
+    return;
+  }
+  use_heap_memory_ ? dl::heap_deallocate(mem, size) : dl::deallocate(mem, size);
+}
+
+bool ReplaceTrie::add(const char *needle, size_t needle_len, const char *replacement, size_t replacement_len) noexcept {
+  php_assert(needle_len > 0 && needles_count_ < needles_capacity_);
+  php_assert(data_size_ + needle_len + replacement_len <= data_capacity_);
+
+  const int32_t id = needles_count_++;
+  needles_[id] = Piece{static_cast<uint32_t>(data_size_), static_cast<uint32_t>(needle_len)};
+  memcpy(data_ + data_size_, needle, needle_len);
+  data_size_ += needle_len;
+  replacements_[id] = Piece{static_cast<uint32_t>(data_size_), static_cast<uint32_t>(replacement_len)};
+  memcpy(data_ + data_size_, replacement, replacement_len);
+  data_size_ += replacement_len;
+  max_needle_len_ = std::max(max_needle_len_, needle_len);
+
+  int32_t node = 0;
+  for (size_t i = 0; i < needle_len; ++i) {
+    int32_t child = find_child(node, needle[i]);
+    if (child == NO_MATCH) {
+      php_assert(nodes_count_ < nodes_capacity_);
+      child = nodes_count_++;
+      new(nodes_ + child) Node{};
+      nodes_[child].c = needle[i];
+      nodes_[child].owner = id;
+      if (node == 0) {
+        const auto first = static_cast<unsigned char>(needle[i]);
+        root_children_[first] = child;
+        if (first_bytes_count_ < static_cast<int32_t>(sizeof(first_bytes_))) {
+          first_bytes_[first_bytes_count_] = needle[i];
+        }
+        first_bytes_count_++;
+      } else {
+        nodes_[child].next_sibling = nodes_[node].first_child;
+        nodes_[node].first_child = child;
+      }
+    } else {
+      nodes_[child].owner = SEVERAL_OWNERS;
+    }
+    node = child;
+  }
+
+  if (nodes_[node].needle_id != NO_MATCH) {
+    return false;
+  }
+  nodes_[node].needle_id = id;
+  return true;
+}
+
+int32_t ReplaceTrie::find_child(int32_t node, char c) const noexcept {
+  if (node == 0) {
+    return root_children_[static_cast<unsigned char>(c)];
+  }
+  int32_t child = nodes_[node].first_child;
+  while (child != NO_MATCH && nodes_[child].c != c) {
+    child = nodes_[child].next_sibling;
+  }
+  return child;
+}
+
+const char *ReplaceTrie::find_candidate(const char *begin, const char *end) const noexcept {
+  if (first_bytes_count_ <= static_cast<int32_t>(sizeof(first_bytes_))) {
+    return simd_find_first_of(begin, end, first_bytes_, first_bytes_count_);
+  }
+  while (begin != end && root_children_[static_cast<unsigned char>(*begin)] == NO_MATCH) {
+    ++begin;
+  }
+  return begin;
+}
+
+int32_t ReplaceTrie::longest_match(const char *begin, const char *end, size_t &len) const noexcept {
+  const size_t max_len = std::min(max_needle_len_, static_cast<size_t>(end - begin));
+  int32_t best = NO_MATCH;
+  int32_t node = 0;
+  for (size_t i = 0; i < max_len; ++i) {
+    node = find_child(node, begin[i]);
+    if (node == NO_MATCH) {
+      break;
+    }
+    if (nodes_[node].needle_id != NO_MATCH) {
+      best = nodes_[node].needle_id;
+      len = i + 1;
+    }
+  }
+  return best;
+}
+
+string ReplaceTrie::replace_all(const string &subject, int64_t &replace_count) const noexcept {
+  const char *piece = subject.c_str();
+  const char *end = piece + subject.size();
+  const char *pos = piece;
+  int64_t count = 0;
+
+  string result;
+  while ((pos = find_candidate(pos, end)) != end) {
+    size_t len = 0;
+    const int32_t id = longest_match(pos, end, len);
+    if (id == NO_MATCH) {
+      ++pos;
+      continue;
+    }
+
+    if (count++ == 0) {
+      result.reserve_at_least(subject.size());
+    }
+    result.append(piece, static_cast<string::size_type>(pos - piece));
+    result.append(data_ + replacements_[id].offset, replacements_[id].len);
+    piece = pos = pos + len;
+  }
+
+  if (count == 0) {
+    return subject;
+  }
+  replace_count += count;
+  result.append(piece, static_cast<string::size_type>(end - piece));
+  return result;
+}
+
+bool ReplaceTrie::has_overlapping_needles() const noexcept {
+  for (int32_t id = 0; id < needles_count_; ++id) {
+    const char *needle = data_ + needles_[id].offset;
+    const size_t needle_len = needles_[id].len;
+    // walk the trie with every suffix of the needle:
+    // a needle found on the way is contained in this one,
+    // a fully consumed suffix is a prefix of the needles going through the final node
+    for (size_t start = 0; start < needle_len; ++start) {
+      int32_t node = 0;
+      for (size_t i = start; i < needle_len; ++i) {
+        node = find_child(node, needle[i]);
+        if (node == NO_MATCH) {
+          break;
+        }
+        const bool is_whole_needle = start == 0 && i + 1 == needle_len;
+        if (nodes_[node].needle_id != NO_MATCH && !is_whole_needle) {
+          return true;
+        }
+      }
+      // the needle may overlap with itself, it's handled in the same way by both algorithms
+      if (start != 0 && node != NO_MATCH && nodes_[node].owner != id) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool ReplaceTrie::is_equal_to_sequential_replace() const noexcept {
+  if (has_overlapping_needles()) {
+    return false;
+  }
+
+  // a replacement may form an occurrence of a needle applied after it,
+  // if it contains bytes of the needle or if it is empty and glues together the text around it
+  std::bitset<256> next_needles_bytes;
+  size_t next_needles_max_len = 0;
+  for (int32_t id = needles_count_ - 1; id >= 0; --id) {
+    const char *replacement = data_ + replacements_[id].offset;
+    if (replacements_[id].len == 0 && next_needles_max_len > 1) {
+      return false;
+    }
+    for (uint32_t i = 0; i < replacements_[id].len; ++i) {
+      if (next_needles_bytes.test(static_cast<unsigned char>(replacement[i]))) {
+        return false;
+      }
+    }
+
+    const char *needle = data_ + needles_[id].offset;
+    for (uint32_t i = 0; i < needles_[id].len; ++i) {
+      next_needles_bytes.set(static_cast<unsigned char>(needle[i]));
+    }
+    next_needles_max_len = std::max<size_t>(next_needles_max_len, needles_[id].len);
+  }
+  return true;
+}
+
+namespace {
+
+struct CachedReplaceTrie {
+  const void *search{nullptr};
+  const void *replace{nullptr};
+  const ReplaceTrie *trie{nullptr}; // nullptr if the arrays can't be replaced in one pass
+};
+
+constexpr size_t REPLACE_TRIE_CACHE_SIZE = 1024;
+CachedReplaceTrie replace_trie_cache[REPLACE_TRIE_CACHE_SIZE];
+
+// returns the entry of the arrays or an empty entry to be filled, nullptr if the cache is full
+CachedReplaceTrie *find_replace_trie_cache_entry(const void *search, const void *replace) noexcept {
+  const size_t hash = (reinterpret_cast<uintptr_t>(search) >> 4) ^ (reinterpret_cast<uintptr_t>(replace) >> 3);
+  for (size_t i = 0; i < REPLACE_TRIE_CACHE_SIZE; ++i) {
+    CachedReplaceTrie &entry = replace_trie_cache[(hash + i) % REPLACE_TRIE_CACHE_SIZE];
+    if (entry.search == nullptr || (entry.search == search && entry.replace == replace)) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+template<class F>
+const ReplaceTrie *get_cached_replace_trie(const void *search, const void *replace, bool &is_cached, const F &build_trie) noexcept {
+  is_cached = false;
+  CachedReplaceTrie *entry = find_replace_trie_cache_entry(search, replace);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  if (entry->search == nullptr) {
+    dl::CriticalSectionGuard critical_section;
+    entry->trie = build_trie();
+    entry->search = search;
+    entry->replace = replace;
+  }
+  is_cached = true;
+  return entry->trie;
+}
+
+template<class T>
+bool is_global_const(const array<T> &a) noexcept {
+  return a.is_reference_counter(ExtraRefCnt::for_global_const);
+}
+
+ReplaceTrie *make_str_replace_trie(const array<string> &search, const array<string> &replace, bool use_heap_memory) noexcept {
+  size_t needles_total_len = 0;
+  for (const auto &it : search) {
+    if (it.get_value().empty()) {
+      return nullptr;
+    }
+    needles_total_len += it.get_value().size();
+  }
+  size_t replacements_total_len = 0;
+  for (const auto &it : replace) {
+    replacements_total_len += it.get_value().size();
+  }
+
+  void *mem = use_heap_memory ? dl::heap_allocate(sizeof(ReplaceTrie)) : dl::allocate(sizeof(ReplaceTrie));
+  auto *trie = new(mem) ReplaceTrie(static_cast<int32_t>(search.count()), needles_total_len, replacements_total_len, use_heap_memory);
+  bool ok = true;
+  auto replace_it = replace.begin();
+  for (const auto &it : search) {
+    const string &needle = it.get_value();
+    if (replace_it != replace.end()) {
+      const string &replacement = replace_it.get_value();
+      ok = ok && trie->add(needle.c_str(), needle.size(), replacement.c_str(), replacement.size());
+      ++replace_it;
+    } else {
+      ok = ok && trie->add(needle.c_str(), needle.size(), "", 0);
+    }
+  }
+
+  if (ok && trie->is_equal_to_sequential_replace()) {
+    return trie;
+  }
+  trie->~ReplaceTrie();
+  use_heap_memory ? dl::heap_deallocate(mem, sizeof(ReplaceTrie)) : dl::deallocate(mem, sizeof(ReplaceTrie));
+  return nullptr;
+}
+
+void destroy_script_trie(ReplaceTrie *trie) noexcept {
+  trie->~ReplaceTrie();
+  dl::deallocate(trie, sizeof(ReplaceTrie));
+}
+
+} // namespace
+
+bool str_replace_with_trie(const array<string> &search, const array<string> &replace, const string &subject, int64_t &replace_count, string &result) {
+  if (is_global_const(search) && is_global_const(replace)) {
+    bool is_cached = false;
+    const ReplaceTrie *trie = get_cached_replace_trie(search.get_inner_pointer(), replace.get_inner_pointer(), is_cached, [&] {
+      return make_str_replace_trie(search, replace, true);
+    });
+    if (is_cached) {
+      if (trie == nullptr) {
+        return false;
+      }
+      result = trie->replace_all(subject, replace_count);
+      return true;
+    }
+  }
+
+  ReplaceTrie *trie = make_str_replace_trie(search, replace, false);
+  if (trie == nullptr) {
+    return false;
+  }
+  result = trie->replace_all(subject, replace_count);
+  destroy_script_trie(trie);
+  return true;
+}
+
+namespace {
+
+ReplaceTrie *make_strtr_trie(const array<string> &replace_pairs, bool use_heap_memory) noexcept {
+  size_t needles_total_len = 0;
+  size_t replacements_total_len = 0;
+  for (const auto &it : replace_pairs) {
+    const int64_t key_len = it.is_string_key() ? it.get_string_key().size() : string(it.get_int_key()).size();
+    if (key_len == 0) {
+      return nullptr;
+    }
+    needles_total_len += key_len;
+    replacements_total_len += it.get_value().size();
+  }
+
+  void *mem = use_heap_memory ? dl::heap_allocate(sizeof(ReplaceTrie)) : dl::allocate(sizeof(ReplaceTrie));
+  auto *trie = new(mem) ReplaceTrie(static_cast<int32_t>(replace_pairs.count()), needles_total_len, replacements_total_len, use_heap_memory);
+  for (const auto &it : replace_pairs) {
+    const string needle = it.is_string_key() ? it.get_string_key() : string(it.get_int_key());
+    const string &replacement = it.get_value();
+    // keys of an array are unique, so needles are unique too
+    trie->add(needle.c_str(), needle.size(), replacement.c_str(), replacement.size());
+  }
+  return trie;
+}
+
+} // namespace
+
+string strtr_with_trie(const string &subject, const array<string> &replace_pairs) {
+  int64_t replace_count = 0;
+  if (is_global_const(replace_pairs)) {
+    bool is_cached = false;
+    const ReplaceTrie *trie = get_cached_replace_trie(replace_pairs.get_inner_pointer(), nullptr, is_cached, [&] {
+      return make_strtr_trie(replace_pairs, true);
+    });
+    if (is_cached) {
+      // the trie isn't built if there is an empty key
+      return trie ? trie->replace_all(subject, replace_count) : subject;
+    }
+  }
+
+  ReplaceTrie *trie = make_strtr_trie(replace_pairs, false);
+  if (trie == nullptr) {
+    return subject;
+  }
+  string result = trie->replace_all(subject, replace_count);
+  destroy_script_trie(trie);
+  return result;
+}
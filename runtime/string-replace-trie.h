@@ -0,0 +1,84 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include "common/mixin/not_copyable.h"
+
+#include "runtime/kphp_core.h"
+
+// A trie over the search strings of strtr() and str_replace() with array arguments,
+// it finds the longest needle starting at each position, so all the replacements are done in one pass over the subject.
+// Needles and replacements are copied into the trie, so it doesn't depend on the lifetime of the source arrays.
+class ReplaceTrie : vk::not_copyable {
+public:
+  static constexpr int32_t NO_MATCH = -1;
+  // tries are used only when there are enough needles, for a couple of needles memmem() is faster
+  static constexpr int64_t MIN_NEEDLES_COUNT = 4;
+
+  // use_heap_memory is for tries that are kept between script runs
+  ReplaceTrie(int32_t needles_count, size_t needles_total_len, size_t replacements_total_len, bool use_heap_memory) noexcept;
+  ~ReplaceTrie() noexcept;
+
+  // needles are numbered in the order they are added; the needle must not be empty;
+  // returns false if the same needle has been already added
+  bool add(const char *needle, size_t needle_len, const char *replacement, size_t replacement_len) noexcept;
+
+  // replaces the leftmost longest occurrences of the needles, as strtr() does
+  string replace_all(const string &subject, int64_t &replace_count) const noexcept;
+
+  // str_replace() applies the needles one by one, each next needle is searched in the result of the previous replacement;
+  // it's equal to the one pass replace_all() only if occurrences of different needles can't overlap
+  // and replacements can't form occurrences of the needles that are applied after them
+  bool is_equal_to_sequential_replace() const noexcept;
+
+private:
+  struct Node {
+    int32_t first_child{NO_MATCH};
+    int32_t next_sibling{NO_MATCH};
+    int32_t needle_id{NO_MATCH}; // id of the needle ending in the node
+    int32_t owner{NO_MATCH};     // id of the only needle going through the node or SEVERAL_OWNERS
+    char c{0};
+  };
+  static constexpr int32_t SEVERAL_OWNERS = -2;
+
+  struct Piece {
+    uint32_t offset;
+    uint32_t len;
+  };
+
+  void *allocate(size_t size) const noexcept;
+  void deallocate(void *mem, size_t size) const noexcept;
+
+  int32_t find_child(int32_t node, char c) const noexcept;
+  const char *find_candidate(const char *begin, const char *end) const noexcept;
+  int32_t longest_match(const char *begin, const char *end, size_t &len) const noexcept;
+  bool has_overlapping_needles() const noexcept;
+
+  const bool use_heap_memory_;
+  const int32_t needles_capacity_;
+  const size_t nodes_capacity_;
+  const size_t data_capacity_;
+
+  int32_t needles_count_{0};
+  int32_t nodes_count_{1};
+  size_t data_size_{0};
+  size_t max_needle_len_{0};
+
+  Node *nodes_{nullptr};
+  Piece *needles_{nullptr};
+  Piece *replacements_{nullptr};
+  char *data_{nullptr};
+
+  int32_t root_children_[256];
+  char first_bytes_[16];
+  int32_t first_bytes_count_{0};
+};
+
+// tries for arrays that are compile-time constants are built once and kept in heap memory between script runs
+
+// returns false if the pairs can't be replaced in one pass, see ReplaceTrie::is_equal_to_sequential_replace()
+bool str_replace_with_trie(const array<string> &search, const array<string> &replace, const string &subject, int64_t &replace_count, string &result);
+
+string strtr_with_trie(const string &subject, const array<string> &replace_pairs);
@@ -8,6 +8,7 @@
 #include <sys/types.h>
 #include <cctype>
 
+#include "common/algorithms/simd-string-kernels.h"
 #include "common/macos-ports.h"
 #include "common/unicode/unicode-utils.h"
 
@@ -50,6 +51,35 @@ static inline const char *get_mask(const string &what) {
   return mask;
 }
 
+// short character lists without '..'-ranges (like the default WHAT) are trimmed with SIMD kernels, others need a mask
+static inline bool is_plain_byte_set(const string &what) {
+  return what.size() <= SIMD_BYTE_SET_MAX_SIZE && memmem(what.c_str(), what.size(), "..", 2) == nullptr;
+}
+
+// binary safe replacement for strcasestr(), case folding is still done according to the current locale
+static const char *find_substr_case_insensitive(const char *where, const char *where_end, const char *what, size_t what_len) {
+  if (where_end - where < static_cast<ptrdiff_t>(what_len)) {
+    return nullptr;
+  }
+
+  const auto first = static_cast<unsigned char>(what[0]);
+  const char first_variants[] = {static_cast<char>(tolower(first)), static_cast<char>(toupper(first))};
+  const char *last = where_end - what_len;
+  for (const char *s = where;; ++s) {
+    s = simd_find_first_of(s, last + 1, first_variants, 2);
+    if (s > last) {
+      return nullptr;
+    }
+    size_t i = 1;
+    while (i < what_len && tolower(static_cast<unsigned char>(s[i])) == tolower(static_cast<unsigned char>(what[i]))) {
+      i++;
+    }
+    if (i == what_len) {
+      return s;
+    }
+  }
+}
+
 string f$addcslashes(const string &str, const string &what) {
   const char *mask = get_mask(what);
 
@@ -464,57 +494,50 @@ string f$htmlspecialchars(const string &str, int64_t flags) {
     php_critical_error ("unsupported parameter flags = %" PRIi64 " in function htmlspecialchars", flags);
   }
 
-  const string::size_type len = str.size();
-  static_SB.clean().reserve(6 * len);
+  char special_chars[5] = {'&', '<', '>'};
+  size_t special_chars_count = 3;
+  if (!(flags & ENT_NOQUOTES)) {
+    special_chars[special_chars_count++] = '"';
+  }
+  if (flags & ENT_QUOTES) {
+    special_chars[special_chars_count++] = '\'';
+  }
 
-  for (string::size_type i = 0; i < len; i++) {
-    switch (str[i]) {
+  const char *s = str.c_str();
+  const char *end = s + str.size();
+  const char *special = simd_find_first_of(s, end, special_chars, special_chars_count);
+  if (special == end) {
+    return str;
+  }
+
+  static_SB.clean().reserve(6 * str.size());
+  while (true) {
+    static_SB.append_unsafe(s, static_cast<int>(special - s));
+    if (special == end) {
+      break;
+    }
+
+    switch (*special) {
       case '&':
-        static_SB.append_char('&');
-        static_SB.append_char('a');
-        static_SB.append_char('m');
-        static_SB.append_char('p');
-        static_SB.append_char(';');
+        static_SB.append_unsafe("&amp;", 5);
         break;
       case '"':
-        if (!(flags & ENT_NOQUOTES)) {
-          static_SB.append_char('&');
-          static_SB.append_char('q');
-          static_SB.append_char('u');
-          static_SB.append_char('o');
-          static_SB.append_char('t');
-          static_SB.append_char(';');
-        } else {
-          static_SB.append_char('"');
-        }
+        static_SB.append_unsafe("&quot;", 6);
         break;
       case '\'':
-        if (flags & ENT_QUOTES) {
-          static_SB.append_char('&');
-          static_SB.append_char('#');
-          static_SB.append_char('0');
-          static_SB.append_char('3');
-          static_SB.append_char('9');
-          static_SB.append_char(';');
-        } else {
-          static_SB.append_char('\'');
-        }
+        static_SB.append_unsafe("&#039;", 6);
         break;
       case '<':
-        static_SB.append_char('&');
-        static_SB.append_char('l');
-        static_SB.append_char('t');
-        static_SB.append_char(';');
+        static_SB.append_unsafe("&lt;", 4);
         break;
       case '>':
-        static_SB.append_char('&');
-        static_SB.append_char('g');
-        static_SB.append_char('t');
-        static_SB.append_char(';');
+        static_SB.append_unsafe("&gt;", 4);
         break;
       default:
-        static_SB.append_char(str[i]);
+        php_assert(0);
     }
+    s = special + 1;
+    special = simd_find_first_of(s, end, special_chars, special_chars_count);
   }
 
   return static_SB.str();
@@ -565,8 +588,13 @@ string f$lcfirst(const string &str) {
     return str;
   }
 
+  const char first = (char)tolower(str[0]);
+  if (first == str[0]) {
+    return str;
+  }
+
   string res(n, false);
-  res[0] = (char)tolower(str[0]);
+  res[0] = first;
   memcpy(&res[1], &str[1], n - 1);
 
   return res;
@@ -614,6 +642,15 @@ int64_t f$levenshtein(const string &str1, const string &str2) {
 }
 
 string f$ltrim(const string &s, const string &what) {
+  if (is_plain_byte_set(what)) {
+    const char *end = s.c_str() + s.size();
+    const char *l = simd_skip_byte_set(s.c_str(), end, what.c_str(), what.size());
+    if (l == s.c_str()) {
+      return s;
+    }
+    return {l, static_cast<string::size_type>(end - l)};
+  }
+
   const char *mask = get_mask(what);
 
   int len = (int)s.size();
@@ -976,6 +1013,14 @@ int64_t f$printf(const string &format, const array<mixed> &a) {
 }
 
 string f$rtrim(const string &s, const string &what) {
+  if (is_plain_byte_set(what)) {
+    const char *r = simd_skip_byte_set_backward(s.c_str(), s.c_str() + s.size(), what.c_str(), what.size());
+    if (r == s.c_str() + s.size()) {
+      return s;
+    }
+    return {s.c_str(), static_cast<string::size_type>(r - s.c_str())};
+  }
+
   const char *mask = get_mask(what);
 
   int len = (int)s.size() - 1;
@@ -1365,7 +1410,7 @@ Optional<int64_t> f$stripos(const string &haystack, const string &needle, int64_
     return false;
   }
 
-  const char *s = strcasestr(haystack.c_str() + offset, needle.c_str());
+  const char *s = find_substr_case_insensitive(haystack.c_str() + offset, haystack.c_str() + haystack.size(), needle.c_str(), needle.size());
   if (s == nullptr) {
     return false;
   }
@@ -1642,7 +1687,7 @@ Optional<string> f$stristr(const string &haystack, const string &needle, bool be
     return false;
   }
 
-  const char *s = strcasestr(haystack.c_str(), needle.c_str());
+  const char *s = find_substr_case_insensitive(haystack.c_str(), haystack.c_str() + haystack.size(), needle.c_str(), needle.size());
   if (s == nullptr) {
     return false;
   }
@@ -1938,11 +1983,12 @@ Optional<int64_t> f$strripos(const string &haystack, const string &needle, int64
     return false;
   }
 
-  const char *s = strcasestr(haystack.c_str() + offset, needle.c_str()), *t;
+  const char *haystack_end = haystack.c_str() + haystack.size();
+  const char *s = find_substr_case_insensitive(haystack.c_str() + offset, haystack_end, needle.c_str(), needle.size()), *t;
   if (s == nullptr || s >= end) {
     return false;
   }
-  while ((t = strcasestr(s + 1, needle.c_str())) != nullptr && t < end) {
+  while ((t = find_substr_case_insensitive(s + 1, haystack_end, needle.c_str(), needle.size())) != nullptr && t < end) {
     s = t;
   }
   return s - haystack.c_str();
@@ -1977,19 +2023,28 @@ Optional<string> f$strstr(const string &haystack, const string &needle, bool bef
   return haystack.substr(pos, haystack.size() - pos);
 }
 
+// converts [src, src + size) with SIMD kernels for ASCII runs;
+// non-ASCII bytes go through the current locale as before (cp1251 letters are converted too)
+template<size_t (*ascii_convert)(const char *, char *, size_t) noexcept, int (*locale_convert)(int)>
+static void convert_case(const char *src, char *dst, size_t size) {
+  size_t i = 0;
+  while (i < size) {
+    i += ascii_convert(src + i, dst + i, size - i);
+    for (; i < size && static_cast<unsigned char>(src[i]) >= 0x80; ++i) {
+      dst[i] = static_cast<char>(locale_convert(static_cast<unsigned char>(src[i])));
+    }
+  }
+}
+
 string f$strtolower(const string &str) {
   int n = str.size();
 
   // if there is no upper case char inside the string, we can
   // return the argument unchanged, avoiding the allocation and data copying;
   // while at it, memorize the first upper case char, so we can
-  // use memcpy to copy everything before that pos;
-  // note: do not use islower() here, the compiler does not inline that function call;
-  // it could be beneficial to use 256-byte LUT here, but SIMD approach could be even better
+  // use memcpy to copy everything before that pos
   const char *end = str.c_str() + n;
-  const char *uppercase_pos = std::find_if(str.c_str(), end, [](unsigned char ch) {
-    return ch >= 'A' && ch <= 'Z';
-  });
+  const char *uppercase_pos = simd_find_ascii_range(str.c_str(), end, 'A', 'Z');
   if (uppercase_pos == end) {
     return str;
   }
@@ -1999,9 +2054,7 @@ string f$strtolower(const string &str) {
   if (lowercase_prefix != 0) { // avoid unnecessary function call
     std::memcpy(res.buffer(), str.c_str(), lowercase_prefix);
   }
-  for (int i = lowercase_prefix; i < n; i++) {
-    res[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(str[i])));
-  }
+  convert_case<simd_ascii_tolower, tolower>(uppercase_pos, res.buffer() + lowercase_prefix, n - lowercase_prefix);
 
   return res;
 }
@@ -2011,9 +2064,7 @@ string f$strtoupper(const string &str) {
 
   // same optimization as in strtolower
   const char *end = str.c_str() + n;
-  const char *lowercase_pos = std::find_if(str.c_str(), end, [](unsigned char ch) {
-    return ch >= 'a' && ch <= 'z';
-  });
+  const char *lowercase_pos = simd_find_ascii_range(str.c_str(), end, 'a', 'z');
   if (lowercase_pos == end) {
     return str;
   }
@@ -2023,9 +2074,7 @@ string f$strtoupper(const string &str) {
   if (uppercase_prefix != 0) { // avoid unnecessary function call
     std::memcpy(res.buffer(), str.c_str(), uppercase_prefix);
   }
-  for (int i = uppercase_prefix; i < n; i++) {
-    res[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(str[i])));
-  }
+  convert_case<simd_ascii_toupper, toupper>(lowercase_pos, res.buffer() + uppercase_prefix, n - uppercase_prefix);
 
   return res;
 }
@@ -2132,8 +2181,7 @@ static string str_replace_char(char c, const string &replace, const string &subj
     if (with_case) {
       pos = static_cast<const char *>(memchr(piece, c, piece_end - piece));
     } else {
-      const char needle[] = {c, '\0'};
-      pos = strcasestr(piece, needle);
+      pos = find_substr_case_insensitive(piece, piece_end, &c, 1);
     }
 
     if (pos == nullptr) {
@@ -2161,7 +2209,7 @@ static const char *find_substr(const char *where, const char *where_end, const s
     return static_cast<char *>(memmem(where, where_end - where, what.c_str(), what.size()));
   }
 
-  return strcasestr(where, what.c_str());
+  return find_substr_case_insensitive(where, where_end, what.c_str(), what.size());
 }
 
 void str_replace_inplace(const string &search, const string &replace, string &subject, int64_t &replace_count, bool with_case) {
@@ -2250,8 +2298,17 @@ string str_replace_string(const mixed &search, const mixed &replace, const strin
   if (search.is_array() && replace.is_array()) {
     return str_replace_string_array(search.as_array(""), replace.as_array(""), subject, replace_count, with_case);
   } else if (search.is_array()) {
-    string result = subject;
+    const array<mixed> &search_array = search.as_array("");
     const string &replace_value = replace.to_string();
+    if (with_case && search_array.count() >= ReplaceTrie::MIN_NEEDLES_COUNT) {
+      array<string> replace_array(array_size(search_array.count(), true));
+      for (int64_t i = 0; i < search_array.count(); ++i) {
+        replace_array.push_back(replace_value);
+      }
+      return str_replace_string_array(search_array, replace_array, subject, replace_count, with_case);
+    }
+
+    string result = subject;
 
     for (array<mixed>::const_iterator it = search.begin(); it != search.end(); ++it) {
       const string &search_string = f$strval(it.get_value());
@@ -2456,6 +2513,15 @@ bool f$str_ends_with(const string &haystack, const string &needle) {
 }
 
 tmp_string trim_impl(const char *s, string::size_type s_len, const string &what) {
+  if (is_plain_byte_set(what)) {
+    const char *r = simd_skip_byte_set_backward(s, s + s_len, what.c_str(), what.size());
+    if (r == s && s_len != 0) {
+      return {};
+    }
+    const char *l = simd_skip_byte_set(s, r, what.c_str(), what.size());
+    return {l, static_cast<string::size_type>(r - l)};
+  }
+
   const char *mask = get_mask(what);
 
   int len = s_len;
@@ -2504,8 +2570,13 @@ string f$ucfirst(const string &str) {
     return str;
   }
 
+  const char first = (char)toupper(str[0]);
+  if (first == str[0]) {
+    return str;
+  }
+
   string res(n, false);
-  res[0] = (char)toupper(str[0]);
+  res[0] = first;
   memcpy(&res[1], &str[1], n - 1);
 
   return res;
@@ -6,6 +6,7 @@
 
 #include <type_traits>
 #include "runtime/kphp_core.h"
+#include "runtime/string-replace-trie.h"
 
 extern const string COLON;
 extern const string CP1251;
@@ -175,8 +176,28 @@ string f$str_ireplace(const string &search, const string &replace, const string
 void str_replace_inplace(const string &search, const string &replace, string &subject, int64_t &replace_count, bool with_case);
 string str_replace(const string &search, const string &replace, const string &subject, int64_t &replace_count, bool with_case);
 
+template<typename T>
+array<string> str_replace_array_to_strings(const array<T> &arr) {
+  array<string> result(array_size(arr.count(), true));
+  for (typename array<T>::const_iterator it = arr.begin(); it != arr.end(); ++it) {
+    result.push_back(f$strval(it.get_value()));
+  }
+  return result;
+}
+
+inline const array<string> &str_replace_array_to_strings(const array<string> &arr) {
+  return arr;
+}
+
 template<typename T1, typename T2>
 string str_replace_string_array(const array<T1> &search, const array<T2> &replace, const string &subject, int64_t &replace_count, bool with_case) {
+  if (with_case && search.count() >= ReplaceTrie::MIN_NEEDLES_COUNT) {
+    string result;
+    if (str_replace_with_trie(str_replace_array_to_strings(search), str_replace_array_to_strings(replace), subject, replace_count, result)) {
+      return result;
+    }
+  }
+
   string result = subject;
 
   string replace_value;
@@ -379,37 +400,19 @@ Optional<string> f$strstr(const string &haystack, const mixed &needle, bool befo
 
 template<class T>
 string f$strtr(const string &subject, const array<T> &replace_pairs) {
-  const char *piece = subject.c_str(), *piece_end = subject.c_str() + subject.size();
-  string result;
-  while (1) {
-    const char *best_pos = nullptr;
-    int64_t best_len = -1;
-    string replace;
+  if constexpr (std::is_same_v<T, string>) {
+    return strtr_with_trie(subject, replace_pairs);
+  } else {
+    array<string> string_replace_pairs(replace_pairs.size());
     for (typename array<T>::const_iterator p = replace_pairs.begin(); p != replace_pairs.end(); ++p) {
-      const string search = f$strval(p.get_key());
-      int64_t search_len = search.size();
-      if (search_len == 0) {
-        return subject;
+      if (p.is_string_key()) {
+        string_replace_pairs.set_value(p.get_string_key(), f$strval(p.get_value()));
+      } else {
+        string_replace_pairs.set_value(p.get_int_key(), f$strval(p.get_value()));
       }
-      const char *pos = static_cast <const char *> (memmem(static_cast <const void *> (piece), (size_t)(piece_end - piece), static_cast <const void *> (search.c_str()), (size_t)search_len));
-      if (pos != nullptr && (best_pos == nullptr || best_pos > pos || (best_pos == pos && search_len > best_len))) {
-        best_pos = pos;
-        best_len = search_len;
-        replace = f$strval(p.get_value());
-      }
-    }
-    if (best_pos == nullptr) {
-      result.append(piece, static_cast<string::size_type>(piece_end - piece));
-      break;
     }
-
-    result.append(piece, static_cast<string::size_type>(best_pos - piece));
-    result.append(replace);
-
-    piece = best_pos + best_len;
+    return strtr_with_trie(subject, string_replace_pairs);
   }
-
-  return result;
 }
 
 inline string f$strtr(const string &subject, const mixed &from, const mixed &to) {
@@ -2,11 +2,39 @@
 // Copyright (c) 2023 LLC «V Kontakte»
 // Distributed under the GPL v3 License, see LICENSE.notice.txt
 
+#include <algorithm>
+#include <cerrno>
 #include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
 
+#include "common/macos-ports.h"
+#include "common/vector-product.h"
+#include "net/net-events.h"
+#include "net/net-reactor.h"
+
+#include "runtime/critical_section.h"
+#include "runtime/resumable.h"
 #include "runtime/thread-pool.h"
 #include "server/php-engine-vars.h"
+#include "server/php-engine.h"
+#include "server/php-queries.h"
+#include "server/slot-ids-factory.h"
+
+namespace {
 
+int on_finished_tasks_notification(int fd, void *data __attribute__((unused)), event_t *ev) {
+  if (!(ev->ready & EVT_READ)) {
+    return 0;
+  }
+  char buf[256];
+  while (read(fd, buf, sizeof(buf)) > 0) {
+  }
+  vk::singleton<ThreadPool>::get().take_finished_tasks();
+  return 0;
+}
+
+} // namespace
 
 void ThreadPool::init() noexcept {
   if (!is_thread_pool_available() && thread_pool_size > 0) {
@@ -23,7 +51,220 @@ void ThreadPool::init() noexcept {
     pthread_sigmask(SIG_BLOCK, &sigset, NULL);
     thread_pool_ptr = new BS::thread_pool(thread_pool_size);
     pthread_sigmask(SIG_UNBLOCK, &sigset, NULL);
+
+    dl_passert(pipe2(finished_tasks_pipe_, O_NONBLOCK) == 0, "can't create a pipe for thread pool notifications");
+    epoll_sethandler(finished_tasks_pipe_[0], 0, on_finished_tasks_notification, nullptr);
+    epoll_insert(finished_tasks_pipe_[0], EVT_READ | EVT_SPEC);
+  }
+}
+
+int ThreadPool::create_task_id() noexcept {
+  return thread_pool_tasks_factory.create_slot();
+}
+
+void ThreadPool::submit_task(int task_id, int64_t resumable_id, std::unique_ptr<ThreadPoolTask> &&task) noexcept {
+  dl::CriticalSectionGuard critical_section;
+  ThreadPoolTask *running_task = task.release();
+  tasks_.emplace(task_id, TaskInfo{running_task, resumable_id, false});
+  pool().push_task([this, task_id, running_task] {
+    running_task->run();
+    on_task_finished(task_id, running_task);
+  });
+}
+
+void ThreadPool::run_task_in_place(int task_id, std::unique_ptr<ThreadPoolTask> &&task) noexcept {
+  dl::CriticalSectionGuard critical_section;
+  task->run();
+  tasks_.emplace(task_id, TaskInfo{task.release(), 0, true});
+}
+
+std::unique_ptr<ThreadPoolTask> ThreadPool::withdraw_finished_task(int task_id) noexcept {
+  dl::CriticalSectionGuard critical_section;
+  auto it = tasks_.find(task_id);
+  php_assert(it != tasks_.end() && it->second.finished);
+  std::unique_ptr<ThreadPoolTask> task{it->second.task};
+  tasks_.erase(it);
+  return task;
+}
+
+void ThreadPool::on_task_finished(int task_id, ThreadPoolTask *task) noexcept {
+  {
+    std::lock_guard<std::mutex> lock{finished_tasks_mutex_};
+    finished_tasks_.emplace_back(task_id, task);
+  }
+  // if the pipe is full, the script thread is going to read it anyway
+  const char byte = 0;
+  while (write(finished_tasks_pipe_[1], &byte, 1) < 0 && errno == EINTR) {
+  }
+}
+
+void ThreadPool::take_finished_tasks() noexcept {
+  dl::CriticalSectionGuard critical_section;
+  std::vector<std::pair<int, ThreadPoolTask *>> finished_tasks;
+  {
+    std::lock_guard<std::mutex> lock{finished_tasks_mutex_};
+    finished_tasks.swap(finished_tasks_);
+  }
+  for (const auto &[task_id, task] : finished_tasks) {
+    auto it = tasks_.find(task_id);
+    if (it == tasks_.end()) {
+      // the script which started the task has already finished
+      delete task;
+      continue;
+    }
+    it->second.finished = true;
+    on_net_event(create_thread_pool_task_event(task_id));
+  }
+}
+
+void ThreadPool::process_finished_task(int task_id) noexcept {
+  auto it = tasks_.find(task_id);
+  if (it == tasks_.end() || !it->second.finished) {
+    return;
+  }
+  resumable_run_ready(it->second.resumable_id);
+}
+
+void ThreadPool::reset() noexcept {
+  dl::CriticalSectionGuard critical_section;
+  for (const auto &[task_id, info] : tasks_) {
+    if (info.finished) {
+      delete info.task;
+    }
+  }
+  tasks_.clear();
+}
+
+namespace {
+
+template<class ResultT>
+class ThreadPoolTaskResumable final : public Resumable {
+public:
+  using ReturnT = ResultT;
+
+  explicit ThreadPoolTaskResumable(int task_id) noexcept
+    : task_id_(task_id) {}
+
+  bool is_internal_resumable() const noexcept final {
+    return true;
+  }
+
+protected:
+  bool run() final {
+    ResultT result;
+    {
+      // the task is deleted from the libc heap
+      dl::CriticalSectionGuard critical_section;
+      std::unique_ptr<ThreadPoolTask> task = vk::singleton<ThreadPool>::get().withdraw_finished_task(task_id_);
+      result = static_cast<ThreadPoolTaskWithResult<ResultT> &>(*task).make_result();
+    }
+    RETURN(std::move(result));
+  }
+
+private:
+  int task_id_;
+};
+
+} // namespace
+
+template<class ResultT>
+int64_t start_thread_pool_task(std::unique_ptr<ThreadPoolTaskWithResult<ResultT>> &&task) noexcept {
+  auto &thread_pool = vk::singleton<ThreadPool>::get();
+  const int task_id = thread_pool.create_task_id();
+  if (!thread_pool.is_thread_pool_available()) {
+    thread_pool.run_task_in_place(task_id, std::move(task));
+    return fork_resumable(new ThreadPoolTaskResumable<ResultT>{task_id});
+  }
+  const int64_t resumable_id = register_forked_resumable(new ThreadPoolTaskResumable<ResultT>{task_id});
+  thread_pool.submit_task(task_id, resumable_id, std::move(task));
+  return resumable_id;
+}
+
+template int64_t start_thread_pool_task<double>(std::unique_ptr<ThreadPoolTaskWithResult<double>> &&task) noexcept;
+template int64_t start_thread_pool_task<string>(std::unique_ptr<ThreadPoolTaskWithResult<string>> &&task) noexcept;
+template int64_t start_thread_pool_task<Optional<string>>(std::unique_ptr<ThreadPoolTaskWithResult<Optional<string>>> &&task) noexcept;
+template int64_t start_thread_pool_task<array<int64_t>>(std::unique_ptr<ThreadPoolTaskWithResult<array<int64_t>>> &&task) noexcept;
+template int64_t start_thread_pool_task<array<double>>(std::unique_ptr<ThreadPoolTaskWithResult<array<double>>> &&task) noexcept;
+
+namespace {
+
+template<class T>
+class SortTask final : public ThreadPoolTaskWithResult<array<T>> {
+public:
+  explicit SortTask(const array<T> &values) {
+    values_.reserve(values.count());
+    for (const auto &it : values) {
+      values_.push_back(it.get_value());
+    }
+  }
+
+  void run() noexcept final {
+    if constexpr (std::is_same<T, double>{}) {
+      // NaNs are not ordered, so doubles are sorted by a total order of their bits
+      std::sort(values_.begin(), values_.end(), [](double lhs, double rhs) {
+        return dl::sort_impl::radix_key(lhs) < dl::sort_impl::radix_key(rhs);
+      });
+    } else {
+      std::sort(values_.begin(), values_.end());
+    }
+  }
+
+  array<T> make_result() noexcept final {
+    array<T> result{array_size{static_cast<int64_t>(values_.size()), true}};
+    for (const T &value : values_) {
+      result.push_back(value);
+    }
+    return result;
+  }
+
+private:
+  std::vector<T> values_;
+};
+
+class DotProductTask final : public ThreadPoolTaskWithResult<double> {
+public:
+  DotProductTask(const array<double> &a, const array<double> &b) {
+    const int64_t size = std::min(a.count(), b.count());
+    a_.reserve(size);
+    b_.reserve(size);
+    for (int64_t i = 0; i < size; ++i) {
+      a_.push_back(a.get_value(i));
+      b_.push_back(b.get_value(i));
+    }
+  }
+
+  void run() noexcept final {
+    result_ = __dot_product(a_.data(), b_.data(), static_cast<int>(a_.size()));
+  }
+
+  double make_result() noexcept final {
+    return result_;
+  }
+
+private:
+  std::vector<double> a_;
+  std::vector<double> b_;
+  double result_{0};
+};
+
+} // namespace
+
+int64_t f$thread_pool_sort_ints(const array<int64_t> &values) noexcept {
+  dl::CriticalSectionGuard critical_section;
+  return start_thread_pool_task<array<int64_t>>(std::make_unique<SortTask<int64_t>>(values));
+}
+
+int64_t f$thread_pool_sort_floats(const array<double> &values) noexcept {
+  dl::CriticalSectionGuard critical_section;
+  return start_thread_pool_task<array<double>>(std::make_unique<SortTask<double>>(values));
+}
+
+int64_t f$thread_pool_dot_product(const array<double> &a, const array<double> &b) noexcept {
+  if (!a.is_vector() || !b.is_vector()) {
+    php_warning("thread_pool_dot_product expects vectors");
   }
+  dl::CriticalSectionGuard critical_section;
+  return start_thread_pool_task<double>(std::make_unique<DotProductTask>(a, b));
 }
 
 uint32_t thread_pool_size = 0;
@@ -4,11 +4,34 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "common/dl-utils-lite.h"
 #include "common/mixin/not_copyable.h"
 #include "common/smart_ptrs/singleton.h"
 #include "third-party/BS_thread_pool.hpp"
 
+#include "runtime/kphp_core.h"
+
+// A heavy piece of work offloaded from the script to the thread pool.
+// run() is executed in a pool thread, so it must not touch the script memory:
+// the input is copied to the heap when the task is created and the result is moved to the script memory by make_result()
+class ThreadPoolTask : vk::not_copyable {
+public:
+  virtual void run() noexcept = 0;
+  virtual ~ThreadPoolTask() = default;
+};
+
+template<class ResultT>
+class ThreadPoolTaskWithResult : public ThreadPoolTask {
+public:
+  // called in the script thread after run() has finished
+  virtual ResultT make_result() noexcept = 0;
+};
+
 class ThreadPool : vk::not_copyable {
 public:
   void init() noexcept;
@@ -31,13 +54,52 @@ public:
    }
   }
 
+  int create_task_id() noexcept;
+  // the task is run in a pool thread, the resumable is made ready when the task is finished
+  void submit_task(int task_id, int64_t resumable_id, std::unique_ptr<ThreadPoolTask> &&task) noexcept;
+  // used when the thread pool is disabled
+  void run_task_in_place(int task_id, std::unique_ptr<ThreadPoolTask> &&task) noexcept;
+  std::unique_ptr<ThreadPoolTask> withdraw_finished_task(int task_id) noexcept;
+
+  // called in the script thread when pool threads notify about finished tasks
+  void take_finished_tasks() noexcept;
+  // called in the script thread on the net event about the finished task
+  void process_finished_task(int task_id) noexcept;
+  // called on the script end, tasks that are still running are deleted when they are finished
+  void reset() noexcept;
 
 private:
   ThreadPool() = default;
 
+  void on_task_finished(int task_id, ThreadPoolTask *task) noexcept;
+
   friend class vk::singleton<ThreadPool>;
 
+  struct TaskInfo {
+    ThreadPoolTask *task{nullptr};
+    int64_t resumable_id{0};
+    bool finished{false};
+  };
+
   BS::thread_pool * thread_pool_ptr{nullptr};
+
+  // are accessed only from the script thread
+  std::unordered_map<int, TaskInfo> tasks_;
+
+  // pool threads put finished tasks here and write a byte to the pipe, which is polled by the script thread
+  std::mutex finished_tasks_mutex_;
+  std::vector<std::pair<int, ThreadPoolTask *>> finished_tasks_;
+  int finished_tasks_pipe_[2]{-1, -1};
 };
 
+// returns the id of a future, which is ready when the task is finished;
+// the task is created on the libc heap, so it must be done in a critical section;
+// it is instantiated in thread-pool.cpp for the result types of the thread_pool_* functions
+template<class ResultT>
+int64_t start_thread_pool_task(std::unique_ptr<ThreadPoolTaskWithResult<ResultT>> &&task) noexcept;
+
 extern uint32_t thread_pool_size;
+
+int64_t f$thread_pool_sort_ints(const array<int64_t> &values) noexcept;
+int64_t f$thread_pool_sort_floats(const array<double> &values) noexcept;
+int64_t f$thread_pool_dot_product(const array<double> &a, const array<double> &b) noexcept;
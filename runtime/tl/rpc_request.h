@@ -88,7 +88,7 @@ public:
 
   class_instance<C$VK$TL$RpcResponse> fetch_typed_response() final {
     class_instance<C$VK$TL$RpcResponse> $response;
-    t_ReqResult_<tl_exclamation_fetch_wrapper, 0>(tl_exclamation_fetch_wrapper(std::move(result_fetcher_))).typed_fetch_to($response);
+    t_ReqResult_<tl_exclamation_lazy_fetch_wrapper, 0>(tl_exclamation_lazy_fetch_wrapper(std::move(result_fetcher_))).typed_fetch_to($response);
     return $response;
   }
 
@@ -7,6 +7,7 @@
 #include <cstdarg>
 
 #include "runtime/exception.h"
+#include "runtime/rpc.h"
 #include "runtime/tl/rpc_request.h"
 
 void RpcPendingQueries::save(const class_instance<RpcTlQuery> &query) {
@@ -24,6 +25,46 @@ void RpcPendingQueries::hard_reset() {
   hard_reset_var(queries_);
 }
 
+class_instance<C$VK$TL$RpcFunctionReturnResult> RpcLazyResults::defer(std::unique_ptr<tl_func_base> &&result_fetcher) {
+  class_instance<RpcLazyResult> lazy_result;
+  lazy_result.alloc();
+  lazy_result.get()->result_fetcher = std::move(result_fetcher);
+  lazy_result.get()->tl_function_name = CurrentProcessingQuery::get().get_current_tl_function_name();
+  // the function result is the last field of ReqResult
+  lazy_result.get()->tl_body = rpc_fetch_rest();
+  return lazy_result;
+}
+
+class_instance<C$VK$TL$RpcFunctionReturnResult> RpcLazyResults::fetch(const class_instance<C$VK$TL$RpcFunctionReturnResult> &result) {
+  const auto lazy_result = result.cast_to<RpcLazyResult>();
+  if (lazy_result.is_null()) {
+    return result;
+  }
+  RpcLazyResult &lazy = *lazy_result.get();
+  if (!lazy.result_fetcher) {
+    return lazy.result;
+  }
+  // the fetcher is dropped even if the result is broken, so it's decoded and reported once
+  const auto result_fetcher = std::move(lazy.result_fetcher);
+  const string tl_body = std::move(lazy.tl_body);
+  if (!f$rpc_parse(tl_body)) {
+    return {};
+  }
+  CurrentProcessingQuery::get().set_current_tl_function(lazy.tl_function_name);
+  lazy.result = result_fetcher->typed_fetch();
+  CurrentProcessingQuery::get().reset();
+  // the error is already reported with a warning, there is no response to put it in
+  if (!CurException.is_null()) {
+    CurException = Optional<bool>{};
+    lazy.result = class_instance<C$VK$TL$RpcFunctionReturnResult>{};
+  } else if (!f$fetch_eof()) {
+    php_warning("Not all data fetched in result of %s", lazy.tl_function_name.c_str());
+    lazy.result = class_instance<C$VK$TL$RpcFunctionReturnResult>{};
+  }
+  rpc_parse_restore_previous();
+  return lazy.result;
+}
+
 void CurrentProcessingQuery::reset() {
   current_tl_function_name_ = string();
 }
@@ -5,6 +5,7 @@
 #pragma once
 #include "runtime/kphp_core.h"
 #include "runtime/refcountable_php_classes.h"
+#include "runtime/tl/tl_func_base.h"
 
 class RpcRequestResult;
 
@@ -34,6 +35,45 @@ private:
   array<class_instance<RpcTlQuery>> queries_;
 };
 
+// The function result of a typed response, which is kept as raw TL until getResult() is called.
+// It's stored in the result field of the response, so it's freed together with the response.
+struct RpcLazyResult final : refcountable_polymorphic_php_classes<C$VK$TL$RpcFunctionReturnResult> {
+  std::unique_ptr<tl_func_base> result_fetcher;
+  string tl_function_name;
+  string tl_body;
+  // the response may be shared by clone, so the decoded result is kept for the other copies
+  class_instance<C$VK$TL$RpcFunctionReturnResult> result;
+
+  size_t virtual_builtin_sizeof() const noexcept final { return sizeof(RpcLazyResult); }
+  // copies for instance cache and job workers can't take the fetcher living in the script memory, they are decoded to null
+  RpcLazyResult *virtual_builtin_clone() const noexcept final { return new RpcLazyResult{}; }
+};
+
+// After typed_rpc_tl_set_lazy_results(true) t_ReqResult fetches only the response header and error,
+// the function result is decoded by getResult() of rpcResponseOk and rpcResponseHeader on the first call
+class RpcLazyResults {
+public:
+  static RpcLazyResults &get() {
+    static RpcLazyResults results;
+    return results;
+  }
+
+  bool enabled() const { return enabled_; }
+  void set_enabled(bool enabled) { enabled_ = enabled; }
+
+  // is called instead of typed_fetch() of the function result, takes the rest of the answer
+  static class_instance<C$VK$TL$RpcFunctionReturnResult> defer(std::unique_ptr<tl_func_base> &&result_fetcher);
+  // returns the result as is, unless it's deferred; returns null if a deferred result can't be decoded
+  static class_instance<C$VK$TL$RpcFunctionReturnResult> fetch(const class_instance<C$VK$TL$RpcFunctionReturnResult> &result);
+
+  void reset() { enabled_ = false; }
+
+private:
+  RpcLazyResults() = default;
+
+  bool enabled_{false};
+};
+
 class CurrentProcessingQuery {
 public:
   static CurrentProcessingQuery &get() {
@@ -41,23 +41,41 @@ struct tl_exclamation_fetch_wrapper {
   }
 };
 
+// the function result at the top level of a typed response: it's not decoded in the lazy mode,
+// while !X nested in the result and in the arguments are fetched with tl_exclamation_fetch_wrapper as usual
+struct tl_exclamation_lazy_fetch_wrapper : tl_exclamation_fetch_wrapper {
+  using tl_exclamation_fetch_wrapper::tl_exclamation_fetch_wrapper;
+
+  void typed_fetch_to(PhpType &out) {
+    php_assert(fetcher);
+    if (RpcLazyResults::get().enabled()) {
+      out = RpcLazyResults::defer(std::move(fetcher));
+    } else {
+      out = fetcher->typed_fetch();
+    }
+  }
+};
+
 using tl_storer_ptr = std::unique_ptr<tl_func_base>(*)(const mixed &);
 
-inline mixed tl_arr_get(const mixed &arr, const string &str_key, int64_t num_key, int64_t precomputed_hash = 0) {
+// returns a reference into the array not to copy fields on each access: the array outlives storing
+inline const mixed &tl_arr_get(const mixed &arr, const string &str_key, int64_t num_key, int64_t precomputed_hash = 0) {
+  static const mixed not_found;
   if (!arr.is_array()) {
     CurrentProcessingQuery::get().raise_storing_error("Array expected, when trying to access field #%" PRIi64 " : %s", num_key, str_key.c_str());
-    return {};
+    return not_found;
   }
-  const mixed &num_v = arr.get_value(num_key);
-  if (!num_v.is_null()) {
-    return num_v;
+  const array<mixed> &fields = arr.as_array();
+  const mixed *num_v = fields.find_value(num_key);
+  if (num_v && !num_v->is_null()) {
+    return *num_v;
   }
-  const mixed &str_v = (precomputed_hash == 0 ? arr.get_value(str_key) : arr.get_value(str_key, precomputed_hash));
-  if (!str_v.is_null()) {
-    return str_v;
+  const mixed *str_v = (precomputed_hash == 0 ? fields.find_value(str_key) : fields.find_value(str_key, precomputed_hash));
+  if (str_v && !str_v->is_null()) {
+    return *str_v;
   }
   CurrentProcessingQuery::get().raise_storing_error("Field %s (#%" PRIi64 ") not found", str_key.c_str(), num_key);
-  return {};
+  return not_found;
 }
 
 inline void store_magic_if_not_bare(unsigned int inner_magic) {
@@ -75,26 +93,6 @@ inline void fetch_magic_if_not_bare(unsigned int inner_magic, const char *error_
   }
 }
 
-template<class T>
-inline void fetch_raw_vector_T(array<T> &out __attribute__ ((unused)), int64_t n_elems __attribute__ ((unused))) {
-  php_assert(0 && "never called in runtime");
-}
-
-template<>
-inline void fetch_raw_vector_T<double>(array<double> &out, int64_t n_elems) {
-  f$fetch_raw_vector_double(out, n_elems);
-}
-
-template<class T>
-inline void store_raw_vector_T(const array<T> &v __attribute__ ((unused))) {
-  php_assert(0 && "never called in runtime");
-}
-
-template<>
-inline void store_raw_vector_T<double>(const array<double> &v) {
-  f$store_raw_vector_double(v);
-}
-
 // Wrap into Optional that TL types which PhpType is:
 //  1. int, double, string, bool
 //  2. array<T>
@@ -262,6 +260,35 @@ struct t_String {
   }
 };
 
+// Bare vectors of fixed size primitives are fetched and stored in bulk, with one bounds check and memcpy
+// (TL ints are widened to int64_t and narrowed back with SIMD)
+template<typename T, unsigned int inner_magic>
+inline constexpr bool is_raw_vector_serializable_v = inner_magic == 0 && vk::is_type_in_list<T, t_Int, t_Long, t_Double>{};
+
+template<typename T>
+inline void fetch_raw_vector_T(array<typename T::PhpType> &out, int64_t n_elems) {
+  if constexpr (std::is_same_v<T, t_Int>) {
+    fetch_raw_vector_int(out, n_elems);
+  } else if constexpr (std::is_same_v<T, t_Long>) {
+    fetch_raw_vector_long(out, n_elems);
+  } else {
+    f$fetch_raw_vector_double(out, n_elems);
+  }
+}
+
+// returns false if nothing is stored, elements are to be stored one by one then
+template<typename T>
+inline bool store_raw_vector_T(const array<typename T::PhpType> &v) {
+  if constexpr (std::is_same_v<T, t_Int>) {
+    return store_raw_vector_int(v);
+  } else if constexpr (std::is_same_v<T, t_Long>) {
+    store_raw_vector_long(v);
+  } else {
+    f$store_raw_vector_double(v);
+  }
+  return true;
+}
+
 struct t_Bool {
   void store(const mixed &tl_object) {
     store_int(tl_object.to_bool() ? TL_BOOL_TRUE : TL_BOOL_FALSE);
@@ -365,9 +392,10 @@ struct t_Vector {
     int64_t n = v.count();
     f$store_int(n);
 
-    if (std::is_same<T, t_Double>{} && inner_magic == 0 && v.is_vector()) {
-      store_raw_vector_T<typename T::PhpType>(v);
-      return;
+    if constexpr (is_raw_vector_serializable_v<T, inner_magic>) {
+      if (v.is_vector() && store_raw_vector_T<T>(v)) {
+        return;
+      }
     }
 
     for (int64_t i = 0; i < n; ++i) {
@@ -389,8 +417,8 @@ struct t_Vector {
     }
     out.reserve(n, true);
 
-    if (std::is_same<T, t_Double>{} && inner_magic == 0) {
-      fetch_raw_vector_T<typename T::PhpType>(out, n);
+    if constexpr (is_raw_vector_serializable_v<T, inner_magic>) {
+      fetch_raw_vector_T<T>(out, n);
       return;
     }
 
@@ -606,9 +634,10 @@ struct t_Tuple {
   using PhpType = array<typename T::PhpType>;
 
   void typed_store(const PhpType &v) {
-    if (std::is_same<T, t_Double>{} && inner_magic == 0 && v.is_vector() && v.count() == size) {
-      store_raw_vector_T<typename T::PhpType>(v);
-      return;
+    if constexpr (is_raw_vector_serializable_v<T, inner_magic>) {
+      if (v.is_vector() && v.count() == size && store_raw_vector_T<T>(v)) {
+        return;
+      }
     }
 
     for (int64_t i = 0; i < size; ++i) {
@@ -625,8 +654,8 @@ struct t_Tuple {
     CHECK_EXCEPTION(return);
     out.reserve(size, true);
 
-    if (std::is_same<T, t_Double>{} && inner_magic == 0) {
-      fetch_raw_vector_T<typename T::PhpType>(out, size);
+    if constexpr (is_raw_vector_serializable_v<T, inner_magic>) {
+      fetch_raw_vector_T<T>(out, size);
       return;
     }
 
@@ -679,9 +708,10 @@ struct tl_array {
   using PhpType = array<typename T::PhpType>;
 
   void typed_store(const PhpType &v) {
-    if (std::is_same<T, t_Double>{} && inner_magic == 0 && v.is_vector() && v.count() == size) {
-      store_raw_vector_T<typename T::PhpType>(v);
-      return;
+    if constexpr (is_raw_vector_serializable_v<T, inner_magic>) {
+      if (v.is_vector() && v.count() == size && store_raw_vector_T<T>(v)) {
+        return;
+      }
     }
 
     for (int64_t i = 0; i < size; ++i) {
@@ -698,8 +728,8 @@ struct tl_array {
     CHECK_EXCEPTION(return);
     out.reserve(size, true);
 
-    if (std::is_same<T, t_Double>{} && inner_magic == 0) {
-      fetch_raw_vector_T<typename T::PhpType>(out, size);
+    if constexpr (is_raw_vector_serializable_v<T, inner_magic>) {
+      fetch_raw_vector_T<T>(out, size);
       return;
     }
 
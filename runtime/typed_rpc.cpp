@@ -244,8 +244,17 @@ array<class_instance<C$VK$TL$RpcResponse>> typed_rpc_tl_query_result_synchronous
   return sort_rpc_results(unsorted_results, query_ids, error_factory);
 }
 
+void f$typed_rpc_tl_set_lazy_results(bool lazy) {
+  RpcLazyResults::get().set_enabled(lazy);
+}
+
+class_instance<C$VK$TL$RpcFunctionReturnResult> f$typed_rpc_tl_fetch_lazy_result(const class_instance<C$VK$TL$RpcFunctionReturnResult> &result) {
+  return RpcLazyResults::fetch(result);
+}
+
 void free_typed_rpc_lib() {
   CurrentProcessingQuery::get().reset();
   RpcPendingQueries::get().hard_reset();
+  RpcLazyResults::get().reset();
   CurrentRpcServerQuery::get().reset();
 }
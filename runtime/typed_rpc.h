@@ -81,4 +81,7 @@ array<class_instance<C$VK$TL$RpcResponse>> f$typed_rpc_tl_query_result_synchrono
   return typed_rpc_tl_query_result_synchronously_impl(query_ids, F::get());
 }
 
+void f$typed_rpc_tl_set_lazy_results(bool lazy);
+class_instance<C$VK$TL$RpcFunctionReturnResult> f$typed_rpc_tl_fetch_lazy_result(const class_instance<C$VK$TL$RpcFunctionReturnResult> &result);
+
 void free_typed_rpc_lib();
@@ -4,8 +4,10 @@
 
 #include "runtime/vkext.h"
 
+#include <array>
 #include <sys/time.h>
 
+#include "common/algorithms/simd-utf8.h"
 #include "common/string-processing.h"
 #include "flex/flex.h"
 
@@ -267,7 +269,15 @@ int utf8_to_win(const char *s, int len, int64_t max_len, bool exit_on_error) {
       break;
     }
     int c = static_cast<unsigned char>(s[i]);
-    if (c < 0x80) {
+    if (c < 0x80 && !st) {
+      // ASCII characters are the same in both encodings, so the whole run is copied at once
+      int64_t run_len = simd_ascii_prefix_length(s + i, len - i);
+      if (max_len) {
+        run_len = min(run_len, max_len - cur_buff_len);
+      }
+      write_buff(s + i, static_cast<int>(run_len));
+      i += static_cast<int>(run_len) - 1;
+    } else if (c < 0x80) {
       if (st) {
         if (exit_on_error) {
           return -1;
@@ -424,11 +434,71 @@ void write_char_utf8_no_escape(int64_t c) {
   }
 }
 
+struct win_char_utf8 {
+  char bytes[3];
+  uint8_t len;
+};
+
+// UTF-8 representations of all the cp1251 characters, they are not longer than 3 bytes
+static const win_char_utf8 *get_win_to_utf8_table() {
+  static const auto table = [] {
+    std::array<win_char_utf8, 256> res{};
+    for (int i = 0; i < 256; i++) {
+      const int c = win_to_utf8_convert[i];
+      win_char_utf8 &r = res[i];
+      if (c == 0) {
+        r.len = 0;
+      } else if (c < 0x80) {
+        r.bytes[0] = static_cast<char>(c);
+        r.len = 1;
+      } else if (c < 0x800) {
+        r.bytes[0] = static_cast<char>(0xC0 + (c >> 6));
+        r.bytes[1] = static_cast<char>(0x80 + (c & 63));
+        r.len = 2;
+      } else {
+        php_assert (c < 0x10000);
+        r.bytes[0] = static_cast<char>(0xE0 + (c >> 12));
+        r.bytes[1] = static_cast<char>(0x80 + ((c >> 6) & 63));
+        r.bytes[2] = static_cast<char>(0x80 + (c & 63));
+        r.len = 3;
+      }
+    }
+    return res;
+  }();
+  return table.data();
+}
+
+// the same as write_char_utf8(win_to_utf8_convert[c]) for each character, but without per character buffer checks
+static void write_win_run_utf8(const char *s, int len) {
+  const win_char_utf8 *table = get_win_to_utf8_table();
+  while (len > 0) {
+    if (unlikely (wptr > buff + BUFF_LEN - 3)) {
+      flush_buff();
+    }
+    const int chunk_len = min(len, static_cast<int>(buff + BUFF_LEN - wptr) / 3);
+    for (int i = 0; i < chunk_len; i++) {
+      const win_char_utf8 &c = table[static_cast<unsigned char>(s[i])];
+      memcpy(wptr, c.bytes, 3);
+      wptr += c.len;
+    }
+    s += chunk_len;
+    len -= chunk_len;
+  }
+}
+
 static int win_to_utf8(const char *s, int len, bool escape) {
   int state = 0;
   int save_pos = -1;
   int64_t cur_num = 0;
   for (int i = 0; i < len; i++) {
+    if (state == 0 && s[i] != '&') {
+      // only "&#...;" sequences need the state machine, everything before the next '&' is converted by the table
+      const auto *amp = static_cast<const char *>(memchr(s + i, '&', len - i));
+      const int run_end = amp ? static_cast<int>(amp - s) : len;
+      write_win_run_utf8(s + i, run_end - i);
+      i = run_end - 1;
+      continue;
+    }
     if (state == 0 && s[i] == '&') {
       save_pos = cur_buff_len;
       cur_num = 0;
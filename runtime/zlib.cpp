@@ -4,8 +4,11 @@
 
 #include "runtime/zlib.h"
 
+#include <string>
+
 #include "runtime/critical_section.h"
 #include "runtime/string_functions.h"
+#include "runtime/thread-pool.h"
 
 namespace {
 voidpf zlib_static_alloc(voidpf opaque, uInt items, uInt size) {
@@ -27,6 +30,45 @@ voidpf zlib_dynamic_alloc(voidpf opaque __attribute__((unused)), uInt items, uIn
 void zlib_dynamic_free(voidpf opaque __attribute__((unused)), voidpf address) {
   dl::script_allocator_free(address);
 }
+
+// works in a pool thread, so zlib uses the default heap allocator here; the output is the same as zlib_encode() produces
+class ZlibEncodeTask final : public ThreadPoolTaskWithResult<string> {
+public:
+  ZlibEncodeTask(const string &s, int32_t level, int32_t encoding)
+    : data_(s.c_str(), s.size())
+    , level_(level)
+    , encoding_(encoding) {}
+
+  void run() noexcept final {
+    z_stream strm{};
+    encoded_.resize(compressBound(data_.size()) + 30);
+    if (deflateInit2(&strm, level_, Z_DEFLATED, encoding_, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+      return;
+    }
+    strm.avail_in = static_cast<unsigned int>(data_.size());
+    strm.next_in = reinterpret_cast<Bytef *>(data_.data());
+    strm.avail_out = static_cast<unsigned int>(encoded_.size());
+    strm.next_out = reinterpret_cast<Bytef *>(encoded_.data());
+    success_ = deflate(&strm, Z_FINISH) == Z_STREAM_END;
+    deflateEnd(&strm);
+    encoded_.resize(strm.total_out);
+  }
+
+  string make_result() noexcept final {
+    if (!success_) {
+      php_warning("Error during pack of string with length %zu", data_.size());
+      return {};
+    }
+    return string{encoded_.data(), static_cast<string::size_type>(encoded_.size())};
+  }
+
+private:
+  std::string data_;
+  std::string encoded_;
+  int32_t level_;
+  int32_t encoding_;
+  bool success_{false};
+};
 } // namespace
 
 const string_buffer *zlib_encode(const char *s, int32_t s_len, int32_t level, int32_t encoding) {
@@ -221,6 +263,16 @@ string f$gzcompress(const string &s, int64_t level) {
   return zlib_encode(s.c_str(), s.size(), static_cast<int32_t>(level), ZLIB_ENCODING_DEFLATE)->str();
 }
 
+int64_t f$thread_pool_gzcompress(const string &s, int64_t level) {
+  if (level < -1 || level > 9) {
+    php_warning("Wrong parameter level = %" PRIi64 " in function thread_pool_gzcompress", level);
+    level = 6;
+  }
+
+  dl::CriticalSectionGuard critical_section;
+  return start_thread_pool_task<string>(std::make_unique<ZlibEncodeTask>(s, static_cast<int32_t>(level), ZLIB_ENCODING_DEFLATE));
+}
+
 string f$gzdeflate(const string &s, int64_t level) {
   if (level < -1 || level > 9) {
     php_warning("Wrong parameter level = %" PRIi64 " in function gzcompress", level);
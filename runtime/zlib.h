@@ -36,6 +36,9 @@ Optional<string> f$deflate_add(const class_instance<C$DeflateContext> & context,
 
 string f$gzcompress(const string &s, int64_t level = -1);
 
+// returns a future of the compressed string, which is compressed in the thread pool
+int64_t f$thread_pool_gzcompress(const string &s, int64_t level = -1);
+
 const char *gzuncompress_raw(vk::string_view s, string::size_type *result_len);
 
 string f$gzuncompress(const string &s);
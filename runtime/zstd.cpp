@@ -4,11 +4,14 @@
 
 #define ZSTD_STATIC_LINKING_ONLY
 
+#include <string>
 #include <zstd.h>
 
 #include "common/smart_ptrs/unique_ptr_with_delete_function.h"
 
+#include "runtime/critical_section.h"
 #include "runtime/string_functions.h"
+#include "runtime/thread-pool.h"
 
 #include "runtime/zstd.h"
 
@@ -128,19 +131,62 @@ Optional<string> zstd_uncompress_impl(const string &data, const string &dict = s
   return decoded_string;
 }
 
-} // namespace
+// works in a pool thread, so zstd uses the default heap allocator here
+class ZstdCompressTask final : public ThreadPoolTaskWithResult<Optional<string>> {
+public:
+  ZstdCompressTask(const string &data, int64_t level)
+    : data_(data.c_str(), data.size())
+    , level_(static_cast<int>(level)) {}
 
-Optional<string> f$zstd_compress(const string &data, int64_t level) noexcept {
+  void run() noexcept final {
+    encoded_.resize(ZSTD_compressBound(data_.size()));
+    result_ = ZSTD_compress(encoded_.data(), encoded_.size(), data_.data(), data_.size(), level_);
+  }
+
+  Optional<string> make_result() noexcept final {
+    if (ZSTD_isError(result_)) {
+      php_warning("thread_pool_zstd_compress: got zstd compression error: %s", ZSTD_getErrorName(result_));
+      return false;
+    }
+    return string{encoded_.data(), static_cast<string::size_type>(result_)};
+  }
+
+private:
+  std::string data_;
+  std::string encoded_;
+  int level_;
+  size_t result_{0};
+};
+
+bool check_compress_level(const char *function, int64_t level) noexcept {
   const int min_level = ZSTD_minCLevel();
   const int max_level = ZSTD_maxCLevel();
   if (min_level > level || level > max_level) {
-    php_warning("zstd_compress: compression level (%" PRIi64 ") must be within %d..%d or equal to 0", level, min_level, max_level);
+    php_warning("%s: compression level (%" PRIi64 ") must be within %d..%d or equal to 0", function, level, min_level, max_level);
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+Optional<string> f$zstd_compress(const string &data, int64_t level) noexcept {
+  if (!check_compress_level("zstd_compress", level)) {
     return false;
   }
 
   return zstd_compress_impl(data, level);
 }
 
+Optional<int64_t> f$thread_pool_zstd_compress(const string &data, int64_t level) noexcept {
+  if (!check_compress_level("thread_pool_zstd_compress", level)) {
+    return false;
+  }
+
+  dl::CriticalSectionGuard critical_section;
+  return start_thread_pool_task<Optional<string>>(std::make_unique<ZstdCompressTask>(data, level));
+}
+
 Optional<string> f$zstd_uncompress(const string &data) noexcept {
   return zstd_uncompress_impl(data);
 }
@@ -11,6 +11,9 @@ constexpr int DEFAULT_COMPRESS_LEVEL = 3;
 
 Optional<string> f$zstd_compress(const string &data, int64_t level = DEFAULT_COMPRESS_LEVEL) noexcept;
 
+// returns a future of the compressed data, which is compressed in the thread pool
+Optional<int64_t> f$thread_pool_zstd_compress(const string &data, int64_t level = DEFAULT_COMPRESS_LEVEL) noexcept;
+
 Optional<string> f$zstd_uncompress(const string &data) noexcept;
 
 Optional<string> f$zstd_compress_dict(const string &data, const string &dict) noexcept;
@@ -0,0 +1,155 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "common/mixin/not_copyable.h"
+
+// Log-linear histograms of uint64 values (like HdrHistogram):
+// values less than 2^SUB_BUCKET_BITS have their own buckets, each power of two above is split into 2^SUB_BUCKET_BITS buckets,
+// so a bucket is narrower than 1/16 of its values, and a quantile is reported with a relative error below 1/32 (bucket middle).
+// Histograms are merged by summing buckets, so workers write them to shared memory and the master merges them cheaply.
+namespace log_histogram {
+
+constexpr size_t SUB_BUCKET_BITS = 4;
+constexpr size_t SUB_BUCKETS_COUNT = 1 << SUB_BUCKET_BITS;
+constexpr size_t BUCKETS_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS_COUNT;
+
+inline size_t bucket_index(uint64_t value) noexcept {
+  if (value < SUB_BUCKETS_COUNT) {
+    return value;
+  }
+  const size_t exponent = 63 - __builtin_clzll(value);
+  const size_t shift = exponent - SUB_BUCKET_BITS;
+  return (shift + 1) * SUB_BUCKETS_COUNT + ((value >> shift) & (SUB_BUCKETS_COUNT - 1));
+}
+
+// the middle of a bucket
+inline uint64_t bucket_value(size_t index) noexcept {
+  if (index < SUB_BUCKETS_COUNT) {
+    return index;
+  }
+  const size_t shift = index / SUB_BUCKETS_COUNT - 1;
+  const uint64_t lower_bound = (SUB_BUCKETS_COUNT + index % SUB_BUCKETS_COUNT) << shift;
+  return lower_bound + ((uint64_t{1} << shift) - 1) / 2;
+}
+
+} // namespace log_histogram
+
+// Is written by workers concurrently, lock-free
+struct SharedLogHistogram : private vk::not_copyable {
+  void add(uint64_t value) noexcept {
+    buckets[log_histogram::bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t cur_max = max.load(std::memory_order_relaxed);
+    while (cur_max < value && !max.compare_exchange_weak(cur_max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  std::array<std::atomic<uint64_t>, log_histogram::BUCKETS_COUNT> buckets{};
+  std::atomic<uint64_t> max{0};
+};
+
+// Is owned by the master: it periodically moves shared histograms into a window of recent intervals and calculates quantiles over it
+class WindowLogHistogram : private vk::not_copyable {
+public:
+  struct Quantiles {
+    uint64_t p50{0};
+    uint64_t p75{0};
+    uint64_t p90{0};
+    uint64_t p95{0};
+    uint64_t p99{0};
+    uint64_t p999{0};
+    uint64_t max{0};
+  };
+
+  void recalc(SharedLogHistogram &shared, std::chrono::steady_clock::time_point now_tp, std::chrono::steady_clock::duration window) noexcept {
+    for (auto &interval : intervals_) {
+      if (interval.total && now_tp - interval.tp > window) {
+        forget_interval(interval);
+      }
+    }
+
+    Interval &interval = intervals_[next_interval_];
+    next_interval_ = (next_interval_ + 1) % intervals_.size();
+    forget_interval(interval);
+    interval.tp = now_tp;
+    for (size_t i = 0; i != log_histogram::BUCKETS_COUNT; ++i) {
+      const uint64_t count = shared.buckets[i].exchange(0, std::memory_order_relaxed);
+      interval.buckets[i] = count;
+      interval.total += count;
+      window_buckets_[i] += count;
+    }
+    window_total_ += interval.total;
+    // workers update the max after buckets, so it's taken after them as well
+    interval.max = shared.max.exchange(0, std::memory_order_relaxed);
+
+    quantiles = calc_quantiles();
+  }
+
+  Quantiles quantiles;
+
+private:
+  // intervals are assumed to be at least 5 seconds long, so a minute window fits
+  static constexpr size_t INTERVALS_COUNT = 13;
+
+  struct Interval {
+    std::chrono::steady_clock::time_point tp;
+    std::array<uint32_t, log_histogram::BUCKETS_COUNT> buckets{};
+    uint64_t total{0};
+    uint64_t max{0};
+  };
+
+  void forget_interval(Interval &interval) noexcept {
+    if (interval.total) {
+      for (size_t i = 0; i != log_histogram::BUCKETS_COUNT; ++i) {
+        window_buckets_[i] -= interval.buckets[i];
+      }
+      window_total_ -= interval.total;
+      interval.buckets.fill(0);
+      interval.total = 0;
+    }
+    interval.max = 0;
+  }
+
+  Quantiles calc_quantiles() const noexcept {
+    Quantiles result;
+    for (const auto &interval : intervals_) {
+      result.max = std::max(result.max, interval.max);
+    }
+    if (!window_total_) {
+      return result;
+    }
+    // the same ranks as for nth_element over sorted samples: P * (size - 1) / 100
+    const std::array<std::pair<uint64_t, uint64_t *>, 6> ranks{{
+      {50 * (window_total_ - 1) / 100, &result.p50},
+      {75 * (window_total_ - 1) / 100, &result.p75},
+      {90 * (window_total_ - 1) / 100, &result.p90},
+      {95 * (window_total_ - 1) / 100, &result.p95},
+      {99 * (window_total_ - 1) / 100, &result.p99},
+      {999 * (window_total_ - 1) / 1000, &result.p999},
+    }};
+    size_t rank_index = 0;
+    uint64_t seen = 0;
+    for (size_t i = 0; i != log_histogram::BUCKETS_COUNT && rank_index != ranks.size(); ++i) {
+      seen += window_buckets_[i];
+      while (rank_index != ranks.size() && ranks[rank_index].first < seen) {
+        // the exact max is better than the middle of its bucket
+        *ranks[rank_index++].second = std::min(log_histogram::bucket_value(i), result.max);
+      }
+    }
+    return result;
+  }
+
+  std::array<Interval, INTERVALS_COUNT> intervals_{};
+  size_t next_interval_{0};
+  std::array<uint64_t, log_histogram::BUCKETS_COUNT> window_buckets_{};
+  uint64_t window_total_{0};
+};
@@ -0,0 +1,294 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/master-rpc-proxy.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <tuple>
+#include <unistd.h>
+
+#include "common/kprintf.h"
+#include "common/rpc-error-codes.h"
+#include "common/tl/constants/common.h"
+#include "net/net-connections.h"
+#include "net/net-msg.h"
+#include "net/net-sockaddr-storage.h"
+#include "net/net-socket.h"
+#include "net/net-tcp-rpc-client.h"
+#include "net/net-tcp-rpc-common.h"
+#include "net/net-tcp-rpc-server.h"
+
+#include "server/php-engine.h"
+
+namespace {
+
+// crc32 of "rpcProxyDest ip:int port:int timeout_ms:int = RpcProxyDest"
+constexpr int RPC_PROXY_DEST = 0xa2ca9d07;
+// op and req_id
+constexpr int RPC_HEADER_INTS = 3;
+constexpr int PROXY_DEST_INTS = 4;
+
+int proxy_worker_execute(connection *c, int op, raw_message *raw) {
+  if (op != TL_RPC_INVOKE_REQ) {
+    return 0;
+  }
+  return vk::singleton<MasterRpcProxy>::get().forward_query(c, raw);
+}
+
+int proxy_backend_execute(connection *c __attribute__((unused)), int op, raw_message *raw) {
+  if (op != TL_RPC_REQ_RESULT && op != TL_RPC_REQ_ERROR) {
+    return 0;
+  }
+  return vk::singleton<MasterRpcProxy>::get().forward_answer(raw);
+}
+
+int proxy_worker_check_perm(connection *c) {
+  if (!MasterRpcProxy::is_trusted_peer(c->fd)) {
+    kprintf("outbound rpc proxy rejects connection %d of a foreign peer\n", c->fd);
+    return -1;
+  }
+  return tcp_rpcs_default_check_perm(c);
+}
+
+// Receives queries from workers
+tcp_rpc_server_functions proxy_worker_functions = [] {
+  auto res = tcp_rpc_server_functions();
+  res.execute = proxy_worker_execute;
+  res.check_ready = server_check_ready;
+  res.flush_packet = tcp_rpcs_flush_packet;
+  res.rpc_check_perm = proxy_worker_check_perm;
+  res.rpc_init_crypto = tcp_rpcs_init_crypto;
+  return res;
+}();
+
+// Receives backend answers; packets are passed through as is, so they are never zstd packed
+tcp_rpc_client_functions proxy_backend_functions = [] {
+  auto res = tcp_rpc_client_functions();
+  res.execute = proxy_backend_execute;
+  res.check_ready = rpcc_check_ready;
+  res.flush_packet = tcp_rpcc_flush_packet_later;
+  res.rpc_check_perm = tcp_rpcc_default_check_perm;
+  res.rpc_init_crypto = tcp_rpcc_init_crypto;
+  res.rpc_start_crypto = tcp_rpcc_start_crypto;
+  res.rpc_ready = rpcc_send_query;
+  return res;
+}();
+
+void send_to_backend(connection *c, raw_message_t *raw, int flags) {
+  tcp_rpc_conn_send(c, raw, flags);
+  TCP_RPCC_FUNC(c)->flush_packet(c);
+  c->last_query_sent_time = precise_now;
+}
+
+// a query waiting for a backend connection
+struct proxy_command_t {
+  command_t base;
+  raw_message_t raw;
+  long long proxy_req_id;
+};
+
+void proxy_command_run(command_t *base_command, void *data) {
+  auto *command = reinterpret_cast<proxy_command_t *>(base_command);
+  if (data == nullptr) {
+    vk::singleton<MasterRpcProxy>::get().fail_query(command->proxy_req_id, "Failed to send query, timeout expired");
+    return;
+  }
+  send_to_backend(static_cast<connection *>(data), &command->raw, 1);
+}
+
+void proxy_command_free(command_t *base_command) {
+  auto *command = reinterpret_cast<proxy_command_t *>(base_command);
+  rwm_free(&command->raw);
+  free(command);
+}
+
+} // namespace
+
+bool MasterRpcProxy::init_master() noexcept {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, socket_path_.c_str(), sizeof(addr.sun_path) - 1);
+  const int fd = server_socket_unix(&addr, backlog, SM_UNIX);
+  if (fd < 0) {
+    return false;
+  }
+  // peers are checked on accept as well, as the socket is connectable until chmod
+  if (chmod(addr.sun_path, S_IRUSR | S_IWUSR) < 0) {
+    kprintf("can't chmod outbound rpc proxy socket %s: %m\n", addr.sun_path);
+    close(fd);
+    return false;
+  }
+  if (init_listening_connection_mode(fd, &ct_tcp_rpc_server, &proxy_worker_functions, SM_UNIX) < 0) {
+    close(fd);
+    return false;
+  }
+  vkprintf(1, "outbound rpc proxy listens at %s\n", socket_path_.c_str());
+  return true;
+}
+
+void MasterRpcProxy::init_worker() noexcept {
+  // the master state is inherited by fork, but it makes no sense here
+  routes_.clear();
+  timeouts_ = {};
+  backend_targets_.clear();
+
+  // workers don't connect to backends themselves, targets are used for their addresses only
+  rpc_ct.min_connections = 0;
+  conn_target_t ct = rpc_ct;
+  ct.min_connections = 1;
+  ct.max_connections = 1;
+  ct.endpoint = make_unix_sockaddr_storage(socket_path_.c_str(), 0);
+  worker_target_ = static_cast<int>(create_target(&ct, nullptr) - Targets);
+}
+
+bool MasterRpcProxy::is_trusted_peer(int fd) noexcept {
+  ucred creds{};
+  socklen_t len = sizeof(creds);
+  return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &creds, &len) == 0 && creds.uid == getuid();
+}
+
+bool MasterRpcProxy::is_valid_destination(const int *dest) noexcept {
+  return dest[0] == RPC_PROXY_DEST && dest[1] != 0 && dest[2] > 0 && dest[2] < 0x10000;
+}
+
+void MasterRpcProxy::set_target_destination(int target_id, const sockaddr_storage &endpoint) noexcept {
+  if (endpoint.ss_family == AF_INET) {
+    target_destinations_[target_id] = {inet_sockaddr_address(&endpoint), inet_sockaddr_port(&endpoint)};
+  } else {
+    target_destinations_.erase(target_id);
+  }
+}
+
+bool MasterRpcProxy::get_target_destination(int target_id, uint32_t &ip, uint16_t &port) const noexcept {
+  const auto it = target_destinations_.find(target_id);
+  if (it == target_destinations_.end()) {
+    return false;
+  }
+  std::tie(ip, port) = it->second;
+  return true;
+}
+
+std::vector<int> &MasterRpcProxy::wrap_query(uint32_t ip, uint16_t port, int timeout_ms, const int *request, int request_size) noexcept {
+  static std::vector<int> wrapped;
+  // the packet length and number precede the header, crc follows the query
+  const int prefix_ints = 2 + RPC_HEADER_INTS;
+  const int request_ints = request_size / static_cast<int>(sizeof(int));
+  wrapped.resize(request_ints + PROXY_DEST_INTS);
+  std::copy(request, request + prefix_ints, wrapped.begin());
+  wrapped[0] = static_cast<int>(wrapped.size() * sizeof(int));
+  wrapped[prefix_ints] = RPC_PROXY_DEST;
+  wrapped[prefix_ints + 1] = static_cast<int>(ip);
+  wrapped[prefix_ints + 2] = port;
+  wrapped[prefix_ints + 3] = timeout_ms;
+  std::copy(request + prefix_ints, request + request_ints, wrapped.begin() + prefix_ints + PROXY_DEST_INTS);
+  return wrapped;
+}
+
+int MasterRpcProxy::forward_query(connection *worker_conn, raw_message *raw) noexcept {
+  int header[RPC_HEADER_INTS + PROXY_DEST_INTS];
+  if (raw->total_bytes < static_cast<int>(sizeof(header)) || rwm_fetch_data(raw, header, sizeof(header)) != sizeof(header)) {
+    return 0;
+  }
+  long long worker_req_id = 0;
+  std::memcpy(&worker_req_id, header + 1, sizeof(worker_req_id));
+  const int *dest = header + RPC_HEADER_INTS;
+  if (!is_valid_destination(dest)) {
+    server_rpc_error(worker_conn, worker_req_id, TL_ERROR_QUERY_INCORRECT, "Wrong destination of proxied query");
+    return 0;
+  }
+
+  conn_target_t *target = get_backend_target(static_cast<uint32_t>(dest[1]), static_cast<uint16_t>(dest[2]));
+  const double timeout_at = precise_now + fix_timeout(dest[3] * 0.001);
+  const long long proxy_req_id = add_route(worker_conn, worker_req_id, timeout_at);
+  header[0] = TL_RPC_INVOKE_REQ;
+  std::memcpy(header + 1, &proxy_req_id, sizeof(proxy_req_id));
+  rwm_push_data_front(raw, header, RPC_HEADER_INTS * sizeof(int));
+
+  if (connection *conn = get_target_connection(target, 0)) {
+    send_to_backend(conn, raw, 0);
+    return 1;
+  }
+  if (create_new_connections(target) <= 0 && get_target_connection(target, 1) == nullptr) {
+    fail_query(proxy_req_id, "Failed to establish connection [probably reconnect timeout is not expired]");
+    return 0;
+  }
+  auto *command = static_cast<proxy_command_t *>(malloc(sizeof(proxy_command_t)));
+  command->base.run = proxy_command_run;
+  command->base.free = proxy_command_free;
+  rwm_steal(&command->raw, raw);
+  command->proxy_req_id = proxy_req_id;
+  create_delayed_send_query(target, &command->base, timeout_at);
+  return 0;
+}
+
+int MasterRpcProxy::forward_answer(raw_message *raw) noexcept {
+  int header[RPC_HEADER_INTS];
+  if (rwm_fetch_data(raw, header, sizeof(header)) != sizeof(header)) {
+    return 0;
+  }
+  long long proxy_req_id = 0;
+  std::memcpy(&proxy_req_id, header + 1, sizeof(proxy_req_id));
+  long long worker_req_id = 0;
+  connection *worker_conn = pop_route(proxy_req_id, worker_req_id);
+  if (worker_conn == nullptr) {
+    return 0;
+  }
+  std::memcpy(header + 1, &worker_req_id, sizeof(worker_req_id));
+  rwm_push_data_front(raw, header, sizeof(header));
+  tcp_rpc_conn_send(worker_conn, raw, 0);
+  TCP_RPCS_FUNC(worker_conn)->flush_packet(worker_conn);
+  return 1;
+}
+
+void MasterRpcProxy::fail_query(long long proxy_req_id, const char *error) noexcept {
+  long long worker_req_id = 0;
+  if (connection *worker_conn = pop_route(proxy_req_id, worker_req_id)) {
+    server_rpc_error(worker_conn, worker_req_id, TL_ERROR_NO_CONNECTIONS_IN_RPC_CLIENT, error);
+  }
+}
+
+void MasterRpcProxy::expire_queries(double now) noexcept {
+  while (!timeouts_.empty() && timeouts_.top().first <= now) {
+    routes_.erase(timeouts_.top().second);
+    timeouts_.pop();
+  }
+}
+
+long long MasterRpcProxy::add_route(connection *worker_conn, long long worker_req_id, double timeout_at) noexcept {
+  const long long proxy_req_id = ++last_proxy_req_id_;
+  routes_.emplace(proxy_req_id, Route{worker_conn, worker_conn->generation, worker_req_id});
+  timeouts_.emplace(timeout_at, proxy_req_id);
+  return proxy_req_id;
+}
+
+connection *MasterRpcProxy::pop_route(long long proxy_req_id, long long &worker_req_id) noexcept {
+  auto it = routes_.find(proxy_req_id);
+  if (it == routes_.end()) {
+    return nullptr;
+  }
+  const Route route = it->second;
+  routes_.erase(it);
+  // the worker connection may be closed and even reused by another worker
+  if (route.worker_conn->generation != route.worker_generation) {
+    return nullptr;
+  }
+  worker_req_id = route.worker_req_id;
+  return route.worker_conn;
+}
+
+conn_target_t *MasterRpcProxy::get_backend_target(uint32_t ip, uint16_t port) noexcept {
+  conn_target_t *&target = backend_targets_[(uint64_t{ip} << 16) | port];
+  if (target == nullptr) {
+    conn_target_t ct = rpc_ct;
+    ct.extra = &proxy_backend_functions;
+    ct.endpoint = make_inet_sockaddr_storage(ip, port);
+    target = create_target(&ct, nullptr);
+  }
+  return target;
+}
@@ -0,0 +1,103 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+#include <queue>
+#include <string>
+#include <sys/socket.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/mixin/not_copyable.h"
+#include "common/smart_ptrs/singleton.h"
+
+struct connection;
+struct raw_message;
+typedef struct conn_target conn_target_t;
+
+// Outbound RPC proxy in master: workers send RPC queries to master over a unix socket instead of connecting to backends,
+// master forwards them over its own persistent connections and routes answers back.
+// So a backend gets a few connections from a server instead of connections from each worker, and restarted workers don't handshake with backends.
+// A worker prepends the destination to a query body: [op, req_id, rpcProxyDest ip:int port:int timeout_ms:int, query...],
+// master replaces req_id with a unique one for the backend and restores it in the answer.
+class MasterRpcProxy : vk::not_copyable {
+public:
+  friend class vk::singleton<MasterRpcProxy>;
+
+  // the unix socket path with its "port" suffix must fit into sockaddr_un
+  static constexpr size_t MAX_SOCKET_PATH_LEN = 100;
+
+  void set_socket_path(const char *path) noexcept {
+    socket_path_ = path;
+  }
+
+  bool enabled() const noexcept {
+    return !socket_path_.empty();
+  }
+
+  // is called by master once, before workers start
+  bool init_master() noexcept;
+  // is called by each worker after fork
+  void init_worker() noexcept;
+
+  // worker: the target of the master connection, -1 if queries are sent to backends directly
+  int worker_target() const noexcept {
+    return worker_target_;
+  }
+
+  // worker: remembers the inet address of a target, as create_target() replaces a localhost address with a unix socket of the engine;
+  // master gets the address and makes the same replacement on its side
+  void set_target_destination(int target_id, const sockaddr_storage &endpoint) noexcept;
+  // worker: returns false if the target wasn't created by an inet address
+  bool get_target_destination(int target_id, uint32_t &ip, uint16_t &port) const noexcept;
+
+  // worker: prepends the destination to a query prepared for send_rpc_query(): [len, seq, op, req_id, query..., crc]
+  static std::vector<int> &wrap_query(uint32_t ip, uint16_t port, int timeout_ms, const int *request, int request_size) noexcept;
+
+  // master: only processes of the same user may send queries, so master isn't an open relay for local users
+  static bool is_trusted_peer(int fd) noexcept;
+  // master: dest is [rpcProxyDest, ip, port, timeout_ms] from a query of a worker
+  static bool is_valid_destination(const int *dest) noexcept;
+
+  // master: a query from a worker; returns 1 if the message is taken
+  int forward_query(connection *worker_conn, raw_message *raw) noexcept;
+  // master: an answer or an error from a backend; returns 1 if the message is taken
+  int forward_answer(raw_message *raw) noexcept;
+  // master: answers a worker with an error, if it still waits for the query
+  void fail_query(long long proxy_req_id, const char *error) noexcept;
+  // master: forgets the queries, which workers don't wait anymore
+  void expire_queries(double now) noexcept;
+
+  long long add_route(connection *worker_conn, long long worker_req_id, double timeout_at) noexcept;
+  // returns nullptr if the query is unknown or expired, or the worker connection is closed
+  connection *pop_route(long long proxy_req_id, long long &worker_req_id) noexcept;
+
+  size_t routes_count() const noexcept {
+    return routes_.size();
+  }
+
+private:
+  MasterRpcProxy() = default;
+
+  conn_target_t *get_backend_target(uint32_t ip, uint16_t port) noexcept;
+
+  struct Route {
+    connection *worker_conn{nullptr};
+    int worker_generation{0};
+    long long worker_req_id{0};
+  };
+
+  std::string socket_path_;
+  int worker_target_{-1};
+
+  long long last_proxy_req_id_{0};
+  std::unordered_map<long long, Route> routes_;
+  // timeouts of routes, the earliest first; answered queries are skipped lazily
+  std::priority_queue<std::pair<double, long long>, std::vector<std::pair<double, long long>>, std::greater<>> timeouts_;
+  std::unordered_map<uint64_t, conn_target_t *> backend_targets_;
+  std::unordered_map<int, std::pair<uint32_t, uint16_t>> target_destinations_;
+};
@@ -74,6 +74,7 @@
 #include "server/lease-config-parser.h"
 #include "server/lease-context.h"
 #include "server/master-name.h"
+#include "server/master-rpc-proxy.h"
 #include "server/numa-configuration.h"
 #include "server/php-engine-vars.h"
 #include "server/php-init-scripts.h"
@@ -85,6 +86,8 @@
 #include "server/php-runner.h"
 #include "server/php-sql-connections.h"
 #include "server/php-worker.h"
+#include "server/rpc-connection-groups.h"
+#include "server/rpc-zstd-packing.h"
 #include "server/server-config.h"
 #include "server/server-log.h"
 #include "server/server-stats.h"
@@ -126,6 +129,7 @@ tcp_rpc_client_functions tcp_rpc_client_outbound = [] {
   res.rpc_init_crypto = tcp_rpcc_init_crypto;
   res.rpc_start_crypto = tcp_rpcc_start_crypto;
   res.rpc_ready = rpcc_send_query; //replaced
+  res.mode_flags = RPC_CRYPTO_ZSTD_PACKED;
 
   return res;
 }();
@@ -189,6 +193,8 @@ int get_target_impl(conn_target_t *ct) {
   //TODO: fix ref_cnt overflow
   conn_target_t *res = create_target(ct, nullptr);
   int res_id = (int)(res - Targets);
+  // the address before create_target() replaces localhost with a unix socket, it's sent to the outbound rpc proxy in master
+  vk::singleton<MasterRpcProxy>::get().set_target_destination(res_id, ct->endpoint);
   return res_id;
 }
 
@@ -269,6 +275,7 @@ void command_net_write_run_rpc(command_t *base_command, void *data) {
   assert (command->data != nullptr);
   if (data == nullptr) { //send to /dev/null
     vkprintf (3, "failed to send rpc request %d\n", slot_id);
+    vk::singleton<RpcConnectionGroups>::get().on_query_finished(slot_id, false, precise_now);
     on_net_event(create_rpc_error_event(slot_id, TL_ERROR_NO_CONNECTIONS_IN_RPC_CLIENT, "Failed to send query, timeout expired", nullptr));
   } else {
     auto *d = (connection *)data;
@@ -344,7 +351,13 @@ void send_rpc_query(connection *c, int op, long long id, int *q, int qsize) {
   }
 
   vkprintf (4, "send_rpc_query: [len = %d] [op = %08x] [rpc_id = <%lld>]\n", q[0], op, id);
-  tcp_rpc_conn_send_data(c, static_cast<int>(qsize - 3 * sizeof(int)), q + 2);
+  static std::vector<int> packed;
+  if ((TCP_RPC_DATA(c)->crypto_flags & RPC_CRYPTO_ZSTD_PACKED) && vk::any_of_equal(static_cast<unsigned int>(op), TL_RPC_INVOKE_REQ, TL_RPC_REQ_RESULT)
+      && vk::singleton<RpcZstdPacking>::get().pack(q + 2, qsize - 3 * sizeof(int), packed)) {
+    tcp_rpc_conn_send_data(c, static_cast<int>(packed.size() * sizeof(int)), packed.data());
+  } else {
+    tcp_rpc_conn_send_data(c, static_cast<int>(qsize - 3 * sizeof(int)), q + 2);
+  }
 
   TCP_RPCS_FUNC(c)->flush_packet(c);
 }
@@ -744,6 +757,7 @@ tcp_rpc_server_functions rpc_methods = [] {
   res.rpc_wakeup = rpcx_func_wakeup; //replaced
   res.rpc_alarm = rpcx_func_wakeup; //replaced
   res.rpc_close = rpcx_func_close; //replaced
+  res.mode_flags = RPC_CRYPTO_ZSTD_PACKED;
 
   return res;
 }();
@@ -761,6 +775,7 @@ tcp_rpc_client_functions rpc_client_methods = [] {
   res.rpc_wakeup = rpcx_func_wakeup; //replaced
   res.rpc_alarm = rpcx_func_wakeup; //replaced
   res.rpc_close = rpcx_func_close; //replaced
+  res.mode_flags = RPC_CRYPTO_ZSTD_PACKED;
 
   return res;
 }();
@@ -893,6 +908,24 @@ int rpcx_execute(connection *c, int op, raw_message *raw) {
   bool in_sigterm = sigterm_on && sigterm_time < precise_now;
   c->last_response_time = precise_now;
 
+  if ((TCP_RPC_DATA(c)->crypto_flags & RPC_CRYPTO_ZSTD_PACKED) && vk::any_of_equal(static_cast<unsigned int>(op), TL_RPC_INVOKE_REQ, TL_RPC_REQ_RESULT)
+      && RpcZstdPacking::is_packed(raw)) {
+    if (!vk::singleton<RpcZstdPacking>::get().unpack(raw)) {
+      tl_fetch_init_raw_message(raw);
+      tl_fetch_int();
+      long long req_id = tl_fetch_long();
+      log_server_warning("Can't unpack zstd packed RPC packet from %s, op = 0x%08x", pid_to_print(&TCP_RPC_DATA(c)->remote_pid), static_cast<unsigned>(op));
+      if (op == TL_RPC_INVOKE_REQ) {
+        send_rpc_error(c, req_id, TL_ERROR_QUERY_INCORRECT, "Can't unpack zstd packed query");
+      } else {
+        vk::singleton<RpcConnectionGroups>::get().on_query_finished(static_cast<slot_id_t>(req_id), false, precise_now);
+        on_net_event(create_rpc_error_event(static_cast<slot_id_t>(req_id), TL_ERROR_RESPONSE_SYNTAX, "Can't unpack zstd packed answer", nullptr));
+      }
+      return 0;
+    }
+    len = raw->total_bytes;
+  }
+
   auto MAX_RPC_QUERY_LEN = 126214400;
   if ((len < sizeof(long long) && op != TL_KPHP_STOP_READY_ACKNOWLEDGMENT) || MAX_RPC_QUERY_LEN < len) {
     return 0;
@@ -1042,6 +1075,7 @@ int rpcx_execute(connection *c, int op, raw_message *raw) {
       assert(op_from_tl == op);
 
       auto id = tl_fetch_long();
+      vk::singleton<RpcConnectionGroups>::get().on_query_finished(static_cast<slot_id_t>(id), op == TL_RPC_REQ_RESULT, precise_now);
       if (op == TL_RPC_REQ_ERROR) {
         //FIXME: error code, error string
         //almost never happens
@@ -1522,6 +1556,10 @@ void generic_event_loop(WorkerType worker_type, bool init_and_listen_rpc_port) n
     vk::singleton<JobWorkerClient>::get().init(logname_id);
   }
 
+  if (master_flag && vk::singleton<MasterRpcProxy>::get().enabled()) {
+    vk::singleton<MasterRpcProxy>::get().init_worker();
+  }
+
   if (db_port != -1) {
     vkprintf(1, "mysql host: %s; port: %d\n", db_host, db_port);
     sql_target_id = get_target(db_host, db_port, &db_ct);
@@ -1606,6 +1644,8 @@ void generic_event_loop(WorkerType worker_type, bool init_and_listen_rpc_port) n
     epoll_close(http_sfd);
     assert (close(http_sfd) >= 0);
   }
+  // metrics aggregated since the last cron would be lost otherwise
+  StatsHouseManager::get().flush();
 }
 
 void start_server() {
@@ -2229,6 +2269,37 @@ int main_args_handler(int i, const char *long_option) {
       }
       return res;
     }
+    case 2040: {
+      return parse_numeric_option(long_option, 1, std::numeric_limits<int>::max(), [](int max_values) {
+        StatsHouseClient::set_max_sampled_values(max_values);
+      });
+    }
+    case 2041: {
+      return parse_numeric_option(long_option, 0, std::numeric_limits<int>::max(), [](int threshold_bytes) {
+        vk::singleton<RpcZstdPacking>::get().set_pack_threshold(threshold_bytes);
+        if (threshold_bytes) {
+          default_rpc_flags |= RPC_CRYPTO_ZSTD_PACKED;
+        } else {
+          default_rpc_flags &= ~RPC_CRYPTO_ZSTD_PACKED;
+        }
+      });
+    }
+    case 2042: {
+      std::string error;
+      if (!vk::singleton<RpcZstdPacking>::get().load_dictionary(optarg, error)) {
+        kprintf("--%s option : %s\n", long_option, error.c_str());
+        return -1;
+      }
+      return 0;
+    }
+    case 2043: {
+      if (strlen(optarg) > MasterRpcProxy::MAX_SOCKET_PATH_LEN) {
+        kprintf("--%s option : too long unix socket path\n", long_option);
+        return -1;
+      }
+      vk::singleton<MasterRpcProxy>::get().set_socket_path(optarg);
+      return 0;
+    }
     default:
       return -1;
   }
@@ -2343,6 +2414,14 @@ void parse_main_args(int argc, char *argv[]) {
                                                                    "Initial binlog is readed with x10 times larger timeout");
   parse_option("confdata-soft-oom-ratio", required_argument, 2039, "Memory limit ratio to start ignoring new keys related events (default: 0.85)."
                                                                    "Can't be > hard oom ratio (0.95)");
+  parse_option("statshouse-max-sampled-values", required_argument, 2040, "max values of one statshouse metric with the same tags, that a process sends per second, "
+                                                                        "others are sampled out (default: 1024)");
+  parse_option("rpc-zstd-pack-threshold", required_argument, 2041, "pack RPC queries and answers bigger than this number of bytes with zstd, "
+                                                                  "if the peer supports it too (default: 0, packing is disabled)");
+  parse_option("rpc-zstd-dict", required_argument, 2042, "a trained zstd dictionary for packing RPC queries and answers, "
+                                                         "it must be the same for a service and its clients");
+  parse_option("outbound-rpc-via-master", required_argument, 2043, "workers send RPC queries via master, which listens at this unix socket path "
+                                                                  "and keeps a few connections to each backend instead of connections from each worker");
 
   parse_engine_options_long(argc, argv, main_args_handler);
   parse_main_args_till_option(argc, argv);
@@ -60,6 +60,8 @@ extern int queries_to_recreate_script;
 void turn_sigterm_on();
 
 connection *get_target_connection(conn_target_t *S, int force_flag);
+int rpcc_check_ready(connection *c);
+int rpcc_send_query(connection *c);
 double fix_timeout(double timeout);
 int pnet_query_check(conn_query *q);
 data_reader_t *create_data_reader(connection *c, int data_len);
@@ -57,6 +57,7 @@
 #include "server/http-server-context.h"
 #include "server/lease-rpc-client.h"
 #include "server/master-name.h"
+#include "server/master-rpc-proxy.h"
 #include "server/numa-configuration.h"
 #include "server/php-engine-vars.h"
 #include "server/php-engine.h"
@@ -603,6 +604,7 @@ int run_worker(WorkerType worker_type) {
 
   workers_stats.tot_workers_started++;
   const uint16_t worker_unique_id = vk::singleton<WorkersControl>::get().on_worker_creating(worker_type);
+  StatsHouseManager::get().flush();
   pid_t new_pid = fork();
   if (new_pid == -1) {
     log_server_critical("fork error on launching %s worker: %s", (worker_type == WorkerType::general_worker ? "general" : "job"), strerror(errno));
@@ -1324,6 +1326,15 @@ void run_master_on() {
     }
   }
 
+  static bool rpc_proxy_inited = false;
+  if (!rpc_proxy_inited && vk::singleton<MasterRpcProxy>::get().enabled()) {
+    if (!vk::singleton<MasterRpcProxy>::get().init_master()) {
+      kprintf("cannot open outbound rpc proxy socket: %m\n");
+      exit(1);
+    }
+    rpc_proxy_inited = true;
+  }
+
   if (vk::singleton<WorkersControl>::get().get_count(WorkerType::job_worker) > 0) {
     vk::singleton<JobWorkersContext>::get().master_init_pipes(vk::singleton<WorkersControl>::get().get_total_workers_count());
   }
@@ -1403,6 +1414,7 @@ static void master_cron() {
                                                      instance_cache_memory_swaps_ok, instance_cache_memory_swaps_fail);
   }
   create_all_outbound_connections();
+  vk::singleton<MasterRpcProxy>::get().expire_queries(precise_now);
   vk::singleton<ServerStats>::get().aggregate_stats();
   StatsHouseManager::get().generic_cron();
 
@@ -1599,6 +1611,7 @@ WorkerType run_master() {
 
     if (to_exit) {
       kprintf("master kill all workers. Exit\n");
+      StatsHouseManager::get().flush();
       _exit(0);
     }
 
@@ -14,6 +14,7 @@
 #include "server/php-runner.h"
 #include "server/php-sql-connections.h"
 #include "server/php-worker.h"
+#include "server/rpc-connection-groups.h"
 
 void php_query_x2_t::run([[maybe_unused]] PhpWorker *worker) noexcept {
   query_stats.desc = "PHPQX2";
@@ -71,6 +72,19 @@ void php_query_connect_t::run([[maybe_unused]] PhpWorker *worker) noexcept {
   php_script->query_answered();
 }
 
+void php_query_rpc_group_connect_t::run([[maybe_unused]] PhpWorker *worker) noexcept {
+  query_stats.desc = "RPC_GROUP_CONNECT";
+
+  php_script->query_readed();
+
+  static php_query_connect_answer_t res;
+  res.connection_id = vk::singleton<RpcConnectionGroups>::get().register_group({host_nums, host_nums + host_nums_size});
+
+  ans = &res;
+
+  php_script->query_answered();
+}
+
 external_driver_connect::external_driver_connect(std::unique_ptr<database_drivers::Connector> &&connector) : connector(std::move(connector)) {};
 
 void external_driver_connect::run(PhpWorker *worker __attribute__((unused))) noexcept {
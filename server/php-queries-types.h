@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 
 enum class protocol_type {
@@ -43,6 +44,13 @@ struct php_query_connect_t : php_query_base_t {
   void run(PhpWorker *worker) noexcept final;
 };
 
+struct php_query_rpc_group_connect_t : php_query_base_t {
+  const int64_t *host_nums{nullptr};
+  int64_t host_nums_size{0};
+
+  void run(PhpWorker *worker) noexcept final;
+};
+
 namespace database_drivers {
 class Connector;
 } // namespace database_drivers
@@ -353,6 +353,18 @@ int rpc_connect_to(const char *host, int port) {
   return ans->connection_id;
 }
 
+int rpc_connect_to_group(const int64_t *host_nums, int64_t host_nums_size) {
+  assert (PhpScript::in_script_context);
+
+  php_query_rpc_group_connect_t q;
+  q.host_nums = host_nums;
+  q.host_nums_size = host_nums_size;
+
+  PhpScript::current_script->ask_query(&q);
+
+  return static_cast<php_query_connect_answer_t *>(q.ans)->connection_id;
+}
+
 /** net query **/
 php_net_query_packet_answer_t *php_net_query_packet(
   int connection_id, const char *data, int data_len,
@@ -885,6 +897,19 @@ int create_job_worker_answer_event(job_workers::JobSharedMessage *job_result) {
   return 1;
 }
 
+int create_thread_pool_task_event(slot_id_t task_id) {
+  if (!thread_pool_tasks_factory.is_from_current_script_execution(task_id)) {
+    return 0;
+  }
+  net_event_t *event = nullptr;
+  const int status = alloc_net_event(task_id, &event);
+  if (status <= 0) {
+    return status;
+  }
+  event->data = net_events_data::thread_pool_task_finished{};
+  return 1;
+}
+
 int net_events_empty() {
   return net_events.empty();
 }
@@ -1130,6 +1155,9 @@ const char *net_event_t::get_description() const noexcept {
     [](const curl_async::CurlResponse *) {
       snprintf(BUF.data(), BUF.size(), "CURL_ASYNC_RESPONSE");
     },
+    [](const net_events_data::thread_pool_task_finished &) {
+      snprintf(BUF.data(), BUF.size(), "THREAD_POOL_TASK_FINISHED");
+    },
   }, data);
   return BUF.data();
 }
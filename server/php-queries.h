@@ -41,6 +41,8 @@ struct job_worker_answer {
   job_workers::FinishedJob *job_result{};
 };
 
+struct thread_pool_task_finished {};
+
 } // namespace net_events_data
 
 namespace database_drivers {
@@ -56,7 +58,8 @@ class CurlResponse;
 
 struct net_event_t {
   slot_id_t slot_id;
-  std::variant<net_events_data::rpc_answer, net_events_data::rpc_error, net_events_data::job_worker_answer, database_drivers::Response *, curl_async::CurlResponse *> data;
+  std::variant<net_events_data::rpc_answer, net_events_data::rpc_error, net_events_data::job_worker_answer, database_drivers::Response *, curl_async::CurlResponse *,
+               net_events_data::thread_pool_task_finished> data;
 
   const char *get_description() const noexcept;
 };
@@ -299,6 +302,8 @@ int create_rpc_answer_event(slot_id_t slot_id, int len, net_event_t **res);
 
 int create_job_worker_answer_event(job_workers::JobSharedMessage *job_result);
 
+int create_thread_pool_task_event(slot_id_t task_id);
+
 int net_events_empty();
 net_query_t *create_net_query();
 
@@ -330,6 +335,8 @@ void script_error();
 void finish_script(int exit_code);
 void http_send_immediate_response(const char *headers, int headers_len, const char *body, int body_len);
 int rpc_connect_to(const char *host_name, int port);
+// host_nums are returned by rpc_connect_to(), returns a host_num of the group
+int rpc_connect_to_group(const int64_t *host_nums, int64_t host_nums_size);
 slot_id_t rpc_send_query(int host_num, char *request, int request_len, int timeout_ms);
 void wait_net_events(int timeout_ms);
 net_event_t *pop_net_event();
@@ -19,11 +19,13 @@
 #include "server/database-drivers/request.h"
 #include "server/job-workers/job-stats.h"
 #include "server/job-workers/job-worker-server.h"
+#include "server/master-rpc-proxy.h"
 #include "server/php-engine.h"
 #include "server/php-lease.h"
 #include "server/php-mc-connections.h"
 #include "server/php-sql-connections.h"
 #include "server/php-worker.h"
+#include "server/rpc-connection-groups.h"
 #include "server/server-stats.h"
 
 std::optional<PhpWorker> php_worker;
@@ -166,24 +168,44 @@ void PhpWorker::state_init_script() noexcept {
 void php_worker_run_rpc_send_query(int32_t request_id, const net_queries_data::rpc_send &query) {
   int connection_id = query.host_num;
   slot_id_t slot_id = request_id;
+  if (RpcConnectionGroups::is_group(connection_id)) {
+    connection_id = vk::singleton<RpcConnectionGroups>::get().choose_target(connection_id, slot_id, precise_now + fix_timeout(query.timeout_ms * 0.001), precise_now,
+                                                                            [](int target_id) { return get_target_connection(&Targets[target_id], 0) != nullptr; });
+  }
   if (connection_id < 0 || connection_id >= MAX_TARGETS) {
     on_net_event(create_rpc_error_event(slot_id, TL_ERROR_INVALID_CONNECTION_ID, "Invalid connection_id (1)", nullptr));
     return;
   }
   conn_target_t *target = &Targets[connection_id];
+  char *request = query.request;
+  int request_size = query.request_size;
+  const auto &rpc_proxy = vk::singleton<MasterRpcProxy>::get();
+  if (const int rpc_proxy_target = rpc_proxy.worker_target(); rpc_proxy_target != -1) {
+    uint32_t ip = 0;
+    uint16_t port = 0;
+    if (!rpc_proxy.get_target_destination(connection_id, ip, port)) {
+      on_net_event(create_rpc_error_event(slot_id, TL_ERROR_INVALID_CONNECTION_ID, "Invalid connection_id (2)", nullptr));
+      return;
+    }
+    auto &wrapped = MasterRpcProxy::wrap_query(ip, port, query.timeout_ms, reinterpret_cast<const int *>(query.request), query.request_size);
+    request = reinterpret_cast<char *>(wrapped.data());
+    request_size = static_cast<int>(wrapped.size() * sizeof(int));
+    target = &Targets[rpc_proxy_target];
+  }
   connection *conn = get_target_connection(target, 0);
 
   if (conn != nullptr) {
-    send_rpc_query(conn, TL_RPC_INVOKE_REQ, slot_id, reinterpret_cast<int *>(query.request), query.request_size);
+    send_rpc_query(conn, TL_RPC_INVOKE_REQ, slot_id, reinterpret_cast<int *>(request), request_size);
     conn->last_query_sent_time = precise_now;
   } else {
     int new_conn_cnt = create_new_connections(target);
     if (new_conn_cnt <= 0 && get_target_connection(target, 1) == nullptr) {
+      vk::singleton<RpcConnectionGroups>::get().on_query_finished(slot_id, false, precise_now);
       on_net_event(create_rpc_error_event(slot_id, TL_ERROR_NO_CONNECTIONS_IN_RPC_CLIENT, "Failed to establish connection [probably reconnect timeout is not expired]", nullptr));
       return;
     }
 
-    command_t *command = create_command_net_writer(query.request, query.request_size, &command_net_write_rpc_base, slot_id);
+    command_t *command = create_command_net_writer(request, request_size, &command_net_write_rpc_base, slot_id);
     double timeout = fix_timeout(query.timeout_ms * 0.001) + precise_now;
     create_delayed_send_query(target, command, timeout);
   }
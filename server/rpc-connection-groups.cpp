@@ -0,0 +1,103 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/rpc-connection-groups.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "net/net-connections.h"
+
+bool RpcConnectionGroups::is_group(int host_num) noexcept {
+  return host_num >= MAX_TARGETS;
+}
+
+int RpcConnectionGroups::register_group(std::vector<int> target_host_nums) noexcept {
+  std::sort(target_host_nums.begin(), target_host_nums.end());
+  target_host_nums.erase(std::unique(target_host_nums.begin(), target_host_nums.end()), target_host_nums.end());
+  if (target_host_nums.empty() || target_host_nums.front() < 0 || is_group(target_host_nums.back())) {
+    return -1;
+  }
+  auto [it, inserted] = group_ids_.emplace(target_host_nums, MAX_TARGETS + static_cast<int>(groups_.size()));
+  if (inserted) {
+    groups_.emplace_back(std::move(target_host_nums));
+  }
+  return it->second;
+}
+
+int RpcConnectionGroups::choose_target(int group_host_num, slot_id_t slot_id, double timeout_at, double now,
+                                       const std::function<bool(int)> &has_ready_connection) noexcept {
+  if (!is_group(group_host_num) || group_host_num - MAX_TARGETS >= static_cast<int>(groups_.size())) {
+    return -1;
+  }
+  expire_queries(now);
+  if (auto it = outstanding_queries_.find(slot_id); it != outstanding_queries_.end()) {
+    // the slot id is reused by a new script, the old query is not waited anymore, but it's not a target failure
+    --targets_[it->second.target_host_num].outstanding_queries;
+    outstanding_queries_.erase(it);
+  }
+
+  const auto &group = groups_[group_host_num - MAX_TARGETS];
+  // the best is a healthy target with a ready connection, then a healthy one, then any; less outstanding queries are better
+  // the scan starts from a rotating position, so that equal targets are chosen in turn
+  int best_target = -1;
+  std::tuple<int, int, int> best_rank;
+  const size_t start = next_choice_++;
+  for (size_t i = 0; i != group.size(); ++i) {
+    const int target = group[(start + i) % group.size()];
+    const TargetState &state = targets_[target];
+    const auto rank = std::make_tuple(static_cast<int>(state.ejected_till > now), static_cast<int>(!has_ready_connection(target)),
+                                      state.outstanding_queries);
+    if (best_target == -1 || rank < best_rank) {
+      best_target = target;
+      best_rank = rank;
+    }
+  }
+
+  ++targets_[best_target].outstanding_queries;
+  outstanding_queries_[slot_id] = OutstandingQuery{best_target, timeout_at};
+  timeouts_.emplace(timeout_at, slot_id);
+  return best_target;
+}
+
+void RpcConnectionGroups::on_query_finished(slot_id_t slot_id, bool success, double now) noexcept {
+  if (outstanding_queries_.count(slot_id)) {
+    finish_query(slot_id, success, now);
+  }
+}
+
+int RpcConnectionGroups::get_outstanding_queries(int target_host_num) const noexcept {
+  auto it = targets_.find(target_host_num);
+  return it == targets_.end() ? 0 : it->second.outstanding_queries;
+}
+
+bool RpcConnectionGroups::is_ejected(int target_host_num, double now) const noexcept {
+  auto it = targets_.find(target_host_num);
+  return it != targets_.end() && it->second.ejected_till > now;
+}
+
+void RpcConnectionGroups::finish_query(slot_id_t slot_id, bool success, double now) noexcept {
+  auto it = outstanding_queries_.find(slot_id);
+  TargetState &state = targets_[it->second.target_host_num];
+  outstanding_queries_.erase(it);
+  --state.outstanding_queries;
+  if (success) {
+    state.consecutive_failures = 0;
+  } else if (++state.consecutive_failures >= MAX_CONSECUTIVE_FAILURES) {
+    state.consecutive_failures = 0;
+    state.ejected_till = now + EJECTION_TIME_SEC;
+  }
+}
+
+void RpcConnectionGroups::expire_queries(double now) noexcept {
+  while (!timeouts_.empty() && timeouts_.top().first <= now) {
+    const auto [timeout_at, slot_id] = timeouts_.top();
+    timeouts_.pop();
+    // the slot may be finished already or reused by another query with a later timeout
+    auto it = outstanding_queries_.find(slot_id);
+    if (it != outstanding_queries_.end() && it->second.timeout_at == timeout_at) {
+      finish_query(slot_id, false, now);
+    }
+  }
+}
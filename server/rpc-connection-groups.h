@@ -0,0 +1,70 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "common/mixin/not_copyable.h"
+#include "common/smart_ptrs/singleton.h"
+
+#include "server/slot-ids-factory.h"
+
+// A connection group is several RPC targets (replicas) of one service, it's used by a script as one RpcConnection.
+// Queries are multiplexed over targets connections as usual, each query goes to the target with the least outstanding
+// queries of this worker, so a slow replica gets less of them.
+// Targets failing several times in a row (errors, timeouts, no connection) are ejected for a while,
+// unless all the group is ejected: then queries are routed as if all targets were healthy.
+// Groups and targets states are per worker process.
+class RpcConnectionGroups : vk::not_copyable {
+public:
+  friend class vk::singleton<RpcConnectionGroups>;
+
+  static constexpr int MAX_CONSECUTIVE_FAILURES = 5;
+  static constexpr double EJECTION_TIME_SEC = 10.0;
+
+  // host_nums of groups don't intersect with host_nums of targets
+  static bool is_group(int host_num) noexcept;
+
+  // the same targets are always the same group, as scripts create connections on each request
+  int register_group(std::vector<int> target_host_nums) noexcept;
+
+  // returns a target host_num for the query or -1 if the group is unknown, the query is considered outstanding till it's finished
+  int choose_target(int group_host_num, slot_id_t slot_id, double timeout_at, double now, const std::function<bool(int)> &has_ready_connection) noexcept;
+
+  // is called on any query result, the ones not sent to groups are ignored
+  void on_query_finished(slot_id_t slot_id, bool success, double now) noexcept;
+
+  int get_outstanding_queries(int target_host_num) const noexcept;
+  bool is_ejected(int target_host_num, double now) const noexcept;
+
+private:
+  RpcConnectionGroups() = default;
+
+  struct TargetState {
+    int outstanding_queries{0};
+    int consecutive_failures{0};
+    double ejected_till{0};
+  };
+
+  struct OutstandingQuery {
+    int target_host_num{-1};
+    double timeout_at{0};
+  };
+
+  void finish_query(slot_id_t slot_id, bool success, double now) noexcept;
+  void expire_queries(double now) noexcept;
+
+  std::vector<std::vector<int>> groups_;
+  std::map<std::vector<int>, int> group_ids_;
+  std::unordered_map<int, TargetState> targets_;
+  std::unordered_map<slot_id_t, OutstandingQuery> outstanding_queries_;
+  // timeouts of outstanding queries, the earliest first; answered queries are skipped lazily
+  std::priority_queue<std::pair<double, slot_id_t>, std::vector<std::pair<double, slot_id_t>>, std::greater<>> timeouts_;
+  size_t next_choice_{0};
+};
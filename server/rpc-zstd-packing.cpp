@@ -0,0 +1,169 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "server/rpc-zstd-packing.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <zstd.h>
+
+#include "common/smart_ptrs/unique_ptr_with_delete_function.h"
+#include "net/net-msg.h"
+
+namespace {
+
+// crc32 of "zstdPacked packed_data:string = Object"
+constexpr int ZSTD_PACKED = 0x35af97f4;
+// op and req_id are never packed
+constexpr size_t HEADER_BYTES = sizeof(int) + sizeof(long long);
+// the longest TL string has 3 bytes of length
+constexpr size_t MAX_PACKED_BYTES = 1 << 24;
+constexpr size_t MAX_UNPACKED_BYTES = 1 << 27;
+
+template<class T, size_t (*Deleter)(T *)>
+void free_zstd(T *ptr) {
+  Deleter(ptr);
+}
+
+} // namespace
+
+struct RpcZstdPacking::Contexts {
+  vk::unique_ptr_with_delete_function<ZSTD_CCtx, free_zstd<ZSTD_CCtx, ZSTD_freeCCtx>> cctx{ZSTD_createCCtx()};
+  vk::unique_ptr_with_delete_function<ZSTD_DCtx, free_zstd<ZSTD_DCtx, ZSTD_freeDCtx>> dctx{ZSTD_createDCtx()};
+  vk::unique_ptr_with_delete_function<ZSTD_CDict, free_zstd<ZSTD_CDict, ZSTD_freeCDict>> cdict;
+  vk::unique_ptr_with_delete_function<ZSTD_DDict, free_zstd<ZSTD_DDict, ZSTD_freeDDict>> ddict;
+};
+
+RpcZstdPacking::RpcZstdPacking() = default;
+RpcZstdPacking::~RpcZstdPacking() = default;
+
+bool RpcZstdPacking::load_dictionary(const char *path, std::string &error) noexcept {
+  std::ifstream file{path, std::ios::binary};
+  if (!file) {
+    error = "file opening failed";
+    return false;
+  }
+  std::string dictionary{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+  // raw content dictionaries have no id, a peer with another dictionary couldn't detect the mismatch then
+  const unsigned dictionary_id = ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size());
+  if (dictionary_id == 0) {
+    error = "not a trained zstd dictionary";
+    return false;
+  }
+  dictionary_ = std::move(dictionary);
+  dictionary_id_ = dictionary_id;
+  contexts_.reset();
+  return true;
+}
+
+RpcZstdPacking::Contexts &RpcZstdPacking::contexts() noexcept {
+  if (!contexts_) {
+    contexts_ = std::make_unique<Contexts>();
+    if (!dictionary_.empty()) {
+      contexts_->cdict.reset(ZSTD_createCDict(dictionary_.data(), dictionary_.size(), COMPRESSION_LEVEL));
+      contexts_->ddict.reset(ZSTD_createDDict(dictionary_.data(), dictionary_.size()));
+    }
+  }
+  return *contexts_;
+}
+
+bool RpcZstdPacking::pack(const int *packet, size_t packet_bytes, std::vector<int> &packed) noexcept {
+  if (!enabled() || packet_bytes < HEADER_BYTES + pack_threshold_) {
+    return false;
+  }
+  const char *body = reinterpret_cast<const char *>(packet) + HEADER_BYTES;
+  const size_t body_bytes = packet_bytes - HEADER_BYTES;
+
+  // the header, the magic and the longest string length are followed by the compressed data
+  const size_t data_offset = HEADER_BYTES + 2 * sizeof(int);
+  packed.resize((data_offset + ZSTD_compressBound(body_bytes) + sizeof(int) - 1) / sizeof(int));
+  char *out = reinterpret_cast<char *>(packed.data());
+  const size_t capacity = packed.size() * sizeof(int) - data_offset;
+
+  Contexts &ctx = contexts();
+  const size_t compressed_bytes = ctx.cdict
+                                  ? ZSTD_compress_usingCDict(ctx.cctx.get(), out + data_offset, capacity, body, body_bytes, ctx.cdict.get())
+                                  : ZSTD_compressCCtx(ctx.cctx.get(), out + data_offset, capacity, body, body_bytes, COMPRESSION_LEVEL);
+  if (ZSTD_isError(compressed_bytes) || compressed_bytes >= MAX_PACKED_BYTES) {
+    return false;
+  }
+
+  std::memcpy(out, packet, HEADER_BYTES);
+  std::memcpy(out + HEADER_BYTES, &ZSTD_PACKED, sizeof(int));
+  auto *string_begin = reinterpret_cast<unsigned char *>(out + HEADER_BYTES + sizeof(int));
+  size_t string_bytes = 0;
+  if (compressed_bytes < 254) {
+    string_begin[0] = static_cast<unsigned char>(compressed_bytes);
+    std::memmove(string_begin + 1, out + data_offset, compressed_bytes);
+    string_bytes = 1 + compressed_bytes;
+  } else {
+    string_begin[0] = 254;
+    string_begin[1] = static_cast<unsigned char>(compressed_bytes & 0xff);
+    string_begin[2] = static_cast<unsigned char>((compressed_bytes >> 8) & 0xff);
+    string_begin[3] = static_cast<unsigned char>((compressed_bytes >> 16) & 0xff);
+    string_bytes = 4 + compressed_bytes;
+  }
+  const size_t padded_string_bytes = (string_bytes + sizeof(int) - 1) / sizeof(int) * sizeof(int);
+  const size_t packed_bytes = HEADER_BYTES + sizeof(int) + padded_string_bytes;
+  if (packed_bytes >= packet_bytes) {
+    return false;
+  }
+  std::memset(string_begin + string_bytes, 0, padded_string_bytes - string_bytes);
+  packed.resize(packed_bytes / sizeof(int));
+  return true;
+}
+
+bool RpcZstdPacking::is_packed(const raw_message *raw) noexcept {
+  int prefix[4];
+  static_assert(sizeof(prefix) == HEADER_BYTES + sizeof(int));
+  return raw->total_bytes >= static_cast<int>(sizeof(prefix) + sizeof(int))
+         && rwm_fetch_lookup(raw, prefix, sizeof(prefix)) == sizeof(prefix)
+         && prefix[3] == ZSTD_PACKED;
+}
+
+bool RpcZstdPacking::unpack(raw_message *raw) noexcept {
+  std::vector<unsigned char> packed(raw->total_bytes);
+  if (rwm_fetch_lookup(raw, packed.data(), raw->total_bytes) != raw->total_bytes || packed.size() <= HEADER_BYTES + sizeof(int)) {
+    return false;
+  }
+  const unsigned char *string_begin = packed.data() + HEADER_BYTES + sizeof(int);
+  const size_t string_bytes = packed.data() + packed.size() - string_begin;
+  size_t length_bytes = 1;
+  size_t compressed_bytes = string_begin[0];
+  if (compressed_bytes == 254 && string_bytes >= 4) {
+    length_bytes = 4;
+    compressed_bytes = string_begin[1] | (string_begin[2] << 8) | (string_begin[3] << 16);
+  } else if (compressed_bytes > 254) {
+    return false;
+  }
+  if (length_bytes + compressed_bytes > string_bytes) {
+    return false;
+  }
+
+  const unsigned char *frame = string_begin + length_bytes;
+  const unsigned long long body_bytes = ZSTD_getFrameContentSize(frame, compressed_bytes);
+  if (body_bytes == ZSTD_CONTENTSIZE_UNKNOWN || body_bytes == ZSTD_CONTENTSIZE_ERROR
+      || body_bytes > MAX_UNPACKED_BYTES || body_bytes % sizeof(int) != 0) {
+    return false;
+  }
+  if (ZSTD_getDictID_fromFrame(frame, compressed_bytes) != dictionary_id_) {
+    return false;
+  }
+
+  std::vector<char> unpacked(HEADER_BYTES + body_bytes);
+  std::memcpy(unpacked.data(), packed.data(), HEADER_BYTES);
+  Contexts &ctx = contexts();
+  char *body = unpacked.data() + HEADER_BYTES;
+  const size_t unpacked_bytes = ctx.ddict
+                                ? ZSTD_decompress_usingDDict(ctx.dctx.get(), body, body_bytes, frame, compressed_bytes, ctx.ddict.get())
+                                : ZSTD_decompressDCtx(ctx.dctx.get(), body, body_bytes, frame, compressed_bytes);
+  if (ZSTD_isError(unpacked_bytes) || unpacked_bytes != body_bytes) {
+    return false;
+  }
+
+  rwm_free(raw);
+  rwm_create(raw, unpacked.data(), static_cast<int>(unpacked.size()));
+  return true;
+}
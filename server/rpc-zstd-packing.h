@@ -0,0 +1,58 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2023 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/mixin/not_copyable.h"
+#include "common/smart_ptrs/singleton.h"
+
+struct raw_message;
+
+// Bodies of RPC queries and answers bigger than a threshold are packed with zstd: [op, req_id, zstdPacked packed_data:string].
+// It's done for connections only, which both peers agreed on with RPC_CRYPTO_ZSTD_PACKED flag in the handshake.
+// A service and its clients may share a dictionary trained on its TL payloads, that shrinks even small packets well.
+// Zstd writes the dictionary id into each frame, so a peer with another dictionary fails to unpack instead of getting garbage.
+class RpcZstdPacking : vk::not_copyable {
+public:
+  friend class vk::singleton<RpcZstdPacking>;
+
+  static constexpr int COMPRESSION_LEVEL = 3;
+
+  bool load_dictionary(const char *path, std::string &error) noexcept;
+
+  void set_pack_threshold(size_t threshold_bytes) noexcept {
+    pack_threshold_ = threshold_bytes;
+  }
+
+  bool enabled() const noexcept {
+    return pack_threshold_ != 0;
+  }
+
+  // packs a packet starting with op and req_id; returns false if the packet is small or not compressed well
+  bool pack(const int *packet, size_t packet_bytes, std::vector<int> &packed) noexcept;
+
+  static bool is_packed(const raw_message *raw) noexcept;
+
+  // replaces a packed message with the unpacked one; returns false if it's broken or packed with another dictionary
+  bool unpack(raw_message *raw) noexcept;
+
+  ~RpcZstdPacking();
+
+private:
+  RpcZstdPacking();
+
+  // zstd contexts and digested dictionaries, they are created lazily in each process
+  struct Contexts;
+  Contexts &contexts() noexcept;
+
+  size_t pack_threshold_{0};
+  std::string dictionary_;
+  unsigned dictionary_id_{0};
+  std::unique_ptr<Contexts> contexts_;
+};
@@ -18,6 +18,7 @@
 #include "server/workers-control.h"
 
 #include "server/json-logger.h"
+#include "server/log-histogram.h"
 #include "server/server-stats.h"
 #include "server/php-worker.h"
 #include "server/statshouse/statshouse-manager.h"
@@ -249,60 +250,20 @@ EnumTable<QueriesStat> make_queries_stat(uint64_t script_queries, uint64_t long_
   return result;
 }
 
-template<class T>
-struct AggregatedSamples;
-
-template<class T>
-struct SharedSamples : private vk::not_copyable {
-public:
-  void init(std::mt19937 *gen) noexcept {
-    gen_ = gen;
-  }
-
-  void add_sample(T value, size_t sample_index) noexcept {
-    if (sample_index >= samples_.size()) {
-      // the zero value doesn't override anything
-      if (value == T{}) {
-        return;
-      }
-      sample_index = std::uniform_int_distribution<size_t>{0, sample_index}(*gen_);
-    }
-    if (sample_index < samples_.size()) {
-      samples_[sample_index].store(value, std::memory_order_relaxed);
-    }
-  }
-
-private:
-  friend struct AggregatedSamples<T>;
-
-  std::mt19937 *gen_{nullptr};
-  std::array<std::atomic<T>, 1024> samples_{};
-};
-
 template<class E>
-struct SharedSamplesBundle : EnumTable<E, SharedSamples<typename E::StatType>>, private vk::not_copyable {
+struct SharedSamplesBundle : EnumTable<E, SharedLogHistogram>, private vk::not_copyable {
 public:
-  explicit SharedSamplesBundle(std::mt19937 *gen) noexcept {
-    for (auto &s : *this) {
-      s.init(gen);
-    }
-  }
-
   void add_sample(const EnumTable<E> &sample) noexcept {
-    const size_t sample_index = last_sample.fetch_add(1, std::memory_order_acq_rel);
     for (size_t i = 0; i != this->size(); ++i) {
-      (*this)[i].add_sample(sample[i], sample_index);
+      // zero values are not taken into account, e.g. for scripts without outgoing queries
+      if (sample[i] != 0) {
+        (*this)[i].add(sample[i]);
+      }
     }
   }
-
-  std::atomic<uint64_t> last_sample{0};
 };
 
 struct WorkerSharedStats : private vk::not_copyable {
-  explicit WorkerSharedStats(std::mt19937 *gen) noexcept:
-    script_samples(gen) {
-  }
-
   void add_request_stats(const EnumTable<QueriesStat> &queries, script_error_t error,
                          const memory_resource::MemoryStats &script_memory_stats, uint64_t curl_total_allocated) noexcept {
     errors[static_cast<size_t>(error)].fetch_add(1, std::memory_order_relaxed);
@@ -338,12 +299,6 @@ struct WorkerSharedStats : private vk::not_copyable {
 };
 
 struct JobWorkerSharedStats : WorkerSharedStats {
-  explicit JobWorkerSharedStats(std::mt19937 *gen) noexcept:
-    WorkerSharedStats(gen),
-    job_samples(gen),
-    job_common_memory_samples(gen) {
-  }
-
   void add_job_stats(uint64_t job_wait_ns, uint64_t request_memory_used, uint64_t request_real_memory_used, uint64_t response_memory_used, uint64_t response_real_memory_used) noexcept {
     EnumTable<JobSamples> sample;
     sample[JobSamples::Key::wait_time] = job_wait_ns;
@@ -365,70 +320,13 @@ struct JobWorkerSharedStats : WorkerSharedStats {
   SharedSamplesBundle<JobCommonMemorySamples> job_common_memory_samples;
 };
 
-template<class T>
-struct AggregatedSamples : vk::not_copyable {
-public:
-  using Sample = std::pair<T, std::chrono::steady_clock::time_point>;
-
-  AggregatedSamples() noexcept:
-    last_(samples_.begin()) {
-  }
-
-  void init(std::mt19937 *gen) noexcept {
-    gen_ = gen;
-  }
-
-  void recalc(SharedSamples<T> &samples, size_t samples_count,
-              std::chrono::steady_clock::time_point now_tp) noexcept {
-    last_ = std::remove_if(samples_.begin(), last_,
-                           [now_tp](const Sample &s) { return now_tp - s.second > std::chrono::minutes{1}; });
-    samples_count = std::min(samples_count, samples.samples_.size());
-
-    while (last_ != samples_.end() && samples_count) {
-      const Sample sample{samples.samples_[--samples_count].exchange(T{}, std::memory_order_relaxed), now_tp};
-      if (sample.first != T{}) {
-        *last_++ = sample;
-      }
-    }
-
-    std::uniform_int_distribution<size_t> distrib(0, samples_.size());
-    while (samples_count) {
-      const Sample sample{samples.samples_[--samples_count].exchange(T{}, std::memory_order_relaxed), now_tp};
-      if (sample.first != T{}) {
-        const size_t index = distrib(*gen_);
-        if (index < samples_.size()) {
-          samples_[index] = sample;
-        }
-        // the zero value doesn't affect the sample
-        distrib.param(std::uniform_int_distribution<size_t>::param_type{0, distrib.max() + 1});
-      }
-    }
-    percentiles.update_percentiles(samples_.begin(), last_, [](const Sample &s) { return s.first; });
-  }
-
-  Percentiles<T> percentiles;
-
-private:
-  std::array<Sample, 4096> samples_{};
-  typename std::array<Sample, 4096>::iterator last_{};
-  std::mt19937 *gen_{nullptr};
-};
-
 template<class E>
-struct AggregatedSamplesBundle : EnumTable<E, AggregatedSamples<typename E::StatType>>, private vk::not_copyable {
+struct AggregatedSamplesBundle : EnumTable<E, WindowLogHistogram>, private vk::not_copyable {
 public:
-  explicit AggregatedSamplesBundle(std::mt19937 *gen) noexcept {
-    for (auto &s : *this) {
-      s.init(gen);
-    }
-  }
-
   void recalc(SharedSamplesBundle<E> &samples, std::chrono::steady_clock::time_point now_tp) noexcept {
-    const size_t last_sample = samples.last_sample.load(std::memory_order_acquire);
     for (size_t i = 0; i != this->size(); ++i) {
-      (*this)[i].recalc(samples[i], last_sample, now_tp);
+      (*this)[i].recalc(samples[i], now_tp, std::chrono::minutes{1});
     }
-    samples.last_sample.store(0, std::memory_order_release);
   }
 };
 
@@ -558,10 +456,6 @@ struct WorkerPercentilesBundle : EnumTable<E, Percentiles<typename E::StatType>>
 };
 
 struct WorkerAggregatedStats {
-  explicit WorkerAggregatedStats(std::mt19937 *gen) noexcept:
-    script_samples(gen) {
-  }
-
   void recalc(SharedSamplesBundle<ScriptSamples> &script_shared_samples, std::chrono::steady_clock::time_point now_tp,
               const WorkerProcessStats &stats, uint16_t first_id, uint16_t last_id) noexcept {
     script_samples.recalc(script_shared_samples, now_tp);
@@ -579,12 +473,6 @@ struct WorkerAggregatedStats {
 };
 
 struct JobWorkerAggregatedStats : WorkerAggregatedStats {
-  explicit JobWorkerAggregatedStats(std::mt19937 *gen) noexcept:
-    WorkerAggregatedStats(gen),
-    job_samples(gen),
-    job_common_memory_samples(gen) {
-  }
-
   AggregatedSamplesBundle<JobSamples> job_samples;
   AggregatedSamplesBundle<JobCommonMemorySamples> job_common_memory_samples;
 };
@@ -598,11 +486,6 @@ struct MasterProcessStats : private vk::not_copyable {
 } // namespace
 
 struct ServerStats::SharedStats {
-  explicit SharedStats(std::mt19937 *gen) noexcept:
-    general_workers(gen),
-    job_workers(gen) {
-  }
-
   WorkerSharedStats general_workers;
   JobWorkerSharedStats job_workers;
 
@@ -611,11 +494,6 @@ struct ServerStats::SharedStats {
 
 
 struct ServerStats::AggregatedStats {
-  explicit AggregatedStats(std::mt19937 *gen) noexcept:
-    general_workers(gen),
-    job_workers(gen) {
-  }
-
   WorkerAggregatedStats general_workers;
   JobWorkerAggregatedStats job_workers;
 
@@ -623,9 +501,8 @@ struct ServerStats::AggregatedStats {
 };
 
 void ServerStats::init() noexcept {
-  gen_ = new std::mt19937{};
-  aggregated_stats_ = new AggregatedStats{gen_};
-  shared_stats_ = new(mmap_shared(sizeof(SharedStats))) SharedStats{gen_};
+  aggregated_stats_ = new AggregatedStats{};
+  shared_stats_ = new(mmap_shared(sizeof(SharedStats))) SharedStats{};
 }
 
 void ServerStats::after_fork(pid_t worker_pid, uint64_t active_connections, uint64_t max_connections,
@@ -633,7 +510,6 @@ void ServerStats::after_fork(pid_t worker_pid, uint64_t active_connections, uint
   assert(vk::any_of_equal(worker_type, WorkerType::general_worker, WorkerType::job_worker));
   worker_process_id_ = worker_process_id;
   worker_type_ = worker_type;
-  gen_->seed(worker_pid);
   shared_stats_->workers.reset_worker_stats(worker_pid, active_connections, max_connections, worker_process_id_);
   last_update_aggr_stats = std::chrono::steady_clock::now();
 }
@@ -735,14 +611,15 @@ uint64_t kb2bytes(uint64_t kb) noexcept {
   return kb * 1024;
 }
 
-template<typename T, typename Mapper = vk::identity>
-void write_to(stats_t *stats, const char *prefix, const char *suffix, const AggregatedSamples<T> &samples, const Mapper &mapper = {}) {
-  stats->add_gauge_stat(mapper(samples.percentiles.p50), prefix, suffix, ".p50");
-  stats->add_gauge_stat(mapper(samples.percentiles.p75), prefix, suffix, ".p75");
-  stats->add_gauge_stat(mapper(samples.percentiles.p90), prefix, suffix, ".p90");
-  stats->add_gauge_stat(mapper(samples.percentiles.p95), prefix, suffix, ".p95");
-  stats->add_gauge_stat(mapper(samples.percentiles.p99), prefix, suffix, ".p99");
-  stats->add_gauge_stat(mapper(samples.percentiles.max), prefix, suffix, ".max");
+template<typename Mapper = vk::identity>
+void write_to(stats_t *stats, const char *prefix, const char *suffix, const WindowLogHistogram &samples, const Mapper &mapper = {}) {
+  stats->add_gauge_stat(mapper(samples.quantiles.p50), prefix, suffix, ".p50");
+  stats->add_gauge_stat(mapper(samples.quantiles.p75), prefix, suffix, ".p75");
+  stats->add_gauge_stat(mapper(samples.quantiles.p90), prefix, suffix, ".p90");
+  stats->add_gauge_stat(mapper(samples.quantiles.p95), prefix, suffix, ".p95");
+  stats->add_gauge_stat(mapper(samples.quantiles.p99), prefix, suffix, ".p99");
+  stats->add_gauge_stat(mapper(samples.quantiles.p999), prefix, suffix, ".p999");
+  stats->add_gauge_stat(mapper(samples.quantiles.max), prefix, suffix, ".max");
 }
 
 template<typename T, typename Mapper = vk::identity>
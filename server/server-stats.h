@@ -6,7 +6,6 @@
 
 #include <chrono>
 #include <memory>
-#include <random>
 
 #include "common/mixin/not_copyable.h"
 #include "common/smart_ptrs/singleton.h"
@@ -64,8 +63,6 @@ private:
   uint16_t worker_process_id_{0};
   std::chrono::steady_clock::time_point last_update_aggr_stats;
 
-  std::mt19937 *gen_{nullptr};
-
   struct AggregatedStats;
   AggregatedStats *aggregated_stats_{nullptr};
 
@@ -1,5 +1,6 @@
 prepend(KPHP_SERVER_SOURCES ${BASE_DIR}/server/
         master-name.cpp
+        master-rpc-proxy.cpp
         confdata-binlog-replay.cpp
         confdata-stats.cpp
         curl-adaptor.cpp
@@ -22,6 +23,8 @@ prepend(KPHP_SERVER_SOURCES ${BASE_DIR}/server/
         php-init-scripts.cpp
         php-sql-connections.cpp
         php-worker.cpp
+        rpc-connection-groups.cpp
+        rpc-zstd-packing.cpp
         server-config.cpp
         server-log.cpp
         server-stats.cpp
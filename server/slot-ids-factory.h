@@ -50,6 +50,7 @@ extern SlotIdsFactory rpc_ids_factory;
 extern SlotIdsFactory parallel_job_ids_factory;
 extern SlotIdsFactory external_db_requests_factory;
 extern SlotIdsFactory curl_requests_factory;
+extern SlotIdsFactory thread_pool_tasks_factory;
 
 void init_slot_factories();
 void free_slot_factories();
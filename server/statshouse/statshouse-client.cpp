@@ -4,11 +4,142 @@
 
 #include "server/statshouse/statshouse-client.h"
 
-statshouse::TransportUDPBase::MetricBuilder StatsHouseClient::metric(std::string_view name, bool force_tag_host) {
-  auto builder = transport.metric(name);
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// a key is the metric name followed by tags, each of them is a kind char and strings;
+// a string is prefixed with its length, as tag values may contain any chars
+constexpr char POSITIONAL_TAG = '\1';
+constexpr char NAMED_TAG = '\2';
+
+void append_key_part(std::string &key, std::string_view part) {
+  const auto size = static_cast<uint32_t>(part.size());
+  key.append(reinterpret_cast<const char *>(&size), sizeof(size));
+  key.append(part.data(), part.size());
+}
+
+std::string_view next_key_part(const char *&pos) {
+  uint32_t size = 0;
+  std::memcpy(&size, pos, sizeof(size));
+  std::string_view part{pos + sizeof(size), size};
+  pos += sizeof(size) + size;
+  return part;
+}
+
+} // namespace
+
+StatsHouseClient::MetricBuilder::MetricBuilder(StatsHouseClient &client, std::string_view name)
+  : client(client) {
+  if (!client.dummy) {
+    append_key_part(key, name);
+  }
+}
+
+StatsHouseClient::MetricBuilder &StatsHouseClient::MetricBuilder::tag(std::string_view value) {
+  if (!client.dummy) {
+    key.push_back(POSITIONAL_TAG);
+    append_key_part(key, value);
+  }
+  return *this;
+}
+
+StatsHouseClient::MetricBuilder &StatsHouseClient::MetricBuilder::tag(std::string_view name, std::string_view value) {
+  if (!client.dummy) {
+    key.push_back(NAMED_TAG);
+    append_key_part(key, name);
+    append_key_part(key, value);
+  }
+  return *this;
+}
+
+void StatsHouseClient::MetricBuilder::write_count(double count) {
+  if (!client.dummy) {
+    client.get_aggregate(key).count += count;
+  }
+}
+
+void StatsHouseClient::MetricBuilder::write_value(double value) {
+  if (!client.dummy) {
+    client.add_sample(&Aggregate::values, key, value);
+  }
+}
+
+void StatsHouseClient::MetricBuilder::write_unique(uint64_t value) {
+  if (!client.dummy) {
+    client.add_sample(&Aggregate::uniques, key, value);
+  }
+}
+
+StatsHouseClient::MetricBuilder StatsHouseClient::metric(std::string_view name, bool force_tag_host) {
+  MetricBuilder builder{*this, name};
   builder.tag(tag_cluster);
   if (host_enabled || force_tag_host) {
     builder.tag("host", tag_host);
   }
   return builder;
 }
+
+StatsHouseClient::Aggregate &StatsHouseClient::get_aggregate(const std::string &key) {
+  if (aggregates.size() >= MAX_AGGREGATED_KEYS && aggregates.find(key) == aggregates.end()) {
+    flush();
+  }
+  return aggregates[key];
+}
+
+template<class T>
+void StatsHouseClient::add_sample(Samples<T> Aggregate::*field, const std::string &key, T value) {
+  if (sampled_values_total >= MAX_SAMPLED_VALUES_TOTAL) {
+    flush();
+  }
+  Samples<T> &samples = get_aggregate(key).*field;
+  samples.count += 1;
+  if (samples.sampled.size() < max_sampled_values) {
+    samples.sampled.push_back(value);
+    ++sampled_values_total;
+    return;
+  }
+  // every written value gets into the sample with the same probability max_sampled_values / count
+  const auto index = std::uniform_int_distribution<uint64_t>{0, static_cast<uint64_t>(samples.count) - 1}(gen);
+  if (index < samples.sampled.size()) {
+    samples.sampled[index] = value;
+  }
+}
+
+void StatsHouseClient::send_aggregate(const std::string &key, Aggregate &aggregate) {
+  const char *pos = key.data();
+  const char *end = pos + key.size();
+  auto builder = transport.metric(next_key_part(pos));
+  while (pos != end) {
+    const char kind = *pos++;
+    const std::string_view first = next_key_part(pos);
+    if (kind == NAMED_TAG) {
+      builder.tag(first, next_key_part(pos));
+    } else {
+      builder.tag(first);
+    }
+  }
+
+  if (aggregate.count != 0) {
+    builder.write_count(aggregate.count);
+  }
+  if (!aggregate.values.sampled.empty()) {
+    builder.write_values(aggregate.values.sampled.data(), aggregate.values.sampled.size(), aggregate.values.count);
+  }
+  if (!aggregate.uniques.sampled.empty()) {
+    auto &uniques = aggregate.uniques.sampled;
+    std::sort(uniques.begin(), uniques.end());
+    uniques.erase(std::unique(uniques.begin(), uniques.end()), uniques.end());
+    builder.write_unique(uniques.data(), uniques.size(), aggregate.uniques.count);
+  }
+}
+
+void StatsHouseClient::flush() {
+  for (auto &[key, aggregate] : aggregates) {
+    send_aggregate(key, aggregate);
+  }
+  aggregates.clear();
+  sampled_values_total = 0;
+  transport.flush(true);
+}
@@ -4,16 +4,63 @@
 
 #pragma once
 
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/mixin/not_copyable.h"
+
 #include "third-party/statshouse.h"
 
-class StatsHouseClient {
+// Metrics are not sent on every write: they are pre-aggregated by a metric name with tags in the process memory
+// and are sent in a batch on flush(), that is called by cron once a second.
+// Counters are summed; values and uniques are kept as is till max_sampled_values per key,
+// then they are sampled uniformly (reservoir sampling) and sent with the count of all the written ones.
+// Too many keys or kept values in total make the client flush earlier, so the memory is bounded.
+class StatsHouseClient : vk::not_copyable {
 public:
+  class MetricBuilder {
+  public:
+    MetricBuilder &tag(std::string_view value);
+    MetricBuilder &tag(std::string_view name, std::string_view value);
+
+    void write_count(double count);
+    void write_value(double value);
+    void write_unique(uint64_t value);
+
+  private:
+    friend class StatsHouseClient;
+
+    MetricBuilder(StatsHouseClient &client, std::string_view name);
+
+    StatsHouseClient &client;
+    // the metric name, then tags, see StatsHouseClient::send_aggregate()
+    std::string key;
+  };
+
   // Safe to use dummy instance
-  StatsHouseClient() : transport({}, {}) {}
+  StatsHouseClient() : transport({}, {}), dummy(true) {}
+
+  StatsHouseClient(const std::string &ip, int port) : transport(ip, port), dummy(ip.empty() || port == 0) {}
+
+  ~StatsHouseClient() {
+    flush();
+  }
 
-  StatsHouseClient(const std::string &ip, int port) : transport(ip, port) {}
+  static void set_max_sampled_values(size_t max_values) {
+    max_sampled_values = max_values;
+  }
+
+  MetricBuilder metric(std::string_view name, bool force_tag_host = false);
 
-  statshouse::TransportUDPBase::MetricBuilder metric(std::string_view name, bool force_tag_host = false);
+  // sends all the aggregated metrics
+  void flush();
+
+  // values and uniques kept in all the aggregates
+  size_t sampled_values_count() const {
+    return sampled_values_total;
+  }
 
   void set_tag_cluster(std::string_view cluster) {
     tag_cluster = cluster;
@@ -32,7 +79,37 @@ public:
   }
 
 private:
+  // too many keys mean high cardinality tags, they are flushed earlier not to grow the memory
+  static constexpr size_t MAX_AGGREGATED_KEYS = 4096;
+  // 8 bytes each, so it is 2 MB at most
+  static constexpr size_t MAX_SAMPLED_VALUES_TOTAL = 256 * 1024;
+  static inline size_t max_sampled_values = 1024;
+
+  template<class T>
+  struct Samples {
+    std::vector<T> sampled;
+    double count{0};
+  };
+
+  struct Aggregate {
+    double count{0};
+    Samples<double> values;
+    Samples<uint64_t> uniques;
+  };
+
+  Aggregate &get_aggregate(const std::string &key);
+
+  template<class T>
+  void add_sample(Samples<T> Aggregate::*field, const std::string &key, T value);
+
+  void send_aggregate(const std::string &key, Aggregate &aggregate);
+
   statshouse::TransportUDP transport;
+  // nothing is aggregated if metrics are not sent anywhere
+  const bool dummy;
+  std::unordered_map<std::string, Aggregate> aggregates;
+  size_t sampled_values_total{0};
+  std::minstd_rand gen;
   std::string tag_cluster;
   std::string tag_host;
   bool host_enabled{false};
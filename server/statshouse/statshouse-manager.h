@@ -37,6 +37,14 @@ public:
   void generic_cron() {
     generic_cron_check_if_tag_host_needed();
     set_common_tags();
+    client.flush();
+  }
+
+  /**
+   * Sends metrics aggregated so far, e.g. the master calls it before a fork not to duplicate them in a worker
+   */
+  void flush() {
+    client.flush();
   }
 
   /**
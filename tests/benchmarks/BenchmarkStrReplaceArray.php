@@ -0,0 +1,33 @@
+<?php
+
+class BenchmarkStrReplaceArray {
+  private $template = '';
+  private $search = [];
+  private $replace = [];
+  private $pairs = [];
+
+  public function __construct() {
+    for ($i = 0; $i < 50; ++$i) {
+      $this->search[] = "{placeholder_$i}";
+      $this->replace[] = "value number $i";
+    }
+    $this->pairs = array_combine($this->search, $this->replace);
+    $this->template = str_repeat('<div class="item">{placeholder_3} and {placeholder_42}, {placeholder_17}</div>', 20);
+  }
+
+  public function benchmarkStrReplace50() {
+    return str_replace($this->search, $this->replace, $this->template);
+  }
+
+  public function benchmarkStrtr50() {
+    return strtr($this->template, $this->pairs);
+  }
+
+  public function benchmarkStrReplaceConstEscape() {
+    return str_replace(['<', '>', '&', '"', "'"], ['&lt;', '&gt;', '&amp;', '&quot;', '&#039;'], $this->template);
+  }
+
+  public function benchmarkStrtrConst() {
+    return strtr($this->template, ['{placeholder_3}' => 'a', '{placeholder_42}' => 'b', '{placeholder_17}' => 'c', '<div' => '<span']);
+  }
+}
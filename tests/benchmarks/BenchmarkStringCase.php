@@ -0,0 +1,56 @@
+<?php
+
+class BenchmarkStringCase {
+  private $short_mixed = 'Hello, World!';
+  private $long_lower = '';
+  private $long_mixed = '';
+  private $long_html = '';
+  private $padded = '';
+
+  public function __construct() {
+    $this->long_lower = str_repeat('the quick brown fox jumps over the lazy dog ', 20);
+    $this->long_mixed = str_repeat('The Quick Brown Fox Jumps Over The Lazy Dog ', 20);
+    $this->long_html = str_repeat('<a href="/profile?id=1&amp;tab=2">it\'s me</a> plain text here ', 10);
+    $this->padded = "  \t\n" . $this->long_lower . "\n\r  ";
+  }
+
+  public function benchmarkStrtolowerShort() {
+    return strtolower($this->short_mixed);
+  }
+
+  public function benchmarkStrtolowerLong() {
+    return strtolower($this->long_mixed);
+  }
+
+  public function benchmarkStrtolowerLongNoop() {
+    return strtolower($this->long_lower);
+  }
+
+  public function benchmarkStrtoupperLong() {
+    return strtoupper($this->long_mixed);
+  }
+
+  public function benchmarkUcfirst() {
+    return ucfirst($this->long_mixed);
+  }
+
+  public function benchmarkStripos() {
+    return stripos($this->long_lower, 'LAZY CAT');
+  }
+
+  public function benchmarkStrIreplace() {
+    return str_ireplace('FOX', 'cat', $this->long_mixed);
+  }
+
+  public function benchmarkTrim() {
+    return trim($this->padded);
+  }
+
+  public function benchmarkHtmlspecialchars() {
+    return htmlspecialchars($this->long_html, ENT_QUOTES);
+  }
+
+  public function benchmarkHtmlspecialcharsNoop() {
+    return htmlspecialchars($this->long_lower);
+  }
+}
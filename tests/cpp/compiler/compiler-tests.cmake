@@ -4,7 +4,10 @@ prepend(COMPILER_TESTS_SOURCES ${BASE_DIR}/tests/cpp/compiler/
         phpdoc-test.cpp
         typedata-test.cpp
         lexer-test.cpp
+        make/object-cache-test.cpp
         ffi-parser-test.cpp
+        profile-guided-data-test.cpp
+        threading/hash-table-test.cpp
         utils/string-utils-test.cpp)
 
 vk_add_unittest(compiler "${COMPILER_LIBS}" ${COMPILER_TESTS_SOURCES})
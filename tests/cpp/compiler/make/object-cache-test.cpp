@@ -0,0 +1,196 @@
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "compiler/compiler-settings.h"
+#include "compiler/make/object-cache.h"
+
+namespace {
+
+std::string make_temp_dir() {
+  std::string dir = testing::TempDir() + "object-cache-test-XXXXXX";
+  EXPECT_NE(mkdtemp(&dir[0]), nullptr);
+  return dir + "/";
+}
+
+void init_settings(CompilerSettings &settings, const std::string &cache_dir, const std::string &cxx_flags) {
+  KphpRawOption &option = settings.object_cache_dir;
+  option.set_option_arg_value(cache_dir.c_str());
+  option.parse_arg_value();
+  settings.cxx_flags_default.init("", "g++", cxx_flags, "", false);
+  settings.cxx_flags_with_debug.init("", "g++", cxx_flags + " -g", "", false);
+}
+
+void write_file(const std::string &path, const std::string &content) {
+  std::ofstream{path} << content;
+}
+
+std::string read_file(const std::string &path) {
+  std::stringstream content;
+  content << std::ifstream{path}.rdbuf();
+  return content.str();
+}
+
+int count_files(const std::string &dir) {
+  DIR *d = opendir(dir.c_str());
+  int count = 0;
+  while (const dirent *entry = readdir(d)) {
+    count += entry->d_name[0] != '.';
+  }
+  closedir(d);
+  return count;
+}
+
+// o_1/f.cpp including o_1/f.h
+File *make_cpp_file(Index &cpp_dir) {
+  File *cpp_file = cpp_dir.insert_file("o_1/f.cpp");
+  cpp_file->crc64 = 1;
+  cpp_file->crc64_with_comments = 2;
+  cpp_file->includes.emplace_front("o_1/f.h");
+  File *header = cpp_dir.insert_file("o_1/f.h");
+  header->crc64 = 3;
+  header->crc64_with_comments = 4;
+  return cpp_file;
+}
+
+} // namespace
+
+TEST(object_cache_test, hit_on_same_inputs) {
+  const std::string dir = make_temp_dir();
+  CompilerSettings settings;
+  init_settings(settings, dir + "cache/", "-O2");
+  Index cpp_dir;
+  cpp_dir.set_dir(dir + "cpp/");
+  File *cpp_file = make_cpp_file(cpp_dir);
+  File *obj_file = cpp_dir.insert_file("o_1/f.o");
+
+  ObjectCache cache{settings, cpp_dir};
+  ASSERT_TRUE(cache.enabled());
+  const std::string key = cache.calc_key(cpp_file);
+  ASSERT_FALSE(key.empty());
+  ASSERT_FALSE(cache.fetch(key, obj_file));
+
+  write_file(obj_file->path, "object");
+  cache.store(key, *obj_file);
+  std::remove(obj_file->path.c_str());
+
+  // another build with the same inputs, e.g. in another checkout
+  Index other_cpp_dir;
+  other_cpp_dir.set_dir(dir + "other-cpp/");
+  File *other_obj_file = other_cpp_dir.insert_file("o_1/f.o");
+  ObjectCache other_cache{settings, other_cpp_dir};
+  const std::string other_key = other_cache.calc_key(make_cpp_file(other_cpp_dir));
+  ASSERT_EQ(other_key, key);
+  ASSERT_TRUE(other_cache.fetch(other_key, other_obj_file));
+  ASSERT_TRUE(other_obj_file->on_disk);
+  ASSERT_EQ(read_file(other_obj_file->path), "object");
+
+  FILE *stats_file = tmpfile();
+  cache.write_stats(stats_file);
+  other_cache.write_stats(stats_file);
+  rewind(stats_file);
+  char stats[256] = {0};
+  ASSERT_GT(fread(stats, 1, sizeof(stats) - 1, stats_file), 0);
+  fclose(stats_file);
+  ASSERT_STREQ(stats, "object cache: 0 hits, 1 misses, 1 stored\nobject cache: 1 hits, 0 misses, 0 stored\n");
+}
+
+TEST(object_cache_test, miss_on_changed_inputs) {
+  const std::string dir = make_temp_dir();
+  CompilerSettings settings;
+  init_settings(settings, dir + "cache/", "-O2");
+  Index cpp_dir;
+  cpp_dir.set_dir(dir + "cpp/");
+  File *cpp_file = make_cpp_file(cpp_dir);
+  File *header = cpp_dir.get_file("o_1/f.h");
+  File *obj_file = cpp_dir.insert_file("o_1/f.o");
+
+  ObjectCache cache{settings, cpp_dir};
+  const std::string key = cache.calc_key(cpp_file);
+  write_file(obj_file->path, "object");
+  cache.store(key, *obj_file);
+
+  // C++ flags
+  CompilerSettings other_settings;
+  init_settings(other_settings, dir + "cache/", "-O3");
+  ObjectCache other_cache{other_settings, cpp_dir};
+  const std::string other_flags_key = other_cache.calc_key(cpp_file);
+  ASSERT_FALSE(other_flags_key.empty());
+  ASSERT_NE(other_flags_key, key);
+  ASSERT_FALSE(other_cache.fetch(other_flags_key, obj_file));
+  cpp_file->compile_with_debug_info_flag = false;
+  ASSERT_NE(cache.calc_key(cpp_file), key);
+  cpp_file->compile_with_debug_info_flag = true;
+
+  // a hash of an included header, with and without comments
+  header->crc64 = 5;
+  const std::string other_header_key = cache.calc_key(cpp_file);
+  ASSERT_NE(other_header_key, key);
+  ASSERT_FALSE(cache.fetch(other_header_key, obj_file));
+  header->crc64 = 3;
+  header->crc64_with_comments = 5;
+  ASSERT_NE(cache.calc_key(cpp_file), key);
+  header->crc64_with_comments = 4;
+  ASSERT_EQ(cache.calc_key(cpp_file), key);
+
+  // files with unknown hashes are not cached
+  header->crc64 = static_cast<unsigned long long>(-1);
+  ASSERT_TRUE(cache.calc_key(cpp_file).empty());
+  ASSERT_FALSE(cache.fetch({}, obj_file));
+  header->crc64 = 3;
+  cpp_file->lib_includes.emplace_front("lib/f.h");
+  ASSERT_TRUE(cache.calc_key(cpp_file).empty());
+  cpp_file->lib_includes.clear();
+
+  // profiles are not a part of the key
+  KphpRawOption &profile_use_dir = settings.cxx_profile_use_dir;
+  profile_use_dir.set_option_arg_value((dir + "profiles/").c_str());
+  profile_use_dir.parse_arg_value();
+  ASSERT_FALSE((ObjectCache{settings, cpp_dir}.enabled()));
+}
+
+TEST(object_cache_test, atomic_store) {
+  const std::string dir = make_temp_dir();
+  CompilerSettings settings;
+  init_settings(settings, dir + "cache/", "-O2");
+  Index cpp_dir;
+  cpp_dir.set_dir(dir + "cpp/");
+  File *cpp_file = make_cpp_file(cpp_dir);
+  File *obj_file = cpp_dir.insert_file("o_1/f.o");
+
+  ObjectCache cache{settings, cpp_dir};
+  const std::string key = cache.calc_key(cpp_file);
+  const std::string cached_path = dir + "cache/" + key.substr(0, 2) + "/" + key.substr(2) + ".o";
+  write_file(obj_file->path, "object");
+  cache.store(key, *obj_file);
+  ASSERT_EQ(read_file(cached_path), "object");
+  struct stat cached_stat;
+  ASSERT_EQ(stat(cached_path.c_str(), &cached_stat), 0);
+  ASSERT_EQ(cached_stat.st_mode & 0777, 0644);
+
+  // another build publishes the object at the same time: a reader of the cached file sees either the old or the new file
+  const int reader_fd = open(cached_path.c_str(), O_RDONLY);
+  ASSERT_NE(reader_fd, -1);
+  write_file(obj_file->path, "new object");
+  cache.store(key, *obj_file);
+  char content[16] = {0};
+  ASSERT_EQ(read(reader_fd, content, sizeof(content)), 6);
+  ASSERT_STREQ(content, "object");
+  close(reader_fd);
+  ASSERT_EQ(read_file(cached_path), "new object");
+
+  // no tmp files are left
+  ASSERT_EQ(count_files(dir + "cache/" + key.substr(0, 2)), 1);
+
+  // a fetched object is a copy, the C++ compiler may rewrite it in place
+  ASSERT_TRUE(cache.fetch(key, obj_file));
+  write_file(obj_file->path, "rebuilt");
+  ASSERT_EQ(read_file(cached_path), "new object");
+}
@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+
+#include "compiler/profile-guided-data.h"
+#include "compiler/stage.h"
+
+namespace {
+
+// "<line> <16 events>" with cpu_ns as the 15th event
+std::string stats(uint64_t cpu_ns) {
+  return "1 0 0 0 0 0 0 0 0 0 0 0 0 0 0 " + std::to_string(cpu_ns) + " 0\n";
+}
+
+std::string write_profile(const std::string &content) {
+  const std::string file_name = testing::TempDir() + "profile-guided-data-test.callgrind";
+  std::ofstream{file_name} << content;
+  return file_name;
+}
+
+} // namespace
+
+TEST(profile_guided_data_test, load_from) {
+  stage::set_name("Load profile");
+  const std::string file_name = write_profile(
+    "# callgrind format\n"
+    "version: 1\n"
+    "events: total_allocations total_memory_allocated memory_allocated real_memory_allocated query_ctx_swaps "
+    "rpc_outgoing_queries rpc_outgoing_traffic rpc_incoming_traffic sql_outgoing_queries sql_outgoing_traffic sql_incoming_traffic "
+    "mc_outgoing_queries mc_outgoing_traffic mc_incoming_traffic cpu_ns net_ns\n"
+    "\n"
+    "fl=index.php\n"
+    "fn=main\n" + stats(1000) +
+    "cfl=a.php\n"
+    "cfn=hot_f\n"
+    "calls=10000000\n" + stats(960000) +
+    "cfl=a.php\n"
+    "cfn=warm_f (label)\n"
+    "calls=5000\n" + stats(39000) +
+    "cfl=a.php\n"
+    "cfn=cold_f\n"
+    "calls=1\n" + stats(1) +
+    "\n"
+    "fl=a.php\n"
+    "fn=hot_f\n" + stats(900000) +
+    "fl=a.php\n"
+    "fn=hot_f (label)\n" + stats(60000) +
+    "fl=a.php\n"
+    "fn=warm_f\n" + stats(39000) +
+    "fl=a.php\n"
+    "fn=cold_f\n" + stats(1));
+
+  ProfileGuidedData profile;
+  ASSERT_TRUE(profile.empty());
+  profile.load_from(file_name);
+  std::remove(file_name.c_str());
+  ASSERT_FALSE(stage::has_error());
+  ASSERT_FALSE(profile.empty());
+
+  // labeled stats are summed with unlabeled ones
+  const auto *hot_f = profile.find("hot_f");
+  ASSERT_NE(hot_f, nullptr);
+  ASSERT_EQ(hot_f->calls, 10000000);
+  ASSERT_EQ(hot_f->self_working_ns, 960000);
+  ASSERT_NE(profile.find("warm_f"), nullptr);
+  ASSERT_EQ(profile.find("warm_f")->calls, 5000);
+  ASSERT_EQ(profile.find("warm_f (label)"), nullptr);
+  ASSERT_EQ(profile.find("unknown_f"), nullptr);
+
+  ASSERT_TRUE(profile.is_hot("hot_f"));
+  ASSERT_FALSE(profile.is_cold("hot_f"));
+  ASSERT_FALSE(profile.is_hot("warm_f"));
+  ASSERT_FALSE(profile.is_cold("warm_f"));
+  ASSERT_FALSE(profile.is_hot("cold_f"));
+  ASSERT_TRUE(profile.is_cold("cold_f"));
+  // main isn't called by other functions, but it takes the time
+  ASSERT_FALSE(profile.is_hot("main"));
+  ASSERT_FALSE(profile.is_cold("main"));
+  ASSERT_FALSE(profile.is_hot("unknown_f"));
+  ASSERT_FALSE(profile.is_cold("unknown_f"));
+}
+
+TEST(profile_guided_data_test, bad_profile) {
+  stage::set_name("Load bad profile");
+  const std::string file_name = write_profile(
+    "fl=a.php\n"
+    "fn=f\n"
+    "1 0 0 100\n");
+  ProfileGuidedData profile;
+  profile.load_from(file_name);
+  std::remove(file_name.c_str());
+  ASSERT_TRUE(stage::has_error());
+
+  stage::set_name("Load missing profile");
+  ProfileGuidedData missing;
+  missing.load_from(file_name);
+  ASSERT_TRUE(stage::has_error());
+  ASSERT_TRUE(missing.empty());
+  stage::get_stage_info_ptr()->global_error_flag = false;
+}
@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "compiler/threading/hash-table.h"
+
+TEST(hash_table_test, insert_and_find) {
+  TSHashTable<int> ht;
+  ASSERT_EQ(ht.find(0), nullptr);
+  ASSERT_TRUE(ht.get_all().empty());
+
+  // 0 is a valid hash as well
+  for (unsigned long long hash = 0; hash < 100000; ++hash) {
+    auto *node = ht.at(hash);
+    ASSERT_EQ(node->hash, hash);
+    node->data = static_cast<int>(hash) + 1;
+  }
+  for (unsigned long long hash = 0; hash < 100000; ++hash) {
+    ASSERT_EQ(ht.at(hash)->data, static_cast<int>(hash) + 1);
+    ASSERT_EQ(*ht.find(hash), static_cast<int>(hash) + 1);
+  }
+  ASSERT_EQ(ht.find(100000), nullptr);
+  ASSERT_EQ(ht.get_all().size(), 100000);
+  ASSERT_EQ(ht.get_all_if([](int x) { return x % 2 == 0; }).size(), 50000);
+}
+
+TEST(hash_table_test, concurrent_insertions) {
+  TSHashTable<int> ht;
+  constexpr int threads_count = 8;
+  constexpr unsigned long long hashes_count = 50000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_count; ++t) {
+    threads.emplace_back([&ht] {
+      // all threads insert the same hashes, nodes must be shared and never move
+      for (unsigned long long i = 0; i < hashes_count; ++i) {
+        auto *node = ht.at(i * 0x100000001ULL);
+        AutoLocker<Lockable *> locker{node};
+        node->data++;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto all = ht.get_all();
+  ASSERT_EQ(all.size(), hashes_count);
+  ASSERT_TRUE(std::all_of(all.begin(), all.end(), [](int x) { return x == threads_count; }));
+}
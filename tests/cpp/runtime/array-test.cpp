@@ -132,3 +132,26 @@ TEST(array_test, test_mutate_shared_map) {
   ASSERT_EQ(arr_copy.get_reference_counter(), 1);
   ASSERT_FALSE(arr_copy.is_equal_inner_pointer(arr));
 }
+
+TEST(array_test, test_merge_vectors) {
+  auto ints = array<int64_t>::create(1, 2, 3);
+  const auto ints_copy = ints;
+  ints.merge_with(array<int64_t>::create(4, 5));
+  ASSERT_TRUE(ints.is_vector());
+  ASSERT_EQ(ints.count(), 5);
+  for (int64_t i = 0; i < 5; ++i) {
+    ASSERT_EQ(ints.get_value(i), i + 1);
+  }
+  ASSERT_EQ(ints_copy.count(), 3);
+
+  auto strings = array<string>::create(string{"a"}, string{"b"});
+  strings.merge_with(strings);
+  ASSERT_TRUE(strings.is_vector());
+  ASSERT_EQ(strings.count(), 4);
+  ASSERT_EQ(strings.get_value(3), string{"b"});
+
+  const auto sum = array<double>::create(1.0, 2.0) + array<double>::create(10.0, 20.0, 30.0);
+  ASSERT_TRUE(sum.is_vector());
+  ASSERT_EQ(sum.count(), 3);
+  ASSERT_EQ(sum.get_value(2), 30.0);
+}
@@ -168,6 +168,30 @@ struct Stub : public refcountable_php_classes<Stub> {
       }
     }
   }
+  void msgpack_unpack(vk::msgpack::direct_unpacker &unpacker, const vk::msgpack::object &header) {
+    for (uint32_t counter = unpacker.unpack_instance_fields_count(header); counter > 0; --counter) {
+      switch (unpacker.unpack<uint8_t>()) {
+        case 1:
+          unpacker.unpack(d);
+          break;
+        case 2:
+          unpacker.unpack(i);
+          break;
+        case 3:
+          unpacker.unpack(s);
+          break;
+        case 4:
+          unpacker.unpack(m);
+          break;
+        case 5:
+          unpacker.unpack(a);
+          break;
+        default:
+          unpacker.skip();
+          break;
+      }
+    }
+  }
 };
 
 bool eq2(const Stub &lhs, const Stub &rhs) {
@@ -199,3 +223,25 @@ TEST(msgpack, array_extended) {
                                                  Stub(42_i64, -0.0, 42_i64, {}, array<mixed>::create(string("0"), string(""), 42, -0.0)),
                                                  Stub({}, -0.0, 42_i64, string("string"), array<mixed>::create(string("0"), string(""), 42, -0.0))));
 }
+
+TEST(msgpack, direct_unpacker_skips_unknown_tags) {
+  // [1, 2.5, 7, {"x": [1, 2]}, 2, 42] where tag 7 is unknown
+  const string buffer("\x96\x01\xcb\x40\x04\x00\x00\x00\x00\x00\x00\x07\x81\xa1x\x92\x01\x02\x02\x2a", 20);
+  const Stub res = f$msgpack_deserialize<Stub>(buffer);
+  ASSERT_EQ(res.d, 2.5);
+  ASSERT_EQ(res.i, 42);
+}
+
+TEST(msgpack, errors_of_direct_unpacking) {
+  string err_msg;
+  f$msgpack_deserialize<mixed>(string("\x01\x02", 2), &err_msg);
+  ASSERT_STREQ(err_msg.c_str(), "Consumed only first 1 characters of 2 during deserialization");
+
+  err_msg = string();
+  f$msgpack_deserialize<int64_t>(string("\xa1x", 2), &err_msg);
+  ASSERT_STREQ(err_msg.c_str(), "Unknown type found during deserialization");
+
+  err_msg = string();
+  f$msgpack_deserialize<array<int64_t>>(string("\xdd\xff\xff\xff\xff\x01", 6), &err_msg);
+  ASSERT_FALSE(err_msg.empty());
+}
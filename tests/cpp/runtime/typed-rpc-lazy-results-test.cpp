@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include "runtime/exception.h"
+#include "runtime/rpc.h"
+#include "runtime/typed_rpc.h"
+
+namespace {
+
+struct C$TestResult : refcountable_polymorphic_php_classes<C$VK$TL$RpcFunctionReturnResult> {
+  int64_t $value{0};
+};
+
+// a result with a nested !X, like rpcProxy.diagonalTargets
+struct C$TestNestedResult : refcountable_polymorphic_php_classes<C$VK$TL$RpcFunctionReturnResult> {
+  int64_t $count{0};
+  array<class_instance<C$VK$TL$RpcFunctionReturnResult>> $results;
+};
+
+// fetches the result of a function returning an int
+struct TestFetcher : tl_func_base {
+  mixed fetch() final {
+    return {};
+  }
+
+  class_instance<C$VK$TL$RpcFunctionReturnResult> typed_fetch() final {
+    class_instance<C$TestResult> result;
+    result.alloc();
+    result.get()->$value = TRY_CALL(int32_t, class_instance<C$VK$TL$RpcFunctionReturnResult>, rpc_fetch_int());
+    return result;
+  }
+};
+
+// fetches the result of a function returning a vector of !X, where X is a function returning an int
+struct TestNestedFetcher : tl_func_base {
+  tl_exclamation_fetch_wrapper X{make_unique_on_script_memory<TestFetcher>()};
+
+  mixed fetch() final {
+    return {};
+  }
+
+  class_instance<C$VK$TL$RpcFunctionReturnResult> typed_fetch() final {
+    class_instance<C$TestNestedResult> result;
+    result.alloc();
+    result.get()->$count = TRY_CALL(int32_t, class_instance<C$VK$TL$RpcFunctionReturnResult>, rpc_fetch_int());
+    for (int64_t i = 0; i < result.get()->$count; ++i) {
+      class_instance<C$VK$TL$RpcFunctionReturnResult> item;
+      X.typed_fetch_to(item);
+      result.get()->$results.push_back(item);
+    }
+    return result;
+  }
+};
+
+// fetches an answer [header, result...] like t_ReqResult does
+template<class FetcherT>
+class_instance<C$VK$TL$RpcFunctionReturnResult> fetch_answer(const std::vector<int32_t> &answer) {
+  f$rpc_parse(string{reinterpret_cast<const char *>(answer.data()), static_cast<string::size_type>(answer.size() * sizeof(int32_t))});
+  rpc_fetch_int();
+  CurrentProcessingQuery::get().set_current_tl_function(string{"test.getInt"});
+  class_instance<C$VK$TL$RpcFunctionReturnResult> result;
+  tl_exclamation_lazy_fetch_wrapper(make_unique_on_script_memory<FetcherT>()).typed_fetch_to(result);
+  CurrentProcessingQuery::get().reset();
+  EXPECT_TRUE(f$fetch_eof());
+  rpc_parse_restore_previous();
+  return result;
+}
+
+int64_t result_value(const class_instance<C$VK$TL$RpcFunctionReturnResult> &result) {
+  EXPECT_TRUE(result.is_a<C$TestResult>());
+  return result.cast_to<C$TestResult>().get()->$value;
+}
+
+} // namespace
+
+TEST(typed_rpc_lazy_results_test, fetch_on_first_access) {
+  RpcLazyResults::get().set_enabled(true);
+
+  const auto first = fetch_answer<TestFetcher>({0x1, 42});
+  const auto second = fetch_answer<TestFetcher>({0x1, -7});
+  ASSERT_TRUE(first.is_a<RpcLazyResult>());
+  ASSERT_TRUE(second.is_a<RpcLazyResult>());
+
+  const auto second_result = RpcLazyResults::fetch(second);
+  ASSERT_EQ(result_value(second_result), -7);
+  // a response shared by clone gets the same result
+  ASSERT_TRUE(RpcLazyResults::fetch(second) == second_result);
+
+  ASSERT_EQ(result_value(RpcLazyResults::fetch(first)), 42);
+
+  RpcLazyResults::get().reset();
+  ASSERT_FALSE(RpcLazyResults::get().enabled());
+}
+
+TEST(typed_rpc_lazy_results_test, not_lazy) {
+  const auto result = fetch_answer<TestFetcher>({0x1, 42});
+  ASSERT_EQ(result_value(result), 42);
+  ASSERT_TRUE(RpcLazyResults::fetch(result) == result);
+  ASSERT_TRUE(RpcLazyResults::fetch({}).is_null());
+}
+
+TEST(typed_rpc_lazy_results_test, nested_result) {
+  RpcLazyResults::get().set_enabled(true);
+
+  const auto nested = fetch_answer<TestNestedFetcher>({0x1, 3, 10, 20, 30});
+  const auto next = fetch_answer<TestFetcher>({0x1, 42});
+
+  const auto result = RpcLazyResults::fetch(nested).cast_to<C$TestNestedResult>();
+  ASSERT_FALSE(result.is_null());
+  ASSERT_EQ(result.get()->$count, 3);
+  ASSERT_EQ(result.get()->$results.count(), 3);
+  ASSERT_EQ(result_value(result.get()->$results[0]), 10);
+  ASSERT_EQ(result_value(result.get()->$results[1]), 20);
+  ASSERT_EQ(result_value(result.get()->$results[2]), 30);
+
+  ASSERT_EQ(result_value(RpcLazyResults::fetch(next)), 42);
+
+  RpcLazyResults::get().reset();
+}
+
+TEST(typed_rpc_lazy_results_test, broken_result) {
+  RpcLazyResults::get().set_enabled(true);
+
+  const auto empty = fetch_answer<TestFetcher>({0x1});
+  ASSERT_TRUE(RpcLazyResults::fetch(empty).is_null());
+  ASSERT_TRUE(CurException.is_null());
+  ASSERT_TRUE(RpcLazyResults::fetch(empty).is_null());
+
+  const auto extra_data = fetch_answer<TestFetcher>({0x1, 42, 43});
+  ASSERT_TRUE(RpcLazyResults::fetch(extra_data).is_null());
+
+  RpcLazyResults::get().reset();
+}
+
+TEST(typed_rpc_lazy_results_test, copy) {
+  RpcLazyResults::get().set_enabled(true);
+
+  const auto result = fetch_answer<TestFetcher>({0x1, 42});
+  const auto copy = result.virtual_builtin_clone();
+  ASSERT_TRUE(copy.is_a<RpcLazyResult>());
+  ASSERT_TRUE(RpcLazyResults::fetch(copy).is_null());
+  ASSERT_EQ(result_value(RpcLazyResults::fetch(result)), 42);
+
+  RpcLazyResults::get().reset();
+}
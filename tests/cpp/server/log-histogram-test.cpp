@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include "server/log-histogram.h"
+
+TEST(log_histogram_test, buckets) {
+  for (uint64_t value : {0ULL, 1ULL, 15ULL, 16ULL, 17ULL, 31ULL, 32ULL, 1000ULL, 123456789ULL, ~0ULL}) {
+    const size_t index = log_histogram::bucket_index(value);
+    ASSERT_LT(index, log_histogram::BUCKETS_COUNT);
+    const uint64_t middle = log_histogram::bucket_value(index);
+    ASSERT_EQ(log_histogram::bucket_index(middle), index);
+    ASSERT_LE(std::max(middle, value) - std::min(middle, value), value / 16);
+  }
+  for (uint64_t value = 1; value < 100000; ++value) {
+    ASSERT_LE(log_histogram::bucket_index(value - 1), log_histogram::bucket_index(value));
+  }
+}
+
+TEST(log_histogram_test, quantiles) {
+  auto shared = std::make_unique<SharedLogHistogram>();
+  auto window = std::make_unique<WindowLogHistogram>();
+
+  std::mt19937 gen{42};
+  std::vector<uint64_t> values;
+  for (int i = 0; i < 100000; ++i) {
+    values.emplace_back(std::uniform_int_distribution<uint64_t>{1, 1000000000}(gen));
+    shared->add(values.back());
+  }
+  // a rare tail value must be visible
+  shared->add(1ULL << 40);
+  values.emplace_back(1ULL << 40);
+
+  const auto now = std::chrono::steady_clock::now();
+  window->recalc(*shared, now, std::chrono::minutes{1});
+  std::sort(values.begin(), values.end());
+  auto expected = [&values](size_t p, size_t base) { return values[p * (values.size() - 1) / base]; };
+  auto near = [](uint64_t actual, uint64_t expected) { return std::max(actual, expected) - std::min(actual, expected) <= expected / 16; };
+
+  ASSERT_TRUE(near(window->quantiles.p50, expected(50, 100)));
+  ASSERT_TRUE(near(window->quantiles.p90, expected(90, 100)));
+  ASSERT_TRUE(near(window->quantiles.p99, expected(99, 100)));
+  ASSERT_TRUE(near(window->quantiles.p999, expected(999, 1000)));
+  ASSERT_EQ(window->quantiles.max, 1ULL << 40);
+
+  // shared buckets are moved to the window, old intervals are forgotten
+  window->recalc(*shared, now + std::chrono::seconds{5}, std::chrono::minutes{1});
+  ASSERT_EQ(window->quantiles.max, 1ULL << 40);
+  window->recalc(*shared, now + std::chrono::minutes{2}, std::chrono::minutes{1});
+  ASSERT_EQ(window->quantiles.max, 0);
+  ASSERT_EQ(window->quantiles.p50, 0);
+}
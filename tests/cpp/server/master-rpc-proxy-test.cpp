@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "net/net-connections.h"
+#include "net/net-sockaddr-storage.h"
+#include "server/master-rpc-proxy.h"
+
+TEST(master_rpc_proxy_test, wrap_query) {
+  // [len, seq, op, req_id, query..., crc]
+  std::vector<int> request{9 * 4, 0, 0x2374df3d, 0, 0, 0x11, 0x22, 0x33, 0x44};
+  const auto &wrapped = MasterRpcProxy::wrap_query(0x7f000001, 12345, 300, request.data(), static_cast<int>(request.size() * sizeof(int)));
+  ASSERT_EQ(wrapped.size(), request.size() + 4);
+  ASSERT_EQ(wrapped[0], static_cast<int>(wrapped.size() * sizeof(int)));
+  ASSERT_EQ(wrapped[2], 0x2374df3d);
+  ASSERT_EQ(wrapped[6], 0x7f000001);
+  ASSERT_EQ(wrapped[7], 12345);
+  ASSERT_EQ(wrapped[8], 300);
+  ASSERT_TRUE(std::equal(request.begin() + 5, request.end(), wrapped.begin() + 9));
+}
+
+TEST(master_rpc_proxy_test, localhost_target) {
+  auto &proxy = vk::singleton<MasterRpcProxy>::get();
+  const int target_id = 17;
+  uint32_t ip = 0;
+  uint16_t port = 0;
+  ASSERT_FALSE(proxy.get_target_destination(target_id, ip, port));
+
+  // create_target() turns 127.0.0.1:12345 into the engine unix socket, but master gets the inet address
+  proxy.set_target_destination(target_id, make_inet_sockaddr_storage(0x7f000001, 12345));
+  ASSERT_TRUE(proxy.get_target_destination(target_id, ip, port));
+  ASSERT_EQ(ip, 0x7f000001);
+  ASSERT_EQ(port, 12345);
+  const int dest[] = {static_cast<int>(0xa2ca9d07), static_cast<int>(ip), port, 300};
+  ASSERT_TRUE(MasterRpcProxy::is_valid_destination(dest));
+
+  // the target is reused for another address
+  proxy.set_target_destination(target_id, make_unix_sockaddr_storage("/tmp/master-rpc-proxy-test", 12345));
+  ASSERT_FALSE(proxy.get_target_destination(target_id, ip, port));
+}
+
+TEST(master_rpc_proxy_test, routes) {
+  auto &proxy = vk::singleton<MasterRpcProxy>::get();
+  connection worker_conn{};
+  worker_conn.generation = 7;
+
+  const long long first = proxy.add_route(&worker_conn, 100, 1.0);
+  const long long second = proxy.add_route(&worker_conn, 101, 2.0);
+  const long long third = proxy.add_route(&worker_conn, 100, 3.0);
+  ASSERT_NE(first, second);
+  ASSERT_NE(first, third);
+  ASSERT_EQ(proxy.routes_count(), 3);
+
+  long long worker_req_id = 0;
+  ASSERT_EQ(proxy.pop_route(second, worker_req_id), &worker_conn);
+  ASSERT_EQ(worker_req_id, 101);
+  ASSERT_EQ(proxy.pop_route(second, worker_req_id), nullptr);
+
+  // the worker doesn't wait for timed out queries
+  proxy.expire_queries(1.5);
+  ASSERT_EQ(proxy.pop_route(first, worker_req_id), nullptr);
+  ASSERT_EQ(proxy.routes_count(), 1);
+
+  // the worker connection is closed
+  worker_conn.generation = -1;
+  ASSERT_EQ(proxy.pop_route(third, worker_req_id), nullptr);
+  ASSERT_EQ(proxy.routes_count(), 0);
+  proxy.expire_queries(10.0);
+}
+
+TEST(master_rpc_proxy_test, valid_destination) {
+  // rpcProxyDest
+  const int dest_magic = 0xa2ca9d07;
+  const int good[] = {dest_magic, 0x7f000001, 12345, 300};
+  ASSERT_TRUE(MasterRpcProxy::is_valid_destination(good));
+
+  const int wrong_magic[] = {dest_magic + 1, 0x7f000001, 12345, 300};
+  const int no_ip[] = {dest_magic, 0, 12345, 300};
+  const int zero_port[] = {dest_magic, 0x7f000001, 0, 300};
+  const int big_port[] = {dest_magic, 0x7f000001, 0x10000, 300};
+  const int negative_port[] = {dest_magic, 0x7f000001, -1, 300};
+  ASSERT_FALSE(MasterRpcProxy::is_valid_destination(wrong_magic));
+  ASSERT_FALSE(MasterRpcProxy::is_valid_destination(no_ip));
+  ASSERT_FALSE(MasterRpcProxy::is_valid_destination(zero_port));
+  ASSERT_FALSE(MasterRpcProxy::is_valid_destination(big_port));
+  ASSERT_FALSE(MasterRpcProxy::is_valid_destination(negative_port));
+}
+
+TEST(master_rpc_proxy_test, trusted_peer) {
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  ASSERT_TRUE(MasterRpcProxy::is_trusted_peer(fds[0]));
+  close(fds[0]);
+  close(fds[1]);
+
+  // credentials are unknown for not unix sockets
+  ASSERT_EQ(pipe(fds), 0);
+  ASSERT_FALSE(MasterRpcProxy::is_trusted_peer(fds[0]));
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(master_rpc_proxy_test, foreign_peer) {
+  if (getuid() != 0) {
+    GTEST_SKIP() << "a peer of another user can be made by root only";
+  }
+  char dir[] = "/tmp/master-rpc-proxy-test-XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  ASSERT_EQ(chmod(dir, 0755), 0);
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/proxy", dir);
+
+  const int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_GE(listen_fd, 0);
+  ASSERT_EQ(bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+  ASSERT_EQ(chmod(addr.sun_path, 0777), 0);
+  ASSERT_EQ(listen(listen_fd, 1), 0);
+
+  const pid_t pid = fork();
+  if (pid == 0) {
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    const bool connected = setuid(65534) == 0 && connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+    char byte = 0;
+    // waits for the parent to check the connection
+    _exit(connected && read(fd, &byte, 1) >= 0 ? 0 : 1);
+  }
+  ASSERT_GT(pid, 0);
+  const int accepted_fd = accept(listen_fd, nullptr, nullptr);
+  ASSERT_GE(accepted_fd, 0);
+  ASSERT_FALSE(MasterRpcProxy::is_trusted_peer(accepted_fd));
+  close(accepted_fd);
+
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  close(listen_fd);
+  unlink(addr.sun_path);
+  rmdir(dir);
+}
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <iterator>
+
+#include "server/rpc-connection-groups.h"
+
+namespace {
+
+bool all_ready(int) {
+  return true;
+}
+
+} // namespace
+
+TEST(rpc_connection_groups_test, register_group) {
+  auto &groups = vk::singleton<RpcConnectionGroups>::get();
+  const int group = groups.register_group({3, 1, 2, 1});
+  ASSERT_TRUE(RpcConnectionGroups::is_group(group));
+  ASSERT_EQ(groups.register_group({1, 2, 3}), group);
+  ASSERT_NE(groups.register_group({1, 2}), group);
+
+  ASSERT_EQ(groups.register_group({}), -1);
+  ASSERT_EQ(groups.register_group({-1, 2}), -1);
+  ASSERT_EQ(groups.register_group({1, group}), -1);
+  ASSERT_EQ(groups.choose_target(1, 1, 1.0, 0.0, all_ready), -1);
+}
+
+TEST(rpc_connection_groups_test, least_outstanding) {
+  auto &groups = vk::singleton<RpcConnectionGroups>::get();
+  const int group = groups.register_group({10, 11, 12});
+
+  int chosen[3];
+  for (int slot = 0; slot != 3; ++slot) {
+    chosen[slot] = groups.choose_target(group, slot, 100.0, 0.0, all_ready);
+  }
+  std::sort(std::begin(chosen), std::end(chosen));
+  ASSERT_EQ(chosen[0], 10);
+  ASSERT_EQ(chosen[1], 11);
+  ASSERT_EQ(chosen[2], 12);
+
+  // the only target without outstanding queries is chosen
+  groups.on_query_finished(1, true, 0.0);
+  const int target = groups.choose_target(group, 3, 100.0, 0.0, all_ready);
+  ASSERT_EQ(groups.get_outstanding_queries(target), 1);
+  for (int other : {10, 11, 12}) {
+    ASSERT_EQ(groups.get_outstanding_queries(other), 1);
+  }
+
+  // a target without a ready connection is avoided
+  for (int slot : {0, 2, 3}) {
+    groups.on_query_finished(slot, true, 0.0);
+  }
+  for (int slot = 4; slot != 10; ++slot) {
+    ASSERT_NE(groups.choose_target(group, slot, 100.0, 0.0, [](int target) { return target != 11; }), 11);
+  }
+  for (int slot = 4; slot != 10; ++slot) {
+    groups.on_query_finished(slot, true, 0.0);
+  }
+  for (int target : {10, 11, 12}) {
+    ASSERT_EQ(groups.get_outstanding_queries(target), 0);
+  }
+}
+
+TEST(rpc_connection_groups_test, ejection) {
+  auto &groups = vk::singleton<RpcConnectionGroups>::get();
+  const int group = groups.register_group({20, 21});
+
+  int slot = 100;
+  int failures = 0;
+  while (failures != RpcConnectionGroups::MAX_CONSECUTIVE_FAILURES) {
+    const int target = groups.choose_target(group, slot, 100.0, 0.0, all_ready);
+    groups.on_query_finished(slot++, target != 20, 0.0);
+    failures += target == 20;
+  }
+  ASSERT_TRUE(groups.is_ejected(20, 0.0));
+  ASSERT_FALSE(groups.is_ejected(21, 0.0));
+
+  for (int i = 0; i != 10; ++i) {
+    ASSERT_EQ(groups.choose_target(group, slot, 100.0, 1.0, all_ready), 21);
+    groups.on_query_finished(slot++, true, 1.0);
+  }
+
+  const double after_ejection = RpcConnectionGroups::EJECTION_TIME_SEC + 1.0;
+  ASSERT_FALSE(groups.is_ejected(20, after_ejection));
+  ASSERT_EQ(groups.choose_target(group, slot, 100.0, after_ejection, [](int target) { return target == 20; }), 20);
+  groups.on_query_finished(slot, true, after_ejection);
+}
+
+TEST(rpc_connection_groups_test, timeouts) {
+  auto &groups = vk::singleton<RpcConnectionGroups>::get();
+  const int group = groups.register_group({30});
+
+  for (int slot = 200; slot != 200 + RpcConnectionGroups::MAX_CONSECUTIVE_FAILURES; ++slot) {
+    ASSERT_EQ(groups.choose_target(group, slot, 1.0, 0.0, all_ready), 30);
+  }
+  ASSERT_EQ(groups.get_outstanding_queries(30), RpcConnectionGroups::MAX_CONSECUTIVE_FAILURES);
+
+  // timed out queries are failures, late answers to them are ignored
+  ASSERT_EQ(groups.choose_target(group, 300, 10.0, 2.0, all_ready), 30);
+  ASSERT_EQ(groups.get_outstanding_queries(30), 1);
+  ASSERT_TRUE(groups.is_ejected(30, 2.0));
+  groups.on_query_finished(200, true, 2.0);
+  ASSERT_EQ(groups.get_outstanding_queries(30), 1);
+
+  // a reused slot is not a failure
+  ASSERT_EQ(groups.choose_target(group, 300, 20.0, 3.0, all_ready), 30);
+  ASSERT_EQ(groups.get_outstanding_queries(30), 1);
+  groups.on_query_finished(300, true, 3.0);
+  ASSERT_EQ(groups.get_outstanding_queries(30), 0);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "net/net-msg.h"
+#include "server/rpc-zstd-packing.h"
+
+namespace {
+
+std::vector<int> make_packet(int op, long long req_id, size_t body_ints) {
+  std::vector<int> packet{op, static_cast<int>(req_id), static_cast<int>(req_id >> 32)};
+  for (size_t i = 0; i != body_ints; ++i) {
+    packet.emplace_back(static_cast<int>(i % 17));
+  }
+  return packet;
+}
+
+std::vector<int> fetch_all(raw_message *raw) {
+  std::vector<int> result(raw->total_bytes / sizeof(int));
+  EXPECT_EQ(rwm_fetch_data(raw, result.data(), raw->total_bytes), result.size() * sizeof(int));
+  return result;
+}
+
+} // namespace
+
+TEST(rpc_zstd_packing_test, pack_unpack) {
+  auto &packing = vk::singleton<RpcZstdPacking>::get();
+  packing.set_pack_threshold(1024);
+
+  const auto packet = make_packet(0x63aeda4e, 0x1234567890LL, 10000);
+  std::vector<int> packed;
+  ASSERT_TRUE(packing.pack(packet.data(), packet.size() * sizeof(int), packed));
+  ASSERT_LT(packed.size() * 10, packet.size());
+  // op and req_id are kept as is
+  ASSERT_TRUE(std::equal(packet.begin(), packet.begin() + 3, packed.begin()));
+
+  raw_message raw;
+  rwm_create(&raw, packed.data(), static_cast<int>(packed.size() * sizeof(int)));
+  ASSERT_TRUE(RpcZstdPacking::is_packed(&raw));
+  ASSERT_TRUE(packing.unpack(&raw));
+  ASSERT_FALSE(RpcZstdPacking::is_packed(&raw));
+  ASSERT_EQ(fetch_all(&raw), packet);
+  rwm_free(&raw);
+
+  packing.set_pack_threshold(0);
+}
+
+TEST(rpc_zstd_packing_test, not_packed) {
+  auto &packing = vk::singleton<RpcZstdPacking>::get();
+  std::vector<int> packed;
+  const auto packet = make_packet(0x63aeda4e, 1, 1000);
+  ASSERT_FALSE(packing.pack(packet.data(), packet.size() * sizeof(int), packed));
+
+  packing.set_pack_threshold(8192);
+  ASSERT_FALSE(packing.pack(packet.data(), packet.size() * sizeof(int), packed));
+
+  raw_message raw;
+  rwm_create(&raw, packet.data(), static_cast<int>(packet.size() * sizeof(int)));
+  ASSERT_FALSE(RpcZstdPacking::is_packed(&raw));
+  rwm_free(&raw);
+
+  packing.set_pack_threshold(0);
+}
+
+TEST(rpc_zstd_packing_test, broken) {
+  auto &packing = vk::singleton<RpcZstdPacking>::get();
+  packing.set_pack_threshold(1024);
+
+  const auto packet = make_packet(0x2374df3d, 42, 10000);
+  std::vector<int> packed;
+  ASSERT_TRUE(packing.pack(packet.data(), packet.size() * sizeof(int), packed));
+
+  raw_message raw;
+  rwm_create(&raw, packed.data(), static_cast<int>((packed.size() - 1) * sizeof(int)));
+  ASSERT_FALSE(packing.unpack(&raw));
+  // the message is left untouched
+  ASSERT_EQ(raw.total_bytes, (packed.size() - 1) * sizeof(int));
+  rwm_free(&raw);
+
+  // the zstd frame magic
+  packed[5] ^= 0x5a5a5a5a;
+  rwm_create(&raw, packed.data(), static_cast<int>(packed.size() * sizeof(int)));
+  ASSERT_FALSE(packing.unpack(&raw));
+  rwm_free(&raw);
+
+  packing.set_pack_threshold(0);
+}
@@ -1,9 +1,14 @@
 prepend(SERVER_TESTS_SOURCES ${BASE_DIR}/tests/cpp/server/
         job-workers/shared-memory-manager-test.cpp
+        log-histogram-test.cpp
         master-name-test.cpp
+        master-rpc-proxy-test.cpp
         server-config-test.cpp
         confdata-binlog-events-test.cpp
         php-engine-test.cpp
+        rpc-connection-groups-test.cpp
+        rpc-zstd-packing-test.cpp
+        statshouse-client-test.cpp
         workers-control-test.cpp)
 
 if(COMPILER_GCC)
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "server/statshouse/statshouse-client.h"
+
+namespace {
+
+// a local statshouse agent
+class StatsHouseAgent {
+public:
+  StatsHouseAgent() {
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+    port = ntohs(addr.sin_port);
+  }
+
+  ~StatsHouseAgent() {
+    close(fd);
+  }
+
+  // returns the number of received datagrams
+  int receive() const {
+    char buf[65536];
+    int received = 0;
+    while (recv(fd, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+      ++received;
+    }
+    return received;
+  }
+
+  int fd{-1};
+  int port{0};
+};
+
+} // namespace
+
+TEST(statshouse_client_test, flush) {
+  StatsHouseAgent agent;
+  {
+    StatsHouseClient client{"127.0.0.1", agent.port};
+    for (int i = 0; i < 1000; ++i) {
+      client.metric("test_count").tag("a").write_count(1);
+      client.metric("test_value").tag("name", "b").write_value(i);
+      client.metric("test_unique").write_unique(i % 10);
+    }
+    ASSERT_EQ(agent.receive(), 0);
+    ASSERT_EQ(client.sampled_values_count(), 2000);
+
+    client.flush();
+    ASSERT_GT(agent.receive(), 0);
+    ASSERT_EQ(client.sampled_values_count(), 0);
+
+    client.metric("test_count").write_count(1);
+    ASSERT_EQ(agent.receive(), 0);
+  }
+  // the client flushes on destruction
+  ASSERT_GT(agent.receive(), 0);
+}
+
+TEST(statshouse_client_test, max_sampled_values) {
+  StatsHouseAgent agent;
+  StatsHouseClient client{"127.0.0.1", agent.port};
+  StatsHouseClient::set_max_sampled_values(100);
+  for (int i = 0; i < 1000; ++i) {
+    client.metric("test_value").write_value(i);
+  }
+  // the values are sampled per key
+  ASSERT_EQ(client.sampled_values_count(), 100);
+  ASSERT_EQ(agent.receive(), 0);
+  client.flush();
+  agent.receive();
+
+  // and their total is limited too, the client flushes when it's reached
+  StatsHouseClient::set_max_sampled_values(1024);
+  size_t max_count = 0;
+  for (int key = 0; key < 1000; ++key) {
+    const std::string tag = std::to_string(key);
+    for (int i = 0; i < 1024; ++i) {
+      client.metric("test_value").tag(tag).write_value(i);
+      max_count = std::max(max_count, client.sampled_values_count());
+    }
+  }
+  ASSERT_LT(client.sampled_values_count(), 1000 * 1024);
+  ASSERT_LE(max_count, 256 * 1024);
+  ASSERT_GT(agent.receive(), 0);
+}
+
+TEST(statshouse_client_test, tags_with_any_chars) {
+  using namespace std::string_view_literals;
+  StatsHouseAgent agent;
+  StatsHouseClient client{"127.0.0.1", agent.port};
+  StatsHouseClient::set_max_sampled_values(1);
+  // each key keeps one value, so the count is the number of different keys
+  client.metric("test_value").tag("a").tag("b").write_value(1);
+  client.metric("test_value").tag("a\0\1b"sv).write_value(1);
+  client.metric("test_value").tag("a\0"sv).tag("b").write_value(1);
+  client.metric("test_value").tag("a", "b").write_value(1);
+  client.metric("test_value").tag("a\0b"sv).write_value(1);
+  ASSERT_EQ(client.sampled_values_count(), 5);
+  client.flush();
+  ASSERT_GT(agent.receive(), 0);
+  StatsHouseClient::set_max_sampled_values(1024);
+}
+
+TEST(statshouse_client_test, dummy) {
+  StatsHouseClient client;
+  client.metric("test_value").write_value(1);
+  ASSERT_EQ(client.sampled_values_count(), 0);
+}
@@ -0,0 +1,115 @@
+@ok
+<?php
+
+class Point {
+  public int $x;
+  public int $y;
+  /** @var string[] */
+  public $tags = [];
+
+  public function __construct(int $x, int $y) {
+    $this->x = $x;
+    $this->y = $y;
+    $this->addTag("created");
+  }
+
+  public function addTag(string $tag): self {
+    $this->tags[] = $tag;
+    return $this;
+  }
+
+  public function len2(): int {
+    return $this->x * $this->x + $this->y * $this->y;
+  }
+
+  public function describe(): string {
+    return "(" . $this->x . ", " . $this->y . ") " . implode(",", $this->tags) . " " . $this->len2();
+  }
+}
+
+class Registry {
+  /** @var Point[] */
+  public static $points = [];
+
+  public int $counter = 0;
+
+  public function register(Point $p) {
+    self::$points[] = $p;
+    $this->counter++;
+  }
+
+  public function selfRegister() {
+    $this->counter++;
+    Registry::$all[] = $this;
+  }
+
+  /** @var Registry[] */
+  public static $all = [];
+}
+
+function sum_in_loop(int $n): int {
+  $sum = 0;
+  for ($i = 0; $i < $n; ++$i) {
+    $p = new Point($i, $i + 1);
+    $p->addTag("loop");
+    $p->x += 1;
+    $sum += $p->len2() + count($p->tags);
+  }
+  return $sum;
+}
+
+function describe_local(): string {
+  $p = new Point(3, 4);
+  $p->addTag("local");
+  $s = $p->describe();
+  $p = new Point(5, 12);
+  return $s . " / " . $p->describe();
+}
+
+function escapes_to_static(): int {
+  $p = new Point(1, 2);
+  $r = new Registry;
+  $r->register($p);
+  $p->x = 100;
+  return $r->counter;
+}
+
+function escapes_via_this(): int {
+  $r = new Registry;
+  $r->selfRegister();
+  return $r->counter;
+}
+
+function escapes_via_returned_this(): Point {
+  $p = new Point(7, 8);
+  return $p->addTag("returned");
+}
+
+function escapes_via_returned_assignment(): Point {
+  return $p = new Point(9, 10);
+}
+
+function take_point(Point $p): Point {
+  return $p;
+}
+
+function escapes_via_assignment_as_argument(): Point {
+  return take_point($p = new Point(11, 12));
+}
+
+function escapes_via_chained_assignment(): Point {
+  $x = ($p = new Point(13, 14));
+  $p->addTag("chained");
+  return $x;
+}
+
+var_dump(sum_in_loop(10));
+var_dump(describe_local());
+var_dump(escapes_to_static());
+var_dump(Registry::$points[0]->describe());
+var_dump(escapes_via_this());
+var_dump(Registry::$all[0]->counter);
+var_dump(escapes_via_returned_this()->describe());
+var_dump(escapes_via_returned_assignment()->describe());
+var_dump(escapes_via_assignment_as_argument()->describe());
+var_dump(escapes_via_chained_assignment()->describe());
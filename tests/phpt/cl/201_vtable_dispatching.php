@@ -0,0 +1,167 @@
+@ok
+<?php
+
+interface Shape {
+  public function area(int $scale): int;
+  public function name(): string;
+  public function visit(Visitor $v);
+}
+
+class Visitor {
+  /** @var string[] */
+  public $names = [];
+}
+
+abstract class BaseShape implements Shape {
+  public function name(): string {
+    return get_class($this);
+  }
+
+  public function visit(Visitor $v) {
+    $v->names[] = $this->name();
+  }
+}
+
+class Shape1 extends BaseShape {
+  public function area(int $scale, int $extra = 1): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape2 extends BaseShape {
+  public function area(int $scale, int $extra = 2): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape3 extends BaseShape {
+  public function area(int $scale, int $extra = 3): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape4 extends BaseShape {
+  public function area(int $scale, int $extra = 4): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape5 extends BaseShape {
+  public function area(int $scale, int $extra = 5): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape6 extends BaseShape {
+  public function area(int $scale, int $extra = 6): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape7 extends BaseShape {
+  public function area(int $scale, int $extra = 7): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape8 extends BaseShape {
+  public function area(int $scale, int $extra = 8): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape9 extends BaseShape {
+  public function area(int $scale, int $extra = 9): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape10 extends BaseShape {
+  public function area(int $scale, int $extra = 10): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape11 extends BaseShape {
+  public function area(int $scale, int $extra = 11): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape12 extends BaseShape {
+  public function area(int $scale, int $extra = 12): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape13 extends BaseShape {
+  public function area(int $scale, int $extra = 13): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape14 extends BaseShape {
+  public function area(int $scale, int $extra = 14): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape15 extends BaseShape {
+  public function area(int $scale, int $extra = 15): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape16 extends BaseShape {
+  public function area(int $scale, int $extra = 16): int {
+    return $scale * $extra;
+  }
+}
+
+class Shape16Child extends Shape16 {
+  public function name(): string {
+    return "child of " . parent::name();
+  }
+}
+
+class Shape17 implements Shape {
+  public function area(int $scale): int {
+    return -$scale;
+  }
+
+  public function name(): string {
+    return "17";
+  }
+
+  public function visit(Visitor $v) {
+    $v->names[] = "visited 17";
+  }
+}
+
+/** @return Shape[] */
+function make_shapes(): array {
+  return [
+    new Shape1, new Shape2, new Shape3, new Shape4, new Shape5, new Shape6, new Shape7, new Shape8,
+    new Shape9, new Shape10, new Shape11, new Shape12, new Shape13, new Shape14, new Shape15, new Shape16,
+    new Shape16Child, new Shape17,
+  ];
+}
+
+function total_area(int $n): int {
+  $shapes = make_shapes();
+  $sum = 0;
+  for ($i = 0; $i < $n; ++$i) {
+    foreach ($shapes as $shape) {
+      $sum += $shape->area($i);
+    }
+  }
+  return $sum;
+}
+
+$v = new Visitor;
+foreach (make_shapes() as $shape) {
+  $shape->visit($v);
+}
+var_dump($v->names);
+var_dump(total_area(100));
+var_dump((new Shape16Child)->area(3));
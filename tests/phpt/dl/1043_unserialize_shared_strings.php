@@ -0,0 +1,28 @@
+@ok
+<?php
+
+function test_repeated_keys() {
+  $rows = [];
+  for ($i = 0; $i < 50; $i++) {
+    $rows[] = ['id' => $i, 'name' => "user$i", 'status' => $i % 3 ? 'active' : 'banned', 'tags' => ['x', '12', '0', '9999', '10000', '01']];
+  }
+  $data = unserialize(serialize($rows));
+  var_dump($data === $rows);
+  $data[3]['status'] .= '!';
+  $data[4]['tags'][0] = 'y';
+  var_dump($data[3]['status'], $data[5]['status'], $data[4]['tags'], $data[5]['tags']);
+}
+
+function test_numeric_string_keys() {
+  var_dump(unserialize('a:4:{s:1:"5";i:1;s:2:"05";i:2;s:4:"1234";i:3;s:2:"-7";i:4;}'));
+}
+
+function test_broken_counts() {
+  var_dump(unserialize('a:1000000000:{i:0;i:1;}'));
+  var_dump(unserialize('a:1:{i:0;i:1;i:1;i:2;}'));
+  var_dump(unserialize('a:2:{s:1:"a";i:1;s:1:"b"i:2;}'));
+}
+
+test_repeated_keys();
+test_numeric_string_keys();
+test_broken_counts();
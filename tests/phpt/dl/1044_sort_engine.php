@@ -0,0 +1,111 @@
+@ok
+<?php
+
+/**
+ * @param int $n
+ * @param int $mode
+ * @return int[]
+ */
+function make_ints($n, $mode) {
+  $res = [];
+  for ($i = 0; $i < $n; $i++) {
+    switch ($mode) {
+      case 0:
+        $res[] = ($i * 7919 + 13) % 1009 - 500;
+        break;
+      case 1:
+        $res[] = $i < $n / 2 ? $i : $n - $i;
+        break;
+      case 2:
+        $res[] = $i % 3;
+        break;
+      default:
+        $res[] = ($i * 2654435761) % 4294967296 * ($i % 2 ? 1 : -1) * 1000003;
+    }
+  }
+  return $res;
+}
+
+/**
+ * @param float[] $floats
+ * @return string
+ */
+function floats_hash($floats) {
+  $res = [];
+  foreach ($floats as $k => $v) {
+    $res[$k] = (int)round($v * 1000);
+  }
+  return md5(serialize($res));
+}
+
+function test_numbers() {
+  foreach ([0, 1, 2, 5, 8, 9, 30, 255, 256, 1000] as $n) {
+    for ($mode = 0; $mode < 4; $mode++) {
+      $ints = make_ints($n, $mode);
+      $a = $ints;
+      sort($a);
+      echo md5(serialize($a)), "\n";
+      $a = $ints;
+      rsort($a, SORT_NUMERIC);
+      echo md5(serialize($a)), "\n";
+
+      $floats = [];
+      foreach ($ints as $i => $v) {
+        $floats[] = $v / 7.0 + $i / 1000.0;
+      }
+      $f = $floats;
+      sort($f);
+      echo floats_hash($f), "\n";
+      $f = $floats;
+      rsort($f);
+      echo floats_hash($f), "\n";
+
+      $keyed = [];
+      foreach ($ints as $i => $v) {
+        $keyed[$v * 1000 + $i] = $i;
+      }
+      $k = $keyed;
+      ksort($k);
+      echo md5(serialize($k)), "\n";
+      $k = $keyed;
+      krsort($k);
+      echo md5(serialize($k)), "\n";
+
+      $unique = array_flip($keyed);
+      asort($unique);
+      echo md5(serialize($unique)), "\n";
+      arsort($unique);
+      echo md5(serialize($unique)), "\n";
+
+      $u = $ints;
+      usort($u, function($x, $y) { return $y <=> $x; });
+      echo md5(serialize($u)), "\n";
+    }
+  }
+}
+
+function test_special_floats() {
+  $a = [3.5, NAN, -INF, 1.0, INF, -2.25, 0.0];
+  sort($a);
+  var_dump(count($a));
+  // small arrays with NaN are sorted by the comparator as well, not by the sorting network
+  foreach ([[2.0, NAN], [NAN, 5.5, -1.0], [4.0, NAN, 1.0, 3.0, NAN, 2.0], [8.0, 7.0, NAN, 5.0, 4.0, 3.0, 2.0, 1.0]] as $small) {
+    $s = $small;
+    sort($s);
+    var_dump(count($s), count(array_filter($s, function($v) { return is_nan($v); })), array_sum(array_filter($s, function($v) { return !is_nan($v); })));
+    $s = $small;
+    rsort($s);
+    var_dump(count($s), count(array_filter($s, function($v) { return is_nan($v); })));
+  }
+  $b = [];
+  for ($i = 0; $i < 300; $i++) {
+    $b[] = $i % 2 ? -$i * 1.5 : $i / 3.0;
+  }
+  $b[] = -INF;
+  $b[] = INF;
+  sort($b);
+  var_dump($b[0] === -INF, $b[301] === INF, $b[1], $b[150] <= $b[151]);
+}
+
+test_numbers();
+test_special_floats();
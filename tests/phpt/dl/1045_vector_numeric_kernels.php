@@ -0,0 +1,49 @@
+@ok
+<?php
+
+/**
+ * @param int[] $ints
+ * @param float[] $floats
+ */
+function check_arrays(array $ints, array $floats) {
+  var_dump(array_sum($ints));
+  var_dump(array_sum($floats) == array_sum(array_values($floats)));
+  if ($ints) {
+    var_dump(min($ints), max($ints));
+    var_dump(min($floats), max($floats));
+  }
+  foreach ([-30, -1, 0, 7, 12, 100500] as $needle) {
+    var_dump(in_array($needle, $ints), in_array($needle, $ints, true), array_search($needle, $ints), array_search($needle, $ints, true));
+    $float_needle = $needle / 4.0;
+    var_dump(in_array($float_needle, $floats), array_search($float_needle, $floats, true));
+  }
+}
+
+function test_vectors() {
+  foreach ([0, 1, 3, 4, 5, 8, 17, 64, 100] as $n) {
+    $ints = [];
+    $floats = [];
+    for ($i = 0; $i < $n; ++$i) {
+      $v = ($i * 37) % 61 - 30;
+      $ints[] = $v;
+      $floats[] = $v / 4.0;
+    }
+    check_arrays($ints, $floats);
+    // the same values in maps
+    $ints_map = [];
+    $floats_map = [];
+    foreach ($ints as $i => $v) {
+      $ints_map[$i + 1000] = $v;
+      $floats_map[$i + 1000] = $floats[$i];
+    }
+    check_arrays($ints_map, $floats_map);
+  }
+}
+
+function test_overflow() {
+  var_dump(array_sum([PHP_INT_MAX, 0, 0, 0, 0, 0]));
+  var_dump(min([PHP_INT_MAX, -PHP_INT_MAX - 1, 0, 1, 2]), max([5, 4, PHP_INT_MAX, -PHP_INT_MAX - 1]));
+}
+
+test_vectors();
+test_overflow();
@@ -0,0 +1,60 @@
+@ok
+<?php
+
+/**
+ * @param int[] $arr
+ * @return int[]
+ */
+function append_and_return(array $arr, int $x): array {
+  $arr[] = $x;
+  return $arr;
+}
+
+function append_str(string $s, string $suffix): string {
+  $s .= $suffix;
+  return $s;
+}
+
+function test_moves() {
+  $a = [1, 2, 3];
+  $b = $a;
+  $c = append_and_return($a, 4);
+  var_dump($b, $c);
+
+  $s = str_repeat("x", 5);
+  $copy = $s;
+  $t = append_str($s, "y");
+  var_dump($copy, $t);
+
+  // the same variable twice in a statement is not moved
+  $u = str_repeat("z", 3);
+  var_dump(append_str($u, $u));
+}
+
+function test_loop() {
+  $acc = [];
+  for ($i = 0; $i < 3; ++$i) {
+    $acc = append_and_return($acc, $i);
+  }
+  $s = "a";
+  foreach ([1, 2] as $_) {
+    $s = append_str($s, "b");
+  }
+  var_dump($acc, $s);
+}
+
+function test_branches(bool $cond) {
+  $s = "base";
+  if ($cond) {
+    $r = append_str($s, "-then");
+  } else {
+    $r = append_str($s, "-else");
+  }
+  $moved = $r;
+  var_dump($moved);
+}
+
+test_moves();
+test_loop();
+test_branches(true);
+test_branches(false);
@@ -0,0 +1,90 @@
+@ok
+<?php
+require_once 'kphp_tester_include.php';
+
+#ifndef KPHP
+function thread_pool_zstd_compress(string $data, int $level = 3) {
+  return fork(zstd_compress($data, $level));
+}
+
+function thread_pool_gzcompress(string $str, int $level = -1) {
+  return fork(gzcompress($str, $level));
+}
+
+function thread_pool_hash(string $algo, string $str, bool $raw_output = false) {
+  return fork(hash($algo, $str, $raw_output));
+}
+
+function thread_pool_sort_ints(array $values) {
+  sort($values);
+  return fork($values);
+}
+
+function thread_pool_sort_floats(array $values) {
+  sort($values);
+  return fork($values);
+}
+
+function thread_pool_dot_product(array $a, array $b) {
+  return fork(vk_dot_product($a, $b));
+}
+#endif
+
+function test_compress() {
+  $data = str_repeat("foo bar baz ", 1000) . "end";
+  $zstd_future = thread_pool_zstd_compress($data);
+  $gz_future = thread_pool_gzcompress($data, 9);
+
+  var_dump(zstd_uncompress((string)wait($zstd_future)) === $data);
+  var_dump(gzuncompress((string)wait($gz_future)) === $data);
+
+  $empty_future = thread_pool_zstd_compress("");
+  var_dump(zstd_uncompress((string)wait($empty_future)));
+}
+
+function test_hash() {
+  $futures = [];
+  foreach (['md5', 'sha1', 'sha224', 'sha256', 'sha384', 'sha512'] as $algo) {
+    $futures[$algo] = thread_pool_hash($algo, "hello world");
+  }
+  $raw_future = thread_pool_hash('sha256', "hello world", true);
+  foreach ($futures as $algo => $future) {
+    var_dump($algo, wait($future) === hash($algo, "hello world"));
+  }
+  var_dump(bin2hex((string)wait($raw_future)));
+}
+
+function test_sort() {
+  $ints = [];
+  $floats = [];
+  for ($i = 0; $i < 1000; ++$i) {
+    $ints[] = ($i * 7919) % 1009 - 500;
+    $floats[] = (($i * 104729) % 997) / 7.0 - 50.0;
+  }
+  $ints_future = thread_pool_sort_ints($ints);
+  $floats_future = thread_pool_sort_floats($floats);
+
+  sort($ints);
+  sort($floats);
+  var_dump(wait($ints_future) === $ints);
+  var_dump(wait($floats_future) === $floats);
+
+  var_dump(wait(thread_pool_sort_ints([3, 1, 2])));
+  var_dump(wait(thread_pool_sort_ints([])));
+}
+
+function test_dot_product() {
+  $a = [];
+  $b = [];
+  for ($i = 0; $i < 100; ++$i) {
+    $a[] = $i / 4.0;
+    $b[] = 2.0;
+  }
+  var_dump(wait(thread_pool_dot_product($a, $b)));
+  var_dump(wait(thread_pool_dot_product([1.5, 2.0], [4.0, 0.5])));
+}
+
+test_compress();
+test_hash();
+test_sort();
+test_dot_product();
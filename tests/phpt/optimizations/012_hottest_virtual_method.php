@@ -0,0 +1,57 @@
+@ok
+KPHP_PROFILE_GUIDED_DATA={dir}/profiles/012_hottest_virtual_method.callgrind
+KPHP_CXX_PROFILE_USE={dir}/profiles
+<?php
+
+// according to the profile, Cat::speak() and Bird::legs() take most of the calls,
+// so they are checked before the dispatching switch, but other classes must get their own methods
+
+abstract class Animal {
+  abstract public function speak(): string;
+
+  public function legs(): int {
+    return 4;
+  }
+}
+
+class Cat extends Animal {
+  public function speak(): string {
+    return "meow";
+  }
+}
+
+class Dog extends Animal {
+  public function speak(): string {
+    return "woof";
+  }
+}
+
+class Puppy extends Dog {
+  public function speak(): string {
+    return "yap";
+  }
+}
+
+class Bird extends Animal {
+  public function speak(): string {
+    return "tweet";
+  }
+
+  public function legs(): int {
+    return 2;
+  }
+}
+
+/**
+ * @param Animal[] $animals
+ */
+function describe_all($animals) {
+  foreach ($animals as $animal) {
+    echo get_class($animal), " says ", $animal->speak(), " on ", $animal->legs(), " legs\n";
+  }
+}
+
+/** @var Animal[] $animals */
+$animals = [new Dog, new Puppy, new Dog, new Bird, new Cat];
+describe_all($animals);
+describe_all([new Dog, new Puppy]);
@@ -0,0 +1,58 @@
+@ok
+<?php
+
+function test_strings() {
+  $base = ['', 'a', 'Z', "\x00", "abc\x00DEF", "\xBB Mixed\xAB", 'Hello World', "  \t\n\r\x0B\x00"];
+  $res = [];
+  foreach ($base as $s) {
+    foreach ([1, 15, 16, 17, 31, 32, 33, 70] as $n) {
+      $res[] = str_repeat($s, $n);
+      $res[] = str_repeat('x', $n) . $s;
+      $res[] = $s . str_repeat('Q', $n);
+    }
+  }
+  return $res;
+}
+
+function test_case() {
+  foreach (test_strings() as $s) {
+    var_dump(bin2hex(strtolower($s)));
+    var_dump(bin2hex(strtoupper($s)));
+    var_dump(bin2hex(ucfirst($s)));
+    var_dump(bin2hex(lcfirst($s)));
+  }
+}
+
+function test_search() {
+  foreach (test_strings() as $s) {
+    foreach (['q', 'Q', 'hello', 'WORLD', "\x00D", 'xQ'] as $needle) {
+      var_dump(stripos($s, $needle));
+      var_dump(strripos($s, $needle));
+      var_dump(stristr($s, $needle) !== false);
+      var_dump(bin2hex(str_ireplace($needle, '#', $s)));
+    }
+  }
+}
+
+function test_trim() {
+  foreach (test_strings() as $s) {
+    var_dump(bin2hex(trim($s)));
+    var_dump(bin2hex(ltrim($s)));
+    var_dump(bin2hex(rtrim($s)));
+    var_dump(bin2hex(trim($s, 'xQ')));
+    var_dump(bin2hex(trim($s, 'a..z')));
+  }
+}
+
+function test_htmlspecialchars() {
+  foreach (['', 'plain', '<a href="x">it\'s & co</a>', str_repeat('&"\'<>', 20), str_repeat('x', 40) . '>'] as $s) {
+    var_dump(htmlspecialchars($s));
+    var_dump(htmlspecialchars($s, ENT_QUOTES));
+    var_dump(htmlspecialchars($s, ENT_NOQUOTES));
+  }
+}
+
+test_case();
+test_search();
+test_trim();
+test_htmlspecialchars();
@@ -0,0 +1,44 @@
+@ok
+<?php
+
+function test_const_arrays($s) {
+  var_dump(str_replace(['{name}', '{age}', '{city}', '{unused}'], ['John', '42', 'Paris', 'x'], $s));
+  var_dump(str_replace(['<', '>', '&', '"', "'"], ['&lt;', '&gt;', '&amp;', '&quot;', '&#039;'], $s));
+  var_dump(strtr($s, ['{name}' => 'John', '{age}' => 42, '{' => '[', '}' => ']', 5 => 'five']));
+}
+
+function test_chained_replacements() {
+  // every next needle is applied to the result of the previous replacement
+  var_dump(str_replace(['a', 'b', 'c', 'd'], ['b', 'c', 'd', 'e'], 'abcd'));
+  var_dump(str_replace(['bc', 'ab', 'x', 'y'], ['1', '2', '3', '4'], 'abcxy'));
+  var_dump(str_replace(['x', 'ab', 'c', 'd'], ['', '1', '2', '3'], 'axbcd'));
+  var_dump(str_replace(['aa', 'b', 'c', 'd'], ['1', '2', '3', '4'], 'aaaaabcd'));
+  var_dump(str_replace(['a', 'a', 'b', 'c'], ['1', '2', '3', '4'], 'abca'));
+}
+
+function test_dynamic_arrays($n) {
+  $search = [];
+  $replace = [];
+  for ($i = 0; $i < $n; ++$i) {
+    $search[] = "<$i>";
+    $replace[] = "[" . ($i * 2) . "]";
+  }
+  $subject = '';
+  for ($i = 0; $i < 3 * $n; ++$i) {
+    $subject .= "<$i> <" . ($i % 7) . "";
+  }
+  $count = 0;
+  var_dump(str_replace($search, $replace, $subject, $count));
+  var_dump($count);
+  var_dump(str_replace($search, '', $subject, $count));
+  var_dump($count);
+  var_dump(strtr($subject, array_combine($search, $replace)));
+  var_dump(strtr($subject, []));
+}
+
+foreach (['', 'Hi, {name} from {city}, {age}!', '<a href="x">{name}\'s & {unused}</a>', '{{name}}5{'] as $s) {
+  test_const_arrays($s);
+}
+test_chained_replacements();
+test_dynamic_arrays(5);
+test_dynamic_arrays(60);
@@ -0,0 +1,64 @@
+@ok
+<?php
+
+function utf8_test_strings() {
+  $base = ['', 'a', "a\x00b", 'Hello World', 'Привет, мир!', "\xE2\x82\xAC", "\xF0\x9D\x84\x9E", 'Ёжик Strasse'];
+  $res = [];
+  foreach ($base as $s) {
+    foreach ([1, 15, 16, 17, 31, 32, 33, 70] as $n) {
+      $res[] = str_repeat($s, $n);
+      $res[] = str_repeat('x', $n) . $s;
+      $res[] = $s . str_repeat('Ф', $n);
+    }
+  }
+  return $res;
+}
+
+function test_check_encoding() {
+  $invalid = ["\x80", "\xC0\x80", "\xC1\xBF", "\xC2", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xF0\x90\x80", "\xFF"];
+  foreach (utf8_test_strings() as $s) {
+    var_dump(mb_check_encoding($s, 'UTF-8'));
+    foreach ($invalid as $bad) {
+      var_dump(mb_check_encoding($s . $bad, 'UTF-8'));
+      var_dump(mb_check_encoding($bad . $s, 'UTF-8'));
+    }
+  }
+}
+
+function test_length_and_substr() {
+  foreach (utf8_test_strings() as $s) {
+    $len = mb_strlen($s, 'UTF-8');
+    var_dump($len);
+    foreach ([0, 1, 15, 33, -1, -17] as $start) {
+      var_dump(bin2hex(mb_substr($s, $start, null, 'UTF-8')));
+      var_dump(bin2hex(mb_substr($s, $start, 16, 'UTF-8')));
+      var_dump(bin2hex(mb_substr($s, $start, -2, 'UTF-8')));
+    }
+    var_dump(mb_strpos($s, 'Ф', 0, 'UTF-8'));
+    var_dump(mb_strpos($s, 'b', 3, 'UTF-8'));
+  }
+}
+
+function test_case() {
+  foreach (utf8_test_strings() as $s) {
+    var_dump(bin2hex(mb_strtolower($s, 'UTF-8')));
+    var_dump(bin2hex(mb_strtoupper($s, 'UTF-8')));
+  }
+}
+
+function test_vk_utf8() {
+  foreach (utf8_test_strings() as $s) {
+    if (strpos($s, "\x00") !== false) {
+      continue;
+    }
+    $win = (string)vk_utf8_to_win($s);
+    var_dump(bin2hex($win));
+    var_dump(bin2hex(vk_win_to_utf8($win)));
+    var_dump(bin2hex((string)vk_utf8_to_win($s, 20)));
+  }
+}
+
+test_check_encoding();
+test_length_and_substr();
+test_case();
+test_vk_utf8();